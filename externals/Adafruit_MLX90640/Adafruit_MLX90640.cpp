@@ -3,8 +3,15 @@
 /*!
  *    @brief  Instantiates a new MLX90640 class
  */
-Adafruit_MLX90640::Adafruit_MLX90640(void) {}
+Adafruit_MLX90640::Adafruit_MLX90640(void) {
+  // the status register is cleared for every sub-page: its overwrite enable
+  // bit is checked with the status read that follows the RAM read anyway.
+  // The other bits are updated by the device.
+  setWritePolicy(0x8000, MLX90640_WRITE_DEFERRED, 0x0010);
+  setWritePolicy(0x800D, MLX90640_WRITE_VERIFY);
+}
 
+#ifndef MLX90640_NO_BUSIO
 /*!
  *    @brief  Sets up the hardware and initializes I2C
  *    @param  i2c_addr
@@ -14,13 +21,35 @@ Adafruit_MLX90640::Adafruit_MLX90640(void) {}
  *    @return True if initialization was successful, otherwise false.
  */
 boolean Adafruit_MLX90640::begin(uint8_t i2c_addr, TwoWire *wire) {
-  i2c_dev = new Adafruit_I2CDevice(i2c_addr, wire);
+  // wire->setClock(400000); // Speed it up, lots to read :)
+  return begin(new MLX90640_I2CDeviceTransport(i2c_addr, wire));
+}
+#endif
 
-  if (!i2c_dev->begin()) {
+/*!
+ *    @brief  Sets up the sensor behind an arbitrary register transport
+ *    @param  transport
+ *            The transport used for all register accesses, must outlive
+ *            this object.
+ *    @param  paramsCache
+ *            Optional store of the calibration parameters. On a hit for the
+ *            serial number the EEPROM is not read at all, on a miss the
+ *            extracted parameters are stored for the next boot.
+ *    @return True if initialization was successful, otherwise false.
+ */
+boolean Adafruit_MLX90640::begin(MLX90640_Transport *transport,
+                                 MLX90640_ParamsCache *paramsCache) {
+  _transport = transport;
+
+  if (!_transport->begin()) {
     return false;
   }
-  // wire->setClock(400000); // Speed it up, lots to read :)
-  MLX90640_I2CRead(0, MLX90640_DEVICEID1, 3, serialNumber);
+  if (MLX90640_I2CRead(0, MLX90640_DEVICEID1, 3, serialNumber) != 0) {
+    return false;
+  }
+  if (paramsCache != NULL && paramsCache->load(serialNumber, &_params)) {
+    return true;
+  }
 
   uint16_t eeMLX90640[832];
   if (MLX90640_DumpEE(0, eeMLX90640) != 0) {
@@ -35,9 +64,25 @@ boolean Adafruit_MLX90640::begin(uint8_t i2c_addr, TwoWire *wire) {
 
   MLX90640_ExtractParameters(eeMLX90640, &_params);
   // whew!
+  if (paramsCache != NULL) {
+    paramsCache->store(serialNumber, &_params);
+  }
   return true;
 }
 
+/*!
+ *    @brief  Sets up the calibration from an EEPROM dump instead of the
+ *            sensor, e.g. to replay a recorded capture with
+ *            calculateSubpage(). No transport is needed for that.
+ *    @param  eeData 832 words read from the EEPROM at 0x2400
+ *    @return True if the parameters could be extracted
+ */
+boolean Adafruit_MLX90640::loadEEPROM(const uint16_t *eeData) {
+  uint16_t eeMLX90640[832];
+  memcpy(eeMLX90640, eeData, sizeof(eeMLX90640));
+  return MLX90640_ExtractParameters(eeMLX90640, &_params) == 0;
+}
+
 /*!
  *    @brief  Read nMemAddressRead words from I2C startAddress into data
  *    @param  slaveAddr Not used - kept to maintain backcompatible API
@@ -50,47 +95,41 @@ int Adafruit_MLX90640::MLX90640_I2CRead(uint8_t slaveAddr,
                                         uint16_t startAddress,
                                         uint16_t nMemAddressRead,
                                         uint16_t *data) {
-  uint8_t cmd[2];
-
-  while (nMemAddressRead > 0) {
-    uint16_t toRead16 =
-        min(nMemAddressRead, (uint16_t)(i2c_dev->maxBufferSize() / 2));
-
-    cmd[0] = startAddress >> 8;
-    cmd[1] = startAddress & 0x00FF;
-    // Serial.printf("Reading %d words\n", toRead16);
-    if (!i2c_dev->write_then_read(cmd, 2, (uint8_t *)data, toRead16 * 2,
-                                  false)) {
-      return -1;
-    }
-    // we now have to swap every two bytes
-    for (int i = 0; i < toRead16; i++) {
-      data[i] = __builtin_bswap16(data[i]);
-    }
-    // advance buffer
-    data += toRead16;
-    // advance address
-    startAddress += toRead16;
-    // reduce remaining to read
-    nMemAddressRead -= toRead16;
+  int error = _transport->read(startAddress, nMemAddressRead, data);
+  if (error == 0) {
+    checkDeferredWrites(startAddress, nMemAddressRead, data);
   }
-  // success!
-  return 0;
+  return error;
 }
 
+/*!
+ *    @brief  Write a register and verify it according to its write policy
+ *    @param  slaveAddr Not used - kept to maintain backcompatible API
+ *    @param  writeAddress I2C memory address to write
+ *    @param  data Value to write
+ *    @return 0 on success, -1 on a bus error, -2 if the read back differs
+ */
 int Adafruit_MLX90640::MLX90640_I2CWrite(uint8_t slaveAddr,
                                          uint16_t writeAddress, uint16_t data) {
-  uint8_t cmd[4];
   uint16_t dataCheck = 0;
+  mlx90640_write_policy_slot_t *slot = findWritePolicy(writeAddress);
+  mlx90640_write_policy_t policy = slot ? slot->policy : MLX90640_WRITE_VERIFY;
+  uint16_t verifyMask = slot ? slot->verifyMask : 0xFFFF;
 
-  cmd[0] = writeAddress >> 8;
-  cmd[1] = writeAddress & 0x00FF;
-  cmd[2] = data >> 8;
-  cmd[3] = data & 0x00FF;
-
-  if (!i2c_dev->write(cmd, 4, true)) {
+  if (_transport->write(writeAddress, data) != 0) {
     return -1;
   }
+  _writeStats.writes++;
+
+  if (policy == MLX90640_WRITE_DEFERRED) {
+    slot->pending = true;
+    slot->pendingValue = data;
+    return 0;
+  }
+  if (policy == MLX90640_WRITE_UNVERIFIED) {
+    return 0;
+  }
+
   delay(1);
 
   if (MLX90640_I2CRead(slaveAddr, writeAddress, 1, &dataCheck) != 0) {
@@ -98,13 +137,69 @@ int Adafruit_MLX90640::MLX90640_I2CWrite(uint8_t slaveAddr,
   }
 
   // check echo
-  if (dataCheck != data) {
+  _writeStats.verifications++;
+  if ((dataCheck & verifyMask) != (data & verifyMask)) {
+    _writeStats.verificationFailures++;
     return -2;
   }
   // OK!
   return 0;
 }
 
+/*!
+ *    @brief  Choose how writes to a register are verified, registers without
+ *            a policy are verified right away
+ *    @param  writeAddress Register address
+ *    @param  policy Verification policy
+ *    @param  verifyMask Bits of the read back that have to match
+ *    @return False if all policy slots are used
+ */
+bool Adafruit_MLX90640::setWritePolicy(uint16_t writeAddress,
+                                       mlx90640_write_policy_t policy,
+                                       uint16_t verifyMask) {
+  mlx90640_write_policy_slot_t *slot = findWritePolicy(writeAddress);
+  if (!slot) {
+    if (_writePolicyCount >= MLX90640_WRITE_POLICY_SLOTS) {
+      return false;
+    }
+    slot = &_writePolicies[_writePolicyCount++];
+    slot->address = writeAddress;
+  }
+  slot->policy = policy;
+  slot->verifyMask = verifyMask;
+  slot->pending = false;
+  return true;
+}
+
+Adafruit_MLX90640::mlx90640_write_policy_slot_t *
+Adafruit_MLX90640::findWritePolicy(uint16_t writeAddress) {
+  for (uint8_t i = 0; i < _writePolicyCount; i++) {
+    if (_writePolicies[i].address == writeAddress) {
+      return &_writePolicies[i];
+    }
+  }
+  return NULL;
+}
+
+// compare outstanding deferred writes with registers that were just read
+void Adafruit_MLX90640::checkDeferredWrites(uint16_t startAddress,
+                                            uint16_t nWords,
+                                            const uint16_t *data) {
+  for (uint8_t i = 0; i < _writePolicyCount; i++) {
+    mlx90640_write_policy_slot_t &slot = _writePolicies[i];
+    if (!slot.pending || slot.address < startAddress ||
+        slot.address - startAddress >= nWords) {
+      continue;
+    }
+    slot.pending = false;
+    _writeStats.verifications++;
+    if ((data[slot.address - startAddress] & slot.verifyMask) !=
+        (slot.pendingValue & slot.verifyMask)) {
+      _writeStats.verificationFailures++;
+    }
+  }
+}
+
 /*!
  *    @brief Get the frame-read mode
  *    @return Chess or interleaved mode
@@ -165,9 +260,6 @@ void Adafruit_MLX90640::setRefreshRate(mlx90640_refreshrate_t rate) {
  *    @return 0 on success
  */
 int Adafruit_MLX90640::getFrame(float *framebuf) {
-  float emissivity = 0.95;
-  float tr = 23.15;
-  uint16_t mlx90640Frame[834];
   int status;
 
   for (uint8_t page = 0; page < 2; page++) {
@@ -185,18 +277,64 @@ int Adafruit_MLX90640::getFrame(float *framebuf) {
       return status;
     }
 
-    ta = MLX90640_GetTa(mlx90640Frame, &_params); // Store ambient temp locally
-    tr = ta - OPENAIR_TA_SHIFT; // For a MLX90640 in the open air the shift is
-                                // -8 degC.
-#ifdef MLX90640_DEBUG
-    Serial.print("Tr = ");
-    Serial.println(tr, 8);
-#endif
-    MLX90640_CalculateTo(mlx90640Frame, &_params, emissivity, tr, framebuf);
+    calculateSubpage(mlx90640Frame, framebuf);
   }
+  correctBadPixels(mlx90640Frame, framebuf);
   return 0;
 }
 
+/*!
+ *    @brief  Calculate the temperatures of one sub-page that was already read
+ *            from the sensor. Only the pixels of that sub-page are written.
+ *    @param  frameData 834 words in MLX90640_GetFrameData layout (RAM,
+ *            control register 1, sub-page number)
+ *    @param  framebuf 24*32 floating point memory buffer
+ */
+void Adafruit_MLX90640::calculateSubpage(uint16_t *frameData,
+                                         float *framebuf) {
+  float emissivity = 0.95;
+  float tr;
+
+  ta = MLX90640_GetTa(frameData, &_params); // Store ambient temp locally
+  tr = ta - OPENAIR_TA_SHIFT; // For a MLX90640 in the open air the shift is
+                              // -8 degC.
+#ifdef MLX90640_DEBUG
+  Serial.print("Tr = ");
+  Serial.println(tr, 8);
+#endif
+  MLX90640_CalculateTo(frameData, &_params, emissivity, tr, framebuf);
+}
+
+/*!
+ *    @brief  Calculate the relative image (gain, offset and sensitivity
+ *            compensated IR signal, no temperatures) of one sub-page that
+ *            was already read from the sensor. Only the pixels of that
+ *            sub-page are written.
+ *    @param  frameData 834 words in MLX90640_GetFrameData layout (RAM,
+ *            control register 1, sub-page number)
+ *    @param  framebuf 24*32 floating point memory buffer
+ */
+void Adafruit_MLX90640::calculateSubpageImage(uint16_t *frameData,
+                                              float *framebuf) {
+  MLX90640_GetImage(frameData, &_params, framebuf);
+}
+
+/*!
+ *    @brief  Replace the broken and outlier pixels of the EEPROM by their
+ *            neighbours (MLX90640_BadPixelsCorrection), in the readout mode
+ *            of the frame.
+ *    @param  frameData 834 words in MLX90640_GetFrameData layout, only the
+ *            control register is used
+ *    @param  framebuf 24*32 floating point memory buffer with both sub-pages
+ */
+void Adafruit_MLX90640::correctBadPixels(uint16_t *frameData,
+                                         float *framebuf) {
+  int mode = (frameData[832] & 0x1000) >> 12;
+  MLX90640_BadPixelsCorrection(_params.brokenPixels, framebuf, mode, &_params);
+  MLX90640_BadPixelsCorrection(_params.outlierPixels, framebuf, mode,
+                               &_params);
+}
+
 /*!
  *    @brief  Return ambient temperature of the TO39 package.
  *    @param  newFrame If true, will also capture a new data frame. If false,
@@ -207,7 +345,86 @@ float Adafruit_MLX90640::getTa(bool newFrame) {
   if (!newFrame) {
     return ta;
   }
-  uint16_t mlx90640Frame[834];
   MLX90640_GetFrameData(0, mlx90640Frame);
   return MLX90640_GetTa(mlx90640Frame, &_params);
 }
+
+#ifndef MLX90640_NO_BUSIO
+/*!
+ *    @brief  Instantiates a BusIO based transport
+ *    @param  i2c_addr The I2C address to be used.
+ *    @param  wire The Wire object to be used for I2C connections.
+ */
+MLX90640_I2CDeviceTransport::MLX90640_I2CDeviceTransport(uint8_t i2c_addr,
+                                                         TwoWire *wire) {
+  i2c_dev = new Adafruit_I2CDevice(i2c_addr, wire);
+}
+
+MLX90640_I2CDeviceTransport::~MLX90640_I2CDeviceTransport() {
+  delete i2c_dev;
+}
+
+/*!
+ *    @brief  Initializes I2C and checks for the device
+ *    @return True if the device acknowledged its address
+ */
+bool MLX90640_I2CDeviceTransport::begin(void) { return i2c_dev->begin(); }
+
+/*!
+ *    @brief  Read nWords words from I2C startAddress into data, chunked to
+ *            the buffer size of the I2C device
+ *    @param  startAddress I2C memory address to start reading
+ *    @param  nWords 16-bit words to read
+ *    @param  data Location to place data read
+ *    @return 0 on success
+ */
+int MLX90640_I2CDeviceTransport::read(uint16_t startAddress, uint16_t nWords,
+                                      uint16_t *data) {
+  uint8_t cmd[2];
+
+  while (nWords > 0) {
+    uint16_t toRead16 =
+        min(nWords, (uint16_t)(i2c_dev->maxBufferSize() / 2));
+
+    cmd[0] = startAddress >> 8;
+    cmd[1] = startAddress & 0x00FF;
+    // Serial.printf("Reading %d words\n", toRead16);
+    if (!i2c_dev->write_then_read(cmd, 2, (uint8_t *)data, toRead16 * 2,
+                                  false)) {
+      return -1;
+    }
+    // we now have to swap every two bytes
+    for (int i = 0; i < toRead16; i++) {
+      data[i] = __builtin_bswap16(data[i]);
+    }
+    // advance buffer
+    data += toRead16;
+    // advance address
+    startAddress += toRead16;
+    // reduce remaining to read
+    nWords -= toRead16;
+  }
+  // success!
+  return 0;
+}
+
+/*!
+ *    @brief  Write one word to I2C writeAddress
+ *    @param  writeAddress I2C memory address to write
+ *    @param  data Value to write
+ *    @return 0 on success
+ */
+int MLX90640_I2CDeviceTransport::write(uint16_t writeAddress, uint16_t data) {
+  uint8_t cmd[4];
+
+  cmd[0] = writeAddress >> 8;
+  cmd[1] = writeAddress & 0x00FF;
+  cmd[2] = data >> 8;
+  cmd[3] = data & 0x00FF;
+
+  if (!i2c_dev->write(cmd, 4, true)) {
+    return -1;
+  }
+  return 0;
+}
+#endif
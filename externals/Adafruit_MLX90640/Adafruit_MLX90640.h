@@ -19,8 +19,13 @@
 
 #include "Arduino.h"
 #include "headers/MLX90640_API.h"
+#include "headers/MLX90640_ParamsCache.h"
+#include "headers/MLX90640_Transport.h"
+// native builds (e.g. against a simulated sensor) have no BusIO
+#ifndef MLX90640_NO_BUSIO
 #include <Adafruit_I2CDevice.h>
 #include <Wire.h>
+#endif
 
 #define MLX90640_I2CADDR_DEFAULT 0x33 ///< I2C address by default
 
@@ -54,6 +59,40 @@ typedef enum mlx90640_refreshrate {
 
 #define OPENAIR_TA_SHIFT 8 ///< Default 8 degree offset from ambient air
 
+#define MLX90640_WRITE_POLICY_SLOTS 4 ///< Registers with a non-default policy
+
+/** How MLX90640_I2CWrite checks that a register took the written value */
+typedef enum mlx90640_write_policy {
+  MLX90640_WRITE_VERIFY,     ///< Settle 1 ms, read back and compare (default)
+  MLX90640_WRITE_DEFERRED,   ///< Compare on the next read of the register
+  MLX90640_WRITE_UNVERIFIED, ///< Fire and forget
+} mlx90640_write_policy_t;
+
+/** Counters of the register write verification */
+typedef struct {
+  uint32_t writes;               ///< Successful bus writes
+  uint32_t verifications;        ///< Read backs compared, immediate or deferred
+  uint32_t verificationFailures; ///< Read backs that did not match
+} mlx90640_write_stats_t;
+
+#ifndef MLX90640_NO_BUSIO
+/*!
+ *    @brief  Transport that reads and writes the sensor through Adafruit BusIO
+ */
+class MLX90640_I2CDeviceTransport : public MLX90640_Transport {
+public:
+  MLX90640_I2CDeviceTransport(uint8_t i2c_addr, TwoWire *wire);
+  ~MLX90640_I2CDeviceTransport();
+
+  bool begin(void);
+  int read(uint16_t startAddress, uint16_t nWords, uint16_t *data);
+  int write(uint16_t writeAddress, uint16_t data);
+
+private:
+  Adafruit_I2CDevice *i2c_dev;
+};
+#endif
+
 /*!
  *    @brief  Class that stores state and functions for interacting with
  *            the MLX90640 sensor
@@ -61,8 +100,13 @@ typedef enum mlx90640_refreshrate {
 class Adafruit_MLX90640 {
 public:
   Adafruit_MLX90640();
+#ifndef MLX90640_NO_BUSIO
   boolean begin(uint8_t i2c_addr = MLX90640_I2CADDR_DEFAULT,
                 TwoWire *wire = &Wire);
+#endif
+  boolean begin(MLX90640_Transport *transport,
+                MLX90640_ParamsCache *paramsCache = NULL);
+  boolean loadEEPROM(const uint16_t *eeData);
 
   mlx90640_mode_t getMode(void);
   void setMode(mlx90640_mode_t mode);
@@ -72,20 +116,44 @@ public:
   void setRefreshRate(mlx90640_refreshrate_t res);
 
   int getFrame(float *framebuf);
+  void calculateSubpage(uint16_t *frameData, float *framebuf);
+  void calculateSubpageImage(uint16_t *frameData, float *framebuf);
+  void correctBadPixels(uint16_t *frameData, float *framebuf);
 
   float getTa(bool newFrame = true);
 
-  uint16_t serialNumber[3]; ///< Unique serial number read from device
-
-private:
   int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress,
                        uint16_t nMemAddressRead, uint16_t *data);
   int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress,
                         uint16_t data);
 
-  Adafruit_I2CDevice *i2c_dev;
+  bool setWritePolicy(uint16_t writeAddress, mlx90640_write_policy_t policy,
+                      uint16_t verifyMask = 0xFFFF);
+  const mlx90640_write_stats_t &getWriteStats(void) { return _writeStats; }
+  const paramsMLX90640 &getParams(void) { return _params; }
+
+  uint16_t serialNumber[3]; ///< Unique serial number read from device
+
+private:
+  typedef struct {
+    uint16_t address;
+    mlx90640_write_policy_t policy;
+    uint16_t verifyMask; ///< Bits compared, others may change on their own
+    bool pending;        ///< Deferred verification outstanding
+    uint16_t pendingValue;
+  } mlx90640_write_policy_slot_t;
+
+  mlx90640_write_policy_slot_t *findWritePolicy(uint16_t writeAddress);
+  void checkDeferredWrites(uint16_t startAddress, uint16_t nWords,
+                           const uint16_t *data);
+
+  MLX90640_Transport *_transport = NULL;
+  mlx90640_write_policy_slot_t _writePolicies[MLX90640_WRITE_POLICY_SLOTS];
+  uint8_t _writePolicyCount = 0;
+  mlx90640_write_stats_t _writeStats = {0, 0, 0};
   paramsMLX90640 _params;
   float ta = -999.0;
+  uint16_t mlx90640Frame[834]; ///< Raw sub-page of getFrame() and getTa()
 
   int MLX90640_DumpEE(uint8_t slaveAddr, uint16_t *eeData);
   int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData);
@@ -0,0 +1,44 @@
+/*!
+ *  @file MLX90640_ParamsCache.h
+ *
+ *  Persistent storage of the calibration parameters extracted from the
+ *  EEPROM. With a cache passed to Adafruit_MLX90640::begin() a warm boot
+ *  only reads the serial number instead of dumping the EEPROM and running
+ *  MLX90640_ExtractParameters.
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _MLX90640_PARAMSCACHE_H
+#define _MLX90640_PARAMSCACHE_H
+
+#include <stdint.h>
+
+#include "MLX90640_API.h"
+
+/*!
+ *    @brief  Interface for loading and storing paramsMLX90640 per sensor
+ */
+class MLX90640_ParamsCache {
+public:
+  virtual ~MLX90640_ParamsCache() {}
+
+  /*!
+   *    @brief  Load the parameters stored for a sensor
+   *    @param  serialNumber The 3 words of the device id registers
+   *    @param  params Destination, only valid if true is returned
+   *    @return True if valid parameters of this sensor were found
+   */
+  virtual bool load(const uint16_t *serialNumber, paramsMLX90640 *params) = 0;
+
+  /*!
+   *    @brief  Store the parameters of a sensor
+   *    @param  serialNumber The 3 words of the device id registers
+   *    @param  params Parameters extracted from the EEPROM of that sensor
+   *    @return True if the parameters were stored
+   */
+  virtual bool store(const uint16_t *serialNumber,
+                     const paramsMLX90640 *params) = 0;
+};
+
+#endif
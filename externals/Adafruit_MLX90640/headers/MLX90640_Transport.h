@@ -0,0 +1,48 @@
+/*!
+ *  @file MLX90640_Transport.h
+ *
+ *  Register level access to the MLX90640 used by MLX90640_I2CRead and
+ *  MLX90640_I2CWrite. The default implementation talks to the sensor through
+ *  Adafruit BusIO, other implementations (e.g. a simulated sensor) can be
+ *  passed to Adafruit_MLX90640::begin().
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _MLX90640_TRANSPORT_H
+#define _MLX90640_TRANSPORT_H
+
+#include <stdint.h>
+
+/*!
+ *    @brief  Interface for reading and writing 16 bit MLX90640 registers
+ */
+class MLX90640_Transport {
+public:
+  virtual ~MLX90640_Transport() {}
+
+  /*!
+   *    @brief  Prepare the bus and check that the device answers
+   *    @return True if the device was found
+   */
+  virtual bool begin(void) { return true; }
+
+  /*!
+   *    @brief  Read consecutive 16 bit words
+   *    @param  startAddress Register address of the first word
+   *    @param  nWords Number of words to read
+   *    @param  data Destination, words in host byte order
+   *    @return 0 on success, -1 on a bus error
+   */
+  virtual int read(uint16_t startAddress, uint16_t nWords, uint16_t *data) = 0;
+
+  /*!
+   *    @brief  Write one 16 bit word
+   *    @param  writeAddress Register address
+   *    @param  data Value to write
+   *    @return 0 on success, -1 on a bus error
+   */
+  virtual int write(uint16_t writeAddress, uint16_t data) = 0;
+};
+
+#endif
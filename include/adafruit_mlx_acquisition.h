@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Adafruit_MLX90640.h>
+#include <Arduino.h>
+
+#include "mlx_acquisition.h"
+#include "mlx_transport.h"
+
+namespace thermocam {
+
+class AdafruitMlxAcquisition : public MlxSubpageAcquisition
+{
+public:
+    AdafruitMlxAcquisition() = delete;
+    AdafruitMlxAcquisition(Adafruit_MLX90640 &mlx,
+                           uint32_t subpage_period_ms,
+                           uint32_t poll_interval_ms = 1)
+        : MlxSubpageAcquisition(
+                [&mlx](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                    return mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+                },
+                [&mlx](uint16_t address, uint16_t value) { return mlx.MLX90640_I2CWrite(0, address, value); },
+                millis,
+                subpage_period_ms,
+                poll_interval_ms)
+    {
+    }
+
+    // mlx has to be started with the same transport
+    AdafruitMlxAcquisition(Adafruit_MLX90640 &mlx,
+                           AsyncMlxTransport &transport,
+                           uint32_t subpage_period_ms,
+                           uint32_t poll_interval_ms = 1)
+        : MlxSubpageAcquisition(
+                transport,
+                [&mlx](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                    return mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+                },
+                [&mlx](uint16_t address, uint16_t value) { return mlx.MLX90640_I2CWrite(0, address, value); },
+                millis,
+                subpage_period_ms,
+                poll_interval_ms)
+    {
+    }
+};
+
+} // namespace thermocam
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cmath>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "fixed_matrix.h"
 
@@ -57,4 +59,19 @@ constexpr void bilinear_upscale(
     }
 }
 
+// CRC-32 (IEEE 802.3, as zlib), one nibble at a time to keep the table small. Pass the previous result as crc to
+// continue over several buffers.
+[[nodiscard]] constexpr uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0) noexcept
+{
+    constexpr uint32_t NIBBLE_TABLE[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+                                           0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+                                           0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = NIBBLE_TABLE[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = NIBBLE_TABLE[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
 } // namespace thermocam::algorithms
\ No newline at end of file
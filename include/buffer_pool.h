@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <stdint.h>
+
+#include "spsc_ring.h"
+
+namespace thermocam {
+
+struct BufferPoolStats
+{
+    uint32_t published;
+    uint32_t consumed;
+    // acquire() found no free buffer, the producer has to drop its data
+    uint32_t starvations;
+    // published buffers that consume_latest() skipped because a newer one was available
+    uint32_t overwrites;
+};
+
+// Fixed set of buffers handed between one producer and one consumer without copies. A buffer is always owned by
+// exactly one place: the free ring, the producer (acquire -> publish), the ready ring or the consumer
+// (consume -> release). Both rings hold all buffers, so publish() and release() never fail.
+template <typename T, size_t Count>
+class BufferPool
+{
+public:
+    BufferPool()
+    {
+        for (auto &buffer : _buffers) {
+            _free.push(&buffer);
+        }
+    }
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // producer: a free buffer or nullptr if the consumer holds or has not yet consumed all of them
+    T *acquire()
+    {
+        T *buffer = nullptr;
+        if (!_free.pop(buffer)) {
+            _starvations.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return buffer;
+    }
+
+    // producer: hand a filled buffer over to the consumer
+    void publish(T *buffer)
+    {
+        [[maybe_unused]] bool pushed = _ready.push(buffer);
+        assert(pushed);
+        _published.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // consumer: true if consume() would return a buffer
+    [[nodiscard]] bool has_ready() const noexcept { return _ready.size() > 0; }
+
+    // consumer: oldest published buffer or nullptr, for streams where every element counts (sub-pages)
+    T *consume()
+    {
+        T *buffer = nullptr;
+        if (!_ready.pop(buffer)) {
+            return nullptr;
+        }
+        _consumed.fetch_add(1, std::memory_order_relaxed);
+        return buffer;
+    }
+
+    // consumer: newest published buffer or nullptr, older ones go straight back to the pool (e.g. display frames)
+    T *consume_latest()
+    {
+        T *latest = consume();
+        T *newer = nullptr;
+        while (latest != nullptr && (newer = consume()) != nullptr) {
+            release(latest);
+            _overwrites.fetch_add(1, std::memory_order_relaxed);
+            latest = newer;
+        }
+        return latest;
+    }
+
+    // consumer: give a consumed buffer back
+    void release(T *buffer)
+    {
+        assert(buffer >= _buffers.data() && buffer < _buffers.data() + Count);
+        [[maybe_unused]] bool pushed = _free.push(buffer);
+        assert(pushed);
+    }
+
+    [[nodiscard]] BufferPoolStats stats() const noexcept
+    {
+        return {_published.load(std::memory_order_relaxed), _consumed.load(std::memory_order_relaxed),
+                _starvations.load(std::memory_order_relaxed), _overwrites.load(std::memory_order_relaxed)};
+    }
+
+    [[nodiscard]] constexpr size_t size() const noexcept { return Count; }
+
+private:
+    std::array<T, Count> _buffers{};
+    SpscRing<T *, Count> _free;  // consumer -> producer
+    SpscRing<T *, Count> _ready; // producer -> consumer
+
+    // each counter has a single writer
+    std::atomic<uint32_t> _published{0};
+    std::atomic<uint32_t> _consumed{0};
+    std::atomic<uint32_t> _starvations{0};
+    std::atomic<uint32_t> _overwrites{0};
+};
+
+} // namespace thermocam
@@ -8,6 +8,8 @@
 namespace thermocam {
 
 constexpr bool DEBUG_OUTPUT = false;
+// streams the raw sub-pages in the capture format (mlx_capture.h) over Serial instead of the debug text
+constexpr bool CAPTURE_OUTPUT = false;
 
 constexpr uint32_t SERIAL_BAUDRATE = 115200;
 
@@ -19,6 +21,48 @@ constexpr uint8_t UI_BTN_PIN = 2;
 constexpr uint8_t MLX_SENSOR_WIDTH = 32;
 constexpr uint8_t MLX_SENSOR_HEIGHT = 24;
 constexpr auto DEFAULT_MLX_REFRESH_RATE = Mlx90640RefreshRate::MLX90640_8_HZ;
+constexpr auto DEFAULT_MLX_RESOLUTION = Mlx90640BitResolution::MLX90640_ADC_18BIT;
+// refresh rate and resolution follow pipeline load and scene dynamics (mlx_rate_governor.h), starting at the defaults
+constexpr bool ADAPTIVE_REFRESH_RATE = true;
+constexpr auto GOVERNOR_MIN_REFRESH_RATE = Mlx90640RefreshRate::MLX90640_2_HZ;
+// 64 Hz loses sub-pages even at 1 MHz I2C
+constexpr auto GOVERNOR_MAX_REFRESH_RATE = Mlx90640RefreshRate::MLX90640_32_HZ;
+constexpr auto GOVERNOR_STATIC_REFRESH_RATE = Mlx90640RefreshRate::MLX90640_4_HZ;
+constexpr auto GOVERNOR_STATIC_RESOLUTION = Mlx90640BitResolution::MLX90640_ADC_19BIT;
+constexpr auto GOVERNOR_DYNAMIC_RESOLUTION = Mlx90640BitResolution::MLX90640_ADC_18BIT;
+// temperature calculation of the processing stage
+enum class TemperatureEngine
+{
+    REFERENCE, // Adafruit_MLX90640::calculateSubpage (MLX90640_CalculateTo)
+    COMPILED,   // MlxCalibration (mlx_calibration.h), per-pixel coefficients prepared once after begin()
+    FIXED_POINT // MlxFixedPointCalibration (mlx_fixed_point_calibration.h), integer kernel, max 0.01 C off the reference
+};
+// The ESP32-C3 has no FPU, the float engines run on soft-float there. FIXED_POINT stays opt-in until cycle counts
+// on the device (calculation line of DEBUG_OUTPUT) show its gain: on the host it is slower than COMPILED and its
+// per-pixel 64 bit divisions are __divdi3 calls on RV32.
+constexpr auto TEMPERATURE_ENGINE = TemperatureEngine::COMPILED;
+// range and first estimate of the To calculation predicted from the previous frame, one fourth root per pixel
+// instead of three while the scene is steady (set_single_pass() of the engines, not the reference one)
+constexpr bool SINGLE_PASS_TO = true;
+// colors from the relative image of the engines (no fourth roots) and To only for min, max, center, average and
+// the ROI_MONITORING regions, keeps 32 / 64 Hz on the ESP32-C3. The colors are linear in radiance between the scale
+// limits instead of temperature.
+constexpr bool RELATIVE_IMAGE_DISPLAY = false;
+// broken / outlier pixels of the EEPROM replaced by their neighbours after each sub-page (mlx_bad_pixels.h),
+// not in ROI_MONITORING without RELATIVE_IMAGE_DISPLAY
+constexpr bool BAD_PIXEL_CORRECTION = true;
+// pixels failing in the field (stuck, noisy, far off their neighbours) found at runtime (mlx_pixel_faults.h) and
+// corrected like the EEPROM ones, needs BAD_PIXEL_CORRECTION. Not with RELATIVE_IMAGE_DISPLAY.
+constexpr bool PIXEL_FAULT_DETECTION = true;
+// To only for the regions of interest of mlx_roi_monitor (mlx_roi.h) instead of the full frame, for fixed-mount
+// monitoring. The per-region stats go to Serial once per frame, the display is not updated. With
+// RELATIVE_IMAGE_DISPLAY the display stays on and the regions take their To from its image.
+constexpr bool ROI_MONITORING = false;
+// one sub-page being read, one being calculated, one spare for jitter of the processing stage
+constexpr size_t RAW_SUBPAGE_BUFFER_COUNT = 3;
+constexpr size_t TEMPERATURE_BUFFER_COUNT = 2;
+// sub-page records waiting for the capture sink, 1680 bytes each
+constexpr size_t CAPTURE_RECORD_BUFFER_COUNT = 4;
 
 constexpr uint8_t BILINEAR_INTERPOLATION_FACTOR = 2;
 constexpr uint8_t DRAW_INTERPOLATION_FACTOR = 4;
@@ -31,6 +75,43 @@ const auto MAX_TEMP_COLOR = color::common_colors::RED;
 
 constexpr float DEFAULT_MANUAL_MIN_TEMP = 5.0;
 constexpr float DEFAULT_MANUAL_MAX_TEMP = 40.0;
+// color scale of the autoscale mode
+enum class AutoscaleMode
+{
+    MIN_MAX,   // min and max of the frame, a single hot or dead pixel takes the whole scale
+    PERCENTILE // low and high percentile of a TemperatureHistogram (temperature_histogram.h) of the frame
+};
+// the relative image always scales by min and max
+constexpr auto AUTOSCALE_MODE = AutoscaleMode::PERCENTILE;
+constexpr float AUTOSCALE_LOW_PERCENTILE = 0.01f;
+constexpr float AUTOSCALE_HIGH_PERCENTILE = 0.99f;
+// scale beyond the min / max or the percentiles in C
+constexpr float AUTOSCALE_MARGIN = 1.0f;
+// source frame of the display colors, the live frame or a TemporalAccumulator (temporal_accumulator.h) of it. The
+// stats and the autoscale stay with the live frame.
+enum class TemporalView : uint8_t
+{
+    LIVE,          // latest frame
+    MEAN,          // exponential moving average
+    WINDOWED_MEAN, // mean over the latest TEMPORAL_WINDOW_FRAMES frames
+    MIN_HOLD,      // coldest value of each pixel since the holds were reset (button press)
+    MAX_HOLD,      // hottest value of each pixel since the holds were reset (button press)
+};
+constexpr auto TEMPORAL_VIEW = TemporalView::LIVE;
+// weight of the latest frame in the mean, frames of the windowed mean, C per frame the holds move back to the frame
+constexpr float TEMPORAL_MEAN_SMOOTHING = 0.1f;
+constexpr uint32_t TEMPORAL_WINDOW_FRAMES = 32;
+constexpr float TEMPORAL_HOLD_DECAY = 0.0f;
+// connected regions above HOTSPOT_THRESHOLD in each frame (hotspot_blobs.h), with area, peak, mean and centroid.
+// Not with RELATIVE_IMAGE_DISPLAY.
+constexpr bool HOTSPOT_DETECTION = true;
+constexpr float HOTSPOT_THRESHOLD = 40.0f;
+// pixels of the smallest blob reported, 1 keeps single hot pixels
+constexpr uint16_t HOTSPOT_MIN_AREA = 2;
+// hotspots followed over frames (hotspot_tracker.h): max distance in pixels of a blob from the predicted position
+// of its track, frames a track goes on without its blob
+constexpr float HOTSPOT_TRACK_GATE = 3.0f;
+constexpr uint16_t HOTSPOT_TRACK_MAX_MISSED_FRAMES = 3;
 constexpr auto MIN_TFT_TEMP_COLOR = color::convert_rgb888_to_rgb565(
     MIN_TEMP_COLOR.r(), MIN_TEMP_COLOR.g(), MIN_TEMP_COLOR.b());
 constexpr auto MAX_TFT_TEMP_COLOR = color::convert_rgb888_to_rgb565(
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "mlx_transport.h"
+
+namespace thermocam {
+
+// register address + one whole RAM block, TwoWire::setBufferSize() has to be called with it before TwoWire::begin()
+constexpr size_t MLX_WIRE_BUFFER_SIZE = 2 + 2 * MLX_TRANSPORT_MAX_READ_WORDS;
+constexpr uint32_t MLX_WIRE_TASK_STACK_SIZE = 2048;
+// above the Arduino loop task, so a finished transaction is picked up right away
+constexpr UBaseType_t MLX_WIRE_TASK_PRIORITY = 2;
+// bus recovery is clocked by hand at about 100 kHz, slow enough for any slave
+constexpr uint32_t MLX_WIRE_RECOVERY_HALF_PERIOD_US = 5;
+constexpr uint8_t MLX_WIRE_RECOVERY_CLOCK_PULSES = 9;
+
+// Runs the reads as one Wire transaction each in a worker task. The I2C driver blocks the worker until the
+// transaction is done, meanwhile the loop task keeps the CPU (e.g. for the temperature calculation of the previous
+// sub-page). Writes are short and stay blocking in the calling task.
+class Esp32WireTransport : public AsyncMlxTransport
+{
+public:
+    Esp32WireTransport() = delete;
+    Esp32WireTransport(TwoWire &wire, uint8_t i2c_address)
+        : AsyncMlxTransport(micros),
+          _wire(wire),
+          _i2c_address(i2c_address)
+    {
+    }
+
+    bool begin() override
+    {
+        _wire.beginTransmission(_i2c_address);
+        if (_wire.endTransmission() != 0) {
+            return false;
+        }
+        if (_worker_task == nullptr) {
+            _done_semaphore = xSemaphoreCreateBinary();
+            xTaskCreate(_worker_loop, "mlx_wire", MLX_WIRE_TASK_STACK_SIZE, this, MLX_WIRE_TASK_PRIORITY,
+                        &_worker_task);
+        }
+        return _worker_task != nullptr && _done_semaphore != nullptr;
+    }
+
+    int write(uint16_t address, uint16_t value) override
+    {
+        if (is_busy()) {
+            return -1; // the worker owns the bus
+        }
+        _wire.beginTransmission(_i2c_address);
+        _wire.write(address >> 8);
+        _wire.write(address & 0xFF);
+        _wire.write(value >> 8);
+        _wire.write(value & 0xFF);
+        return _wire.endTransmission() == 0 ? 0 : -1;
+    }
+
+    // Bus recovery (I2C specification 3.1.16): a slave that missed clocks in the middle of a read keeps SDA low and
+    // NACKs everything afterwards. Up to nine clock pulses let it shift out the rest of its byte, a stop condition
+    // ends the transaction and the driver is started again. Not possible while the worker owns the bus.
+    bool reset_bus(uint8_t sda_pin, uint8_t scl_pin, uint32_t frequency_hz)
+    {
+        if (is_busy()) {
+            return false;
+        }
+        _wire.end();
+        pinMode(sda_pin, INPUT_PULLUP);
+        pinMode(scl_pin, OUTPUT_OPEN_DRAIN);
+        digitalWrite(scl_pin, HIGH);
+        for (uint8_t pulse = 0; pulse < MLX_WIRE_RECOVERY_CLOCK_PULSES && digitalRead(sda_pin) == LOW; pulse++) {
+            digitalWrite(scl_pin, LOW);
+            delayMicroseconds(MLX_WIRE_RECOVERY_HALF_PERIOD_US);
+            digitalWrite(scl_pin, HIGH);
+            delayMicroseconds(MLX_WIRE_RECOVERY_HALF_PERIOD_US);
+        }
+        // stop condition: SDA rises while SCL is high
+        pinMode(sda_pin, OUTPUT_OPEN_DRAIN);
+        digitalWrite(scl_pin, LOW);
+        digitalWrite(sda_pin, LOW);
+        delayMicroseconds(MLX_WIRE_RECOVERY_HALF_PERIOD_US);
+        digitalWrite(scl_pin, HIGH);
+        delayMicroseconds(MLX_WIRE_RECOVERY_HALF_PERIOD_US);
+        digitalWrite(sda_pin, HIGH);
+        delayMicroseconds(MLX_WIRE_RECOVERY_HALF_PERIOD_US);
+
+        _wire.setBufferSize(MLX_WIRE_BUFFER_SIZE);
+        return _wire.begin(sda_pin, scl_pin, frequency_hz);
+    }
+
+protected:
+    bool _start_transfer(uint16_t start_address, uint16_t word_count, uint8_t *wire_bytes) override
+    {
+        _start_address = start_address;
+        _word_count = word_count;
+        _wire_bytes = wire_bytes;
+        _finished.store(false, std::memory_order_relaxed);
+        xSemaphoreTake(_done_semaphore, 0); // drop a completion that was already seen by poll()
+        xTaskNotifyGive(_worker_task);
+        return true;
+    }
+
+    bool _is_transfer_finished(int &error) override
+    {
+        if (!_finished.load(std::memory_order_acquire)) {
+            return false;
+        }
+        error = _error;
+        return true;
+    }
+
+    void _wait_for_transfer() override { xSemaphoreTake(_done_semaphore, portMAX_DELAY); }
+
+private:
+    static void _worker_loop(void *transport)
+    {
+        auto &self = *static_cast<Esp32WireTransport *>(transport);
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            self._error = self._transfer();
+            self._finished.store(true, std::memory_order_release);
+            xSemaphoreGive(self._done_semaphore);
+        }
+    }
+
+    int _transfer()
+    {
+        _wire.beginTransmission(_i2c_address);
+        _wire.write(_start_address >> 8);
+        _wire.write(_start_address & 0xFF);
+        if (_wire.endTransmission(false) != 0) {
+            return -1;
+        }
+        size_t byte_count = 2 * _word_count;
+        if (_wire.requestFrom(static_cast<uint16_t>(_i2c_address), byte_count, true) != byte_count) {
+            return -1;
+        }
+        // raw bus order, swapped by the caller on completion
+        return _wire.readBytes(_wire_bytes, byte_count) == byte_count ? 0 : -1;
+    }
+
+    TwoWire &_wire;
+    uint8_t _i2c_address;
+    TaskHandle_t _worker_task = nullptr;
+    SemaphoreHandle_t _done_semaphore = nullptr;
+
+    // request, written by the caller before notifying the worker
+    uint16_t _start_address = 0;
+    uint16_t _word_count = 0;
+    uint8_t *_wire_bytes = nullptr;
+    // result, written by the worker before _finished is set
+    int _error = 0;
+    std::atomic<bool> _finished{false};
+};
+
+} // namespace thermocam
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+namespace thermocam {
+
+// Fourth roots of the To calculation without sqrt / pow: a table of inverse fourth roots seeds division-free Newton
+// steps in integer arithmetic, so neither the float nor the fixed-point variant needs an FPU or a division.
+
+// index bits of the seed table over the normalized input range [1/16, 1), 15/16 * 2^bits entries of 4 bytes
+constexpr int FOURTH_ROOT_SEED_BITS = 8;
+// relative error target, the number of Newton steps follows from it (three with the default table). Float results
+// add the rounding to 24 bits (6e-8), the integer arithmetic limits it to about 1e-8.
+constexpr double FOURTH_ROOT_MAX_RELATIVE_ERROR = 1e-7;
+// cycles per float fourth root aimed at on the ESP32-C3, against about 1000 for two soft-float sqrtf.
+// The firmware measures it at startup with DEBUG_OUTPUT.
+constexpr uint32_t FOURTH_ROOT_TARGET_CYCLES = 150;
+
+// sqrt is an instruction on cores with an FPU, two of them are faster than the Newton steps there
+#if defined(__riscv) && !defined(__riscv_flen)
+constexpr bool HAS_HARDWARE_SQRT = false;
+#else
+constexpr bool HAS_HARDWARE_SQRT = true;
+#endif
+
+namespace fourth_root_internal {
+
+// inverse fourth root r in 3.29 bits, input x in 0.32 bits
+constexpr int INVERSE_ROOT_FRACTION_BITS = 29;
+constexpr uint32_t SEED_OFFSET = 1u << (FOURTH_ROOT_SEED_BITS - 4);
+
+// seed error of the table center within the widest relative interval, then r' = r * (5 - x * r^4) / 4 leaves
+// -2.5 * e^2 and x * r^3 triples it
+constexpr int newton_steps(double max_relative_error)
+{
+    double error = 1.1 / (1 << (FOURTH_ROOT_SEED_BITS - 1));
+    int steps = 0;
+    while (3.0 * error > max_relative_error) {
+        error = 2.5 * error * error + 1e-9;
+        steps++;
+    }
+    return steps;
+}
+static_assert(FOURTH_ROOT_MAX_RELATIVE_ERROR > 1e-8, "below the precision of the integer arithmetic");
+constexpr int NEWTON_STEPS = newton_steps(FOURTH_ROOT_MAX_RELATIVE_ERROR);
+
+constexpr double constexpr_inverse_fourth_root(double x)
+{
+    double r = 1.0; // below the root for x < 1, the iteration converges monotonically
+    for (int iteration = 0; iteration < 64; iteration++) {
+        r = r * (5.0 - x * r * r * r * r) / 4.0;
+    }
+    return r;
+}
+
+constexpr auto make_seed_table()
+{
+    std::array<uint32_t, (1u << FOURTH_ROOT_SEED_BITS) - SEED_OFFSET> table{};
+    for (uint32_t index = 0; index < table.size(); index++) {
+        double center = (index + SEED_OFFSET + 0.5) / (1u << FOURTH_ROOT_SEED_BITS);
+        table[index] = static_cast<uint32_t>(constexpr_inverse_fourth_root(center) * (1u << INVERSE_ROOT_FRACTION_BITS));
+    }
+    return table;
+}
+inline constexpr auto SEED_TABLE = make_seed_table();
+
+// r' = r * (5 - x * r^4) / 4, every product fits 64 bit for x < 1 and r <= 2
+constexpr uint32_t newton_step(uint32_t x, uint32_t r) noexcept
+{
+    uint64_t r2 = (static_cast<uint64_t>(r) * r) >> INVERSE_ROOT_FRACTION_BITS;
+    uint64_t x_r2 = (x * r2) >> 32;
+    uint64_t x_r4 = (x_r2 * r2) >> INVERSE_ROOT_FRACTION_BITS;
+    uint64_t correction = (uint64_t{5} << INVERSE_ROOT_FRACTION_BITS) - x_r4;
+    return static_cast<uint32_t>((r * correction) >> (INVERSE_ROOT_FRACTION_BITS + 2));
+}
+
+// x^(1/4) in [0.5, 1) with 29 fraction bits of x in [2^28, 2^32) as 0.32 bits
+constexpr uint32_t normalized_fourth_root(uint32_t x) noexcept
+{
+    auto r = SEED_TABLE[(x >> (32 - FOURTH_ROOT_SEED_BITS)) - SEED_OFFSET];
+    for (int step = 0; step < NEWTON_STEPS; step++) {
+        r = newton_step(x, r);
+    }
+    uint64_t r3 = (((static_cast<uint64_t>(r) * r) >> INVERSE_ROOT_FRACTION_BITS) * r) >> INVERSE_ROOT_FRACTION_BITS;
+    return static_cast<uint32_t>((x * r3) >> 32);
+}
+
+} // namespace fourth_root_internal
+
+// Replaces sqrt(sqrt(value)): negative values give NaN, +-0, infinity and NaN are returned unchanged
+[[nodiscard]] inline float fourth_root(float value) noexcept
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    auto biased_exponent = static_cast<int>((bits >> 23) & 0xFF);
+    if ((bits & 0x7FFFFFFF) == 0 || biased_exponent == 0xFF) {
+        return value;
+    }
+    if (bits >> 31) {
+        return NAN;
+    }
+    if (biased_exponent == 0) {
+        return fourth_root(value * 0x1p64f) * 0x1p-16f; // subnormal
+    }
+
+    // value = mantissa * 2^exponent = x * 2^(32 + shift) with x = (mantissa << normalize) / 2^32 in [1/16, 1)
+    // and the shift a multiple of four
+    uint32_t mantissa = (bits & 0x7FFFFF) | 0x800000;
+    int exponent = biased_exponent - 150;
+    int normalize = 5 + ((exponent - 5) & 3);
+    int shift = exponent - normalize;
+    auto root = fourth_root_internal::normalized_fourth_root(mantissa << normalize);
+
+    // root in [2^28, 2^29) is 1.f * 2^((32 + shift) / 4 - 1), rounded to 24 bits. A root just below 2^28 borrows from
+    // the exponent, a carry of the rounding adds to it, both give the right float.
+    int result_exponent = (32 + shift) / 4 - 1 + 127;
+    uint32_t result_bits = (static_cast<uint32_t>(result_exponent) << 23) + ((root + 16) >> 5) - 0x800000;
+    float result;
+    std::memcpy(&result, &result_bits, sizeof(result));
+    return result;
+}
+
+// Fourth root of the float To kernels: sqrt(sqrt()) with hardware sqrt, fourth_root() on cores without FPU
+[[nodiscard]] inline float fast_fourth_root(float value) noexcept
+{
+    if constexpr (HAS_HARDWARE_SQRT) {
+        return std::sqrt(std::sqrt(value));
+    } else {
+        return fourth_root(value);
+    }
+}
+
+// Fourth root of an integer with FRACTION_BITS fraction bits, e.g. K^4 to Kelvin, for values below 2^60.
+// Negative values give -1.
+template <int FRACTION_BITS> [[nodiscard]] constexpr int32_t fixed_point_fourth_root(int64_t value) noexcept
+{
+    static_assert(FRACTION_BITS >= 0 && FRACTION_BITS <= 16);
+    if (value <= 0) {
+        return value == 0 ? 0 : -1;
+    }
+    // value = x * 2^(32 + shift) with x in [1/16, 1) and the shift a multiple of four
+    int bit_length = 64 - __builtin_clzll(static_cast<uint64_t>(value));
+    int shift = bit_length > 28 ? (bit_length - 29) / 4 * 4 : -((32 - bit_length) / 4 * 4);
+    auto x = static_cast<uint32_t>(shift >= 0 ? value >> shift : value << -shift);
+    auto root = fourth_root_internal::normalized_fourth_root(x);
+
+    // root has 29 fraction bits and scales with 2^((32 + shift) / 4)
+    int root_shift = (32 + shift) / 4 - fourth_root_internal::INVERSE_ROOT_FRACTION_BITS + FRACTION_BITS;
+    if (root_shift >= 0) {
+        return static_cast<int32_t>(root << root_shift);
+    }
+    return static_cast<int32_t>((root + (1u << (-root_shift - 1))) >> -root_shift);
+}
+
+} // namespace thermocam
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mlx_pixel_layout.h"
+#include "types/container_types.h"
+
+namespace thermocam {
+
+// blobs reported per frame, the hottest ones
+constexpr size_t HOTSPOT_MAX_BLOB_COUNT = 16;
+
+// Connected region of pixels above the threshold
+struct HotspotBlob
+{
+    uint16_t area;
+    uint16_t peak_index;
+    float peak_temp;
+    float mean_temp;
+    // in pixels, weighted by the temperature above the threshold
+    float centroid_x;
+    float centroid_y;
+};
+
+// Pixels above a threshold as a bit-packed mask, a 32 bit word per row
+inline void threshold_mask(const ThermoImage &frame, float threshold, MlxPixelBitmap &mask) noexcept
+{
+    for (size_t row = 0; row < MLX_SENSOR_HEIGHT; row++) {
+        uint32_t bits = 0;
+        const auto *temperatures = frame.data() + row * MLX_SENSOR_WIDTH;
+        for (size_t column = 0; column < MLX_SENSOR_WIDTH; column++) {
+            bits |= static_cast<uint32_t>(temperatures[column] > threshold) << column; // NaN is below
+        }
+        mask.set_row(row, bits);
+    }
+}
+
+// Single-pass connected-component labeling (8-connected) of the threshold mask. The rows are cut into runs of set
+// bits with a few bit operations, each run joins the labels of the runs it touches in the row above in a union-find
+// and its pixels go into the sums of its label right away, so the frame is read once. The roots of the union-find
+// hold the sums of their blob, what is left after the pass is a walk over the labels. Fixed storage for the worst
+// case of a run on every other pixel, about 10 kB.
+class HotspotLabeler
+{
+public:
+    // blobs of the pixels above threshold, the hottest HOTSPOT_MAX_BLOB_COUNT with at least min_area pixels
+    size_t update(const ThermoImage &frame, float threshold, uint16_t min_area = 1)
+    {
+        threshold_mask(frame, threshold, _mask);
+        return update(frame, _mask, threshold, min_area);
+    }
+
+    // same with a mask of the caller, threshold is the zero of the centroid weights
+    size_t update(const ThermoImage &frame, const MlxPixelBitmap &mask, float threshold, uint16_t min_area = 1)
+    {
+        if (&mask != &_mask) {
+            _mask = mask;
+        }
+        _label_count = 0;
+        std::array<Run, MAX_ROW_RUN_COUNT> runs[2];
+        size_t previous_run_count = 0;
+        for (size_t row = 0; row < MLX_SENSOR_HEIGHT; row++) {
+            auto &current_runs = runs[row % 2];
+            const auto &previous_runs = runs[(row + 1) % 2];
+            size_t run_count = 0;
+            size_t previous = 0;
+            uint32_t bits = _mask.row(row);
+            while (bits != 0) {
+                uint8_t start = __builtin_ctz(bits);
+                uint32_t rest = ~(bits >> start);
+                uint8_t end = rest == 0 ? MLX_SENSOR_WIDTH : start + __builtin_ctz(rest);
+                bits = end == MLX_SENSOR_WIDTH ? 0 : bits & (~0u << end);
+
+                // runs above that end before this one starts, diagonal neighbours included, do not touch it
+                while (previous < previous_run_count && previous_runs[previous].end < start) {
+                    previous++;
+                }
+                uint16_t label = NO_LABEL;
+                for (auto above = previous; above < previous_run_count && previous_runs[above].start <= end;
+                     above++) {
+                    auto root = _find(previous_runs[above].label);
+                    label = label == NO_LABEL ? root : _union(label, root);
+                }
+                if (label == NO_LABEL) {
+                    label = _new_label();
+                }
+                _add_run(label, frame, row, start, end, threshold);
+                current_runs[run_count++] = {start, end, label};
+            }
+            previous_run_count = run_count;
+        }
+        _collect_blobs(min_area);
+        return _blob_count;
+    }
+
+    const MlxPixelBitmap &mask() const noexcept { return _mask; }
+    // hottest peak first
+    const std::array<HotspotBlob, HOTSPOT_MAX_BLOB_COUNT> &blobs() const noexcept { return _blobs; }
+    size_t blob_count() const noexcept { return _blob_count; }
+    // blobs of the latest frame beyond HOTSPOT_MAX_BLOB_COUNT
+    size_t dropped_blob_count() const noexcept { return _dropped_blob_count; }
+
+private:
+    static constexpr size_t MAX_ROW_RUN_COUNT = MLX_SENSOR_WIDTH / 2;
+    static constexpr size_t MAX_LABEL_COUNT = MAX_ROW_RUN_COUNT * MLX_SENSOR_HEIGHT;
+    static constexpr uint16_t NO_LABEL = UINT16_MAX;
+
+    struct Run
+    {
+        uint8_t start;
+        uint8_t end; // exclusive
+        uint16_t label;
+    };
+
+    // sums of a label, complete in the roots after the pass
+    struct LabelSums
+    {
+        uint16_t area;
+        uint16_t peak_index;
+        float peak_temp;
+        float temperature_sum;
+        float weight_sum;
+        float weighted_x_sum;
+        float weighted_y_sum;
+    };
+
+    uint16_t _new_label() noexcept
+    {
+        auto label = static_cast<uint16_t>(_label_count++);
+        _parents[label] = label;
+        _sums[label] = {0, 0, -INFINITY, 0.0f, 0.0f, 0.0f, 0.0f};
+        return label;
+    }
+
+    // path halving
+    uint16_t _find(uint16_t label) noexcept
+    {
+        while (_parents[label] != label) {
+            _parents[label] = _parents[_parents[label]];
+            label = _parents[label];
+        }
+        return label;
+    }
+
+    // the lower label stays the root and takes the sums of the other one, equal peaks go to the first pixel
+    uint16_t _union(uint16_t root, uint16_t other_root) noexcept
+    {
+        if (root == other_root) {
+            return root;
+        }
+        if (other_root < root) {
+            std::swap(root, other_root);
+        }
+        _parents[other_root] = root;
+        auto &sums = _sums[root];
+        const auto &other = _sums[other_root];
+        sums.area += other.area;
+        if (other.peak_temp > sums.peak_temp ||
+            (other.peak_temp == sums.peak_temp && other.peak_index < sums.peak_index)) {
+            sums.peak_temp = other.peak_temp;
+            sums.peak_index = other.peak_index;
+        }
+        sums.temperature_sum += other.temperature_sum;
+        sums.weight_sum += other.weight_sum;
+        sums.weighted_x_sum += other.weighted_x_sum;
+        sums.weighted_y_sum += other.weighted_y_sum;
+        return root;
+    }
+
+    void _add_run(uint16_t label, const ThermoImage &frame, size_t row, uint8_t start, uint8_t end, float threshold)
+    {
+        auto &sums = _sums[label];
+        float row_weight_sum = 0.0f;
+        for (size_t column = start; column < end; column++) {
+            auto pixel_index = row * MLX_SENSOR_WIDTH + column;
+            auto temperature = frame[pixel_index];
+            if (temperature > sums.peak_temp) {
+                sums.peak_temp = temperature;
+                sums.peak_index = static_cast<uint16_t>(pixel_index);
+            }
+            sums.temperature_sum += temperature;
+            auto weight = temperature - threshold;
+            row_weight_sum += weight;
+            sums.weighted_x_sum += weight * column;
+        }
+        sums.area += end - start;
+        sums.weight_sum += row_weight_sum;
+        sums.weighted_y_sum += row_weight_sum * row;
+    }
+
+    // roots into blobs, kept sorted by peak while they are inserted
+    void _collect_blobs(uint16_t min_area)
+    {
+        _blob_count = 0;
+        _dropped_blob_count = 0;
+        for (size_t label = 0; label < _label_count; label++) {
+            if (_parents[label] != label || _sums[label].area < min_area) {
+                continue;
+            }
+            const auto &sums = _sums[label];
+            auto weight = sums.weight_sum > 0.0f ? sums.weight_sum : 1.0f;
+            HotspotBlob blob{sums.area,
+                             sums.peak_index,
+                             sums.peak_temp,
+                             sums.temperature_sum / sums.area,
+                             sums.weighted_x_sum / weight,
+                             sums.weighted_y_sum / weight};
+            if (_blob_count == _blobs.size()) {
+                _dropped_blob_count++;
+                if (blob.peak_temp <= _blobs.back().peak_temp) {
+                    continue;
+                }
+                _blob_count--;
+            }
+            auto position = _blob_count++;
+            for (; position > 0 && _blobs[position - 1].peak_temp < blob.peak_temp; position--) {
+                _blobs[position] = _blobs[position - 1];
+            }
+            _blobs[position] = blob;
+        }
+    }
+
+    MlxPixelBitmap _mask;
+    size_t _label_count = 0;
+    std::array<uint16_t, MAX_LABEL_COUNT> _parents{};
+    std::array<LabelSums, MAX_LABEL_COUNT> _sums{};
+    std::array<HotspotBlob, HOTSPOT_MAX_BLOB_COUNT> _blobs{};
+    size_t _blob_count = 0;
+    size_t _dropped_blob_count = 0;
+};
+
+} // namespace thermocam
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hotspot_blobs.h"
+#include "types/common_types.h"
+
+namespace thermocam {
+
+// tracks followed at once, blobs without a track start new ones hottest first while there is room
+constexpr size_t HOTSPOT_MAX_TRACK_COUNT = 8;
+
+// Multi-target tracker of the blobs of a HotspotLabeler. Each track predicts the centroid of its blob with a constant
+// velocity, the track / blob pairs closer than the gate to the prediction are assigned closest first (greedy global
+// nearest neighbour). Tracks without a blob coast on their velocity and end after max_missed_frames frames, blobs
+// without a track start one with the next id. Position and velocity follow the blobs like an alpha-beta filter with
+// alpha 1. Fixed storage, no heap.
+class HotspotTracker
+{
+public:
+    // gate: max distance in pixels between prediction and centroid, velocity_smoothing: weight of the latest
+    // prediction error in the velocity
+    explicit HotspotTracker(float gate = 3.0f, uint16_t max_missed_frames = 3, float velocity_smoothing = 0.5f)
+        : _gate_squared(gate * gate), _max_missed_frames(max_missed_frames), _velocity_smoothing(velocity_smoothing)
+    {
+    }
+
+    size_t update(const HotspotLabeler &labeler) { return update(labeler.blobs().data(), labeler.blob_count()); }
+
+    // blobs of the next frame, hottest first, returns the track count
+    size_t update(const HotspotBlob *blobs, size_t blob_count)
+    {
+        blob_count = std::min(blob_count, HOTSPOT_MAX_BLOB_COUNT);
+        // pairs within the gate, sorted by distance while they are inserted
+        size_t pair_count = 0;
+        for (size_t track_index = 0; track_index < _track_count; track_index++) {
+            const auto &track = _tracks[track_index];
+            auto predicted_x = track.x + track.velocity_x;
+            auto predicted_y = track.y + track.velocity_y;
+            for (size_t blob_index = 0; blob_index < blob_count; blob_index++) {
+                auto dx = blobs[blob_index].centroid_x - predicted_x;
+                auto dy = blobs[blob_index].centroid_y - predicted_y;
+                auto distance_squared = dx * dx + dy * dy;
+                if (!(distance_squared <= _gate_squared)) {
+                    continue;
+                }
+                auto position = pair_count++;
+                for (; position > 0 && _pairs[position - 1].distance_squared > distance_squared; position--) {
+                    _pairs[position] = _pairs[position - 1];
+                }
+                _pairs[position] = {distance_squared, static_cast<uint8_t>(track_index),
+                                    static_cast<uint8_t>(blob_index)};
+            }
+        }
+
+        std::array<bool, HOTSPOT_MAX_TRACK_COUNT> is_track_matched{};
+        std::array<bool, HOTSPOT_MAX_BLOB_COUNT> is_blob_matched{};
+        for (size_t pair_index = 0; pair_index < pair_count; pair_index++) {
+            const auto &pair = _pairs[pair_index];
+            if (is_track_matched[pair.track_index] || is_blob_matched[pair.blob_index]) {
+                continue;
+            }
+            is_track_matched[pair.track_index] = true;
+            is_blob_matched[pair.blob_index] = true;
+            _follow(_tracks[pair.track_index], blobs[pair.blob_index]);
+        }
+
+        // unmatched tracks coast or end, the others keep their order
+        size_t kept_count = 0;
+        for (size_t track_index = 0; track_index < _track_count; track_index++) {
+            auto track = _tracks[track_index];
+            if (!is_track_matched[track_index]) {
+                track.age++;
+                track.missed_frames++;
+                track.x += track.velocity_x;
+                track.y += track.velocity_y;
+                if (track.missed_frames > _max_missed_frames) {
+                    continue;
+                }
+            }
+            _tracks[kept_count++] = track;
+        }
+        _track_count = kept_count;
+
+        for (size_t blob_index = 0; blob_index < blob_count && _track_count < _tracks.size(); blob_index++) {
+            if (is_blob_matched[blob_index]) {
+                continue;
+            }
+            const auto &blob = blobs[blob_index];
+            _tracks[_track_count++] = {_next_id, 0, 0, blob.centroid_x, blob.centroid_y, 0.0f, 0.0f, blob.peak_temp,
+                                       blob.area};
+            _next_id = _next_id == UINT16_MAX ? 1 : _next_id + 1;
+        }
+        return _track_count;
+    }
+
+    // ends all tracks, the ids go on
+    void reset() noexcept { _track_count = 0; }
+
+    // oldest first
+    const std::array<HotspotTrack, HOTSPOT_MAX_TRACK_COUNT> &tracks() const noexcept { return _tracks; }
+    size_t track_count() const noexcept { return _track_count; }
+
+private:
+    struct Pair
+    {
+        float distance_squared;
+        uint8_t track_index;
+        uint8_t blob_index;
+    };
+
+    void _follow(HotspotTrack &track, const HotspotBlob &blob) noexcept
+    {
+        // error of the prediction, spread over the frames since the blob was last seen
+        auto frames = static_cast<float>(track.missed_frames + 1);
+        auto error_x = (blob.centroid_x - track.x - track.velocity_x) / frames;
+        auto error_y = (blob.centroid_y - track.y - track.velocity_y) / frames;
+        // seen only when it started, no velocity to smooth yet
+        auto smoothing = track.age == track.missed_frames ? 1.0f : _velocity_smoothing;
+        track.velocity_x += smoothing * error_x;
+        track.velocity_y += smoothing * error_y;
+        track.x = blob.centroid_x;
+        track.y = blob.centroid_y;
+        track.age++;
+        track.missed_frames = 0;
+        track.peak_temp = blob.peak_temp;
+        track.area = blob.area;
+    }
+
+    float _gate_squared;
+    uint16_t _max_missed_frames;
+    float _velocity_smoothing;
+    uint16_t _next_id = 1;
+    std::array<HotspotTrack, HOTSPOT_MAX_TRACK_COUNT> _tracks{};
+    size_t _track_count = 0;
+    std::array<Pair, HOTSPOT_MAX_TRACK_COUNT * HOTSPOT_MAX_BLOB_COUNT> _pairs{};
+};
+
+} // namespace thermocam
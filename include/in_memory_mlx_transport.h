@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+
+#include "mlx_transport.h"
+
+namespace thermocam {
+
+// Backend for tests without hardware: serves the registers of a synchronous device model (e.g. MlxSimulator) and
+// moves words_per_poll words per poll() into the transfer buffer, so a transaction stays in flight over several
+// calls like a DMA transfer would.
+class InMemoryMlxTransport : public AsyncMlxTransport
+{
+public:
+    InMemoryMlxTransport() = delete;
+    InMemoryMlxTransport(MLX90640_Transport &device, TimestampFunction timestamp_func, uint16_t words_per_poll = 64)
+        : AsyncMlxTransport(timestamp_func),
+          _device(device),
+          _words_per_poll(words_per_poll)
+    {
+        assert(_words_per_poll > 0);
+    }
+
+    bool begin() override { return _device.begin(); }
+
+    int write(uint16_t address, uint16_t value) override
+    {
+        if (is_busy()) {
+            return -1;
+        }
+        return _device.write(address, value);
+    }
+
+protected:
+    bool _start_transfer(uint16_t start_address, uint16_t word_count, uint8_t *wire_bytes) override
+    {
+        _next_address = start_address;
+        _remaining_words = word_count;
+        _wire_bytes = wire_bytes;
+        return true;
+    }
+
+    bool _is_transfer_finished(int &error) override
+    {
+        uint16_t chunk[MLX_TRANSPORT_MAX_READ_WORDS];
+        uint16_t chunk_words = std::min(_remaining_words, _words_per_poll);
+        error = _device.read(_next_address, chunk_words, chunk);
+        if (error != 0) {
+            return true;
+        }
+        for (uint16_t word_index = 0; word_index < chunk_words; word_index++) {
+            *_wire_bytes++ = chunk[word_index] >> 8;
+            *_wire_bytes++ = chunk[word_index] & 0xFF;
+        }
+        _next_address += chunk_words;
+        _remaining_words -= chunk_words;
+        return _remaining_words == 0;
+    }
+
+private:
+    MLX90640_Transport &_device;
+    uint16_t _words_per_poll;
+    uint16_t _next_address = 0;
+    uint16_t _remaining_words = 0;
+    uint8_t *_wire_bytes = nullptr;
+};
+
+} // namespace thermocam
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <stdint.h>
+
+#include "mlx_transport.h"
+
+namespace thermocam {
+
+// MLX90640 register map (see datasheet chapter 11)
+constexpr uint16_t MLX_RAM_START_ADDRESS = 0x0400;
+constexpr uint16_t MLX_STATUS_REGISTER = 0x8000;
+constexpr uint16_t MLX_CONTROL_REGISTER_1 = 0x800D;
+constexpr uint16_t MLX_EEPROM_START_ADDRESS = 0x2400;
+
+constexpr uint16_t MLX_STATUS_SUBPAGE_MASK = 0x0001;
+constexpr uint16_t MLX_STATUS_DATA_READY = 0x0008;
+// clears "new data available" and keeps overwrite + measurement running
+constexpr uint16_t MLX_STATUS_CLEAR_DATA_READY = 0x0030;
+constexpr uint16_t MLX_CONTROL_CHESS_MODE = 0x1000;
+constexpr uint16_t MLX_CONTROL_RESOLUTION_SHIFT = 10;
+constexpr uint16_t MLX_CONTROL_RESOLUTION_MASK = 0x0003;
+
+constexpr uint16_t MLX_RAM_WORDS = 832;
+constexpr uint16_t MLX_EEPROM_WORDS = 832;
+// RAM followed by control register 1 and the sub-page number (Melexis frame layout)
+constexpr uint16_t MLX_SUBPAGE_FRAME_WORDS = MLX_RAM_WORDS + 2;
+constexpr uint16_t MLX_CONTROL_REGISTER_WORD = MLX_RAM_WORDS;
+constexpr uint16_t MLX_SUBPAGE_NUMBER_WORD = MLX_RAM_WORDS + 1;
+// auxiliary data behind the pixels in RAM
+constexpr uint16_t MLX_VBE_RAM_WORD = 768;
+constexpr uint16_t MLX_CP_SUBPAGE_0_RAM_WORD = 776;
+constexpr uint16_t MLX_GAIN_RAM_WORD = 778;
+constexpr uint16_t MLX_PTAT_RAM_WORD = 800;
+constexpr uint16_t MLX_CP_SUBPAGE_1_RAM_WORD = 808;
+// supply voltage reading, its scale depends on the ADC resolution
+constexpr uint16_t MLX_VDD_RAM_WORD = 810;
+
+// same retry limit and error code as MLX90640_GetFrameData
+constexpr uint8_t MLX_MAX_SUBPAGE_READ_ATTEMPTS = 5;
+constexpr int MLX_ERROR_TOO_MANY_RETRIES = -8;
+// a failed register access is retried every poll interval for up to this share of the sub-page period, the sub-page
+// is given up afterwards so a broken bus can not hold up the caller longer than one sub-page
+constexpr uint32_t MLX_RETRY_BUDGET_DIVISOR = 2;
+// consecutive failed register accesses (e.g. NACKs of a slave holding SDA low) before the bus is reset
+constexpr uint32_t MLX_BUS_RESET_AFTER_ERRORS = 3;
+
+using MlxSubpageFrame = std::array<uint16_t, MLX_SUBPAGE_FRAME_WORDS>;
+using MlxEeprom = std::array<uint16_t, MLX_EEPROM_WORDS>;
+
+enum class AcquisitionState
+{
+    IDLE,              // nothing requested
+    WAITING_FOR_READY, // sensor integrates, status is polled once the predicted ready time passed
+    READING,           // RAM transfer of the sub-page in progress
+    READY              // sub-page available until release_subpage()
+};
+
+struct AcquisitionStats
+{
+    uint32_t status_polls_last_subpage;
+    uint32_t status_polls_total;
+    uint32_t subpages_read;
+    uint32_t read_retries;
+    // sub-pages given up after the retry budget or too many overwrites
+    uint32_t errors;
+    // failed register accesses, retried ones included
+    uint32_t bus_errors;
+    // sub-pages read successfully after at least one failed register access
+    uint32_t recovered_errors;
+    uint32_t bus_resets;
+    // poll() calls that returned while a submitted RAM transfer was still on the bus
+    uint32_t polls_during_transfer;
+};
+
+// Non-blocking replacement for the busy wait in MLX90640_GetFrameData.
+// Status register polls only start once the predicted ready time (last ready time + sub-page period) has passed,
+// so the caller can do other work (colorize, draw) while the sensor integrates.
+// Constructed with an AsyncMlxTransport the RAM block is read as one submitted transaction and poll() also returns
+// while it is on the bus.
+// Failed register accesses are retried within a time budget instead of failing the sub-page right away, repeated
+// failures reset the bus through the optional BusResetFunction.
+class MlxSubpageAcquisition
+{
+public:
+    // signatures mirror MLX90640_I2CRead/MLX90640_I2CWrite: 0 on success, negative error code otherwise
+    using RegisterReadFunction = std::function<int(uint16_t start_address, uint16_t word_count, uint16_t *data)>;
+    using RegisterWriteFunction = std::function<int(uint16_t address, uint16_t value)>;
+    using TimestampFunction = std::function<unsigned long()>;
+    // brings a stuck bus back (e.g. clock out a slave holding SDA low and restart the driver), false if not possible
+    using BusResetFunction = std::function<bool()>;
+
+    MlxSubpageAcquisition() = delete;
+    MlxSubpageAcquisition(RegisterReadFunction read_func,
+                          RegisterWriteFunction write_func,
+                          TimestampFunction timestamp_func,
+                          uint32_t subpage_period_ms,
+                          uint32_t poll_interval_ms = 1)
+        : _read_func(read_func),
+          _write_func(write_func),
+          _timestamp_func(timestamp_func),
+          _subpage_period_ms(subpage_period_ms),
+          _poll_interval_ms(poll_interval_ms)
+    {
+        assert(_read_func != nullptr);
+        assert(_write_func != nullptr);
+        assert(_timestamp_func != nullptr);
+        assert(_poll_interval_ms > 0);
+    }
+
+    // Only the RAM block goes through ram_transport, status and control register accesses are a single word each and
+    // stay blocking
+    MlxSubpageAcquisition(AsyncMlxTransport &ram_transport,
+                          RegisterReadFunction read_func,
+                          RegisterWriteFunction write_func,
+                          TimestampFunction timestamp_func,
+                          uint32_t subpage_period_ms,
+                          uint32_t poll_interval_ms = 1)
+        : MlxSubpageAcquisition(read_func, write_func, timestamp_func, subpage_period_ms, poll_interval_ms)
+    {
+        _async_transport = &ram_transport;
+    }
+
+    // Request the next sub-page. Does not touch the bus.
+    void begin_subpage() { begin_subpage(_frame); }
+
+    // Same, but the sub-page is read straight into target (e.g. a pool buffer), which has to stay valid until
+    // release_subpage() or until the state falls back to IDLE on an error
+    void begin_subpage(MlxSubpageFrame &target)
+    {
+        assert(_state == AcquisitionState::IDLE);
+
+        _target = &target;
+        _last_error = 0;
+        _is_retrying = false;
+        _stats.status_polls_last_subpage = 0;
+        _next_poll_time = _has_ready_time ? _predicted_ready_time() : _timestamp_func();
+        _state = AcquisitionState::WAITING_FOR_READY;
+    }
+
+    // Advance the state machine. Returns immediately while the sensor is still integrating.
+    // A failed register access is retried with the next poll() after the poll interval. Once the retry budget is
+    // used up the state falls back to IDLE and last_error() holds the error code.
+    AcquisitionState poll()
+    {
+        if (_state == AcquisitionState::WAITING_FOR_READY) {
+            _poll_status();
+        }
+        if (_state == AcquisitionState::READING && _is_time_reached(_timestamp_func(), _next_poll_time)) {
+            _read_subpage();
+        }
+        return _state;
+    }
+
+    // Raw sub-page in Melexis frame layout, valid while state() is READY
+    const MlxSubpageFrame &subpage_frame() const
+    {
+        assert(_state == AcquisitionState::READY);
+        return *_target;
+    }
+
+    MlxSubpageFrame &subpage_frame()
+    {
+        assert(_state == AcquisitionState::READY);
+        return *_target;
+    }
+
+    void release_subpage()
+    {
+        assert(_state == AcquisitionState::READY);
+        _state = AcquisitionState::IDLE;
+    }
+
+    // Needed after the refresh rate of the sensor was changed
+    void set_subpage_period_ms(uint32_t subpage_period_ms) noexcept
+    {
+        _subpage_period_ms = subpage_period_ms;
+        _has_ready_time = false;
+    }
+
+    void set_bus_reset_function(BusResetFunction bus_reset_func) { _bus_reset_func = bus_reset_func; }
+
+    AcquisitionState state() const noexcept { return _state; }
+    int last_error() const noexcept { return _last_error; }
+    uint32_t subpage_period_ms() const noexcept { return _subpage_period_ms; }
+    unsigned long next_poll_time() const noexcept { return _next_poll_time; }
+    // when the data ready flag of the latest sub-page was seen
+    unsigned long last_ready_time() const noexcept { return _last_ready_time; }
+    const AcquisitionStats &stats() const noexcept { return _stats; }
+
+private:
+    // The nominal periods from convert_refresh_rate_to_ms are rounded down and the sensor clock drifts a bit,
+    // so the first poll is scheduled one poll interval early instead of accumulating lag.
+    unsigned long _predicted_ready_time() const noexcept
+    {
+        auto lead_time = _subpage_period_ms > _poll_interval_ms ? _poll_interval_ms : 0;
+        return _last_ready_time + _subpage_period_ms - lead_time;
+    }
+
+    static bool _is_time_reached(unsigned long now, unsigned long time) noexcept
+    {
+        return static_cast<long>(now - time) >= 0; // wrap-around safe
+    }
+
+    uint32_t _retry_budget_ms() const noexcept
+    {
+        return std::max(_subpage_period_ms / MLX_RETRY_BUDGET_DIVISOR, _poll_interval_ms);
+    }
+
+    void _fail(int error)
+    {
+        _last_error = error;
+        _stats.errors++;
+        _state = AcquisitionState::IDLE;
+        // the lost sub-page still took its slot, polling for the next one starts at the following ready time
+        // instead of right away, so a dead bus costs one retry budget per sub-page period and not more
+        if (_has_ready_time) {
+            auto missed_periods = (_timestamp_func() - _last_ready_time) / _subpage_period_ms;
+            _last_ready_time += missed_periods * _subpage_period_ms;
+        }
+    }
+
+    // Failed register access: schedules a retry of the current step while the budget lasts, fails the sub-page
+    // otherwise. A READING step restarts with the status clear and the RAM read.
+    void _handle_bus_error(int error)
+    {
+        auto now = _timestamp_func();
+        _last_error = error;
+        _stats.bus_errors++;
+        _ram_transfer_pending = false;
+        if (!_is_retrying) {
+            _is_retrying = true;
+            _retry_deadline = now + _retry_budget_ms();
+        }
+
+        _consecutive_bus_errors++;
+        if (_consecutive_bus_errors >= MLX_BUS_RESET_AFTER_ERRORS && _bus_reset_func != nullptr) {
+            _consecutive_bus_errors = 0;
+            if (_bus_reset_func()) {
+                _stats.bus_resets++;
+            }
+        }
+
+        if (_is_time_reached(now, _retry_deadline)) {
+            _fail(error);
+            return;
+        }
+        _next_poll_time = now + _poll_interval_ms;
+    }
+
+    void _poll_status()
+    {
+        auto now = _timestamp_func();
+        if (!_is_time_reached(now, _next_poll_time)) {
+            return;
+        }
+
+        uint16_t status_register = 0;
+        _stats.status_polls_last_subpage++;
+        _stats.status_polls_total++;
+        int error = _read_func(MLX_STATUS_REGISTER, 1, &status_register);
+        if (error != 0) {
+            _handle_bus_error(error);
+            return;
+        }
+        _consecutive_bus_errors = 0;
+        if ((status_register & MLX_STATUS_DATA_READY) == 0) {
+            _next_poll_time = now + _poll_interval_ms;
+            return;
+        }
+
+        _last_ready_time = now;
+        _has_ready_time = true;
+        _read_attempt = 0;
+        _ram_transfer_pending = false;
+        _state = AcquisitionState::READING;
+    }
+
+    // Starts the RAM read of the current attempt, returns the error code or 0
+    int _start_ram_read()
+    {
+        // only a failed transfer counts, the bits of the status register change on their own so the echo
+        // does not have to match (Adafruit_MLX90640 verifies the overwrite enable bit with the next status read)
+        if (_write_func(MLX_STATUS_REGISTER, MLX_STATUS_CLEAR_DATA_READY) == -1) {
+            return -1;
+        }
+        if (_async_transport == nullptr) {
+            return _read_func(MLX_RAM_START_ADDRESS, MLX_RAM_WORDS, _target->data());
+        }
+        if (!_async_transport->submit_read(MLX_RAM_START_ADDRESS, MLX_RAM_WORDS, _target->data())) {
+            return -1;
+        }
+        _ram_transfer_pending = true;
+        return 0;
+    }
+
+    void _read_subpage()
+    {
+        uint16_t status_register = MLX_STATUS_DATA_READY;
+
+        // re-read while the sensor overwrote the RAM during the transfer (same scheme as MLX90640_GetFrameData)
+        while ((status_register & MLX_STATUS_DATA_READY) != 0 && _read_attempt < MLX_MAX_SUBPAGE_READ_ATTEMPTS) {
+            if (!_ram_transfer_pending) {
+                int error = _start_ram_read();
+                if (error != 0) {
+                    _handle_bus_error(error);
+                    return;
+                }
+            }
+            if (_ram_transfer_pending) {
+                auto transfer_state = _async_transport->poll();
+                if (transfer_state == TransferState::BUSY) {
+                    _stats.polls_during_transfer++;
+                    return; // resumed by the next poll()
+                }
+                _ram_transfer_pending = false;
+                if (transfer_state == TransferState::FAILED) {
+                    _handle_bus_error(_async_transport->last_error());
+                    return;
+                }
+            }
+
+            int error = _read_func(MLX_STATUS_REGISTER, 1, &status_register);
+            if (error != 0) {
+                _handle_bus_error(error);
+                return;
+            }
+            if (_read_attempt > 0) {
+                _stats.read_retries++;
+            }
+            _read_attempt++;
+        }
+        if ((status_register & MLX_STATUS_DATA_READY) != 0) {
+            _fail(MLX_ERROR_TOO_MANY_RETRIES);
+            return;
+        }
+
+        uint16_t control_register = 0;
+        int error = _read_func(MLX_CONTROL_REGISTER_1, 1, &control_register);
+        if (error != 0) {
+            _handle_bus_error(error);
+            return;
+        }
+        (*_target)[MLX_CONTROL_REGISTER_WORD] = control_register;
+        (*_target)[MLX_SUBPAGE_NUMBER_WORD] = status_register & MLX_STATUS_SUBPAGE_MASK;
+
+        if (_is_retrying) {
+            _stats.recovered_errors++;
+            _is_retrying = false;
+        }
+        _consecutive_bus_errors = 0;
+        _last_error = 0;
+        _stats.subpages_read++;
+        _state = AcquisitionState::READY;
+    }
+
+    RegisterReadFunction _read_func = nullptr;
+    RegisterWriteFunction _write_func = nullptr;
+    TimestampFunction _timestamp_func = nullptr;
+    uint32_t _subpage_period_ms;
+    uint32_t _poll_interval_ms;
+    AsyncMlxTransport *_async_transport = nullptr;
+    BusResetFunction _bus_reset_func = nullptr;
+
+    AcquisitionState _state = AcquisitionState::IDLE;
+    int _last_error = 0;
+    bool _has_ready_time = false;
+    unsigned long _last_ready_time = 0;
+    unsigned long _next_poll_time = 0;
+    uint8_t _read_attempt = 0;
+    bool _ram_transfer_pending = false;
+    bool _is_retrying = false;
+    unsigned long _retry_deadline = 0;
+    uint32_t _consecutive_bus_errors = 0;
+    AcquisitionStats _stats{};
+    MlxSubpageFrame _frame{};
+    MlxSubpageFrame *_target = &_frame;
+};
+
+} // namespace thermocam
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <Adafruit_MLX90640.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdint.h>
+
+#include "config.h"
+#include "mlx_acquisition.h"
+#include "mlx_pixel_layout.h"
+#include "types/common_types.h"
+#include "types/mlx_types.h"
+
+namespace thermocam {
+
+// broken and outlier pixels ExtractDeviatingPixels takes from the EEPROM, five each
+constexpr size_t MLX_MAX_BAD_PIXEL_COUNT = 10;
+// pixels found at runtime (mlx_pixel_faults.h) corrected on top of those, more are left as they are
+constexpr size_t MLX_MAX_DETECTED_BAD_PIXEL_COUNT = 16;
+
+// Branch-free median of four like GetMedian of the Melexis driver: mean of the two middle values, which are the
+// larger of the two pair minima and the smaller of the two pair maxima
+[[nodiscard]] inline float median_of_four(float a, float b, float c, float d) noexcept
+{
+    auto low = std::max(std::min(a, b), std::min(c, d));
+    auto high = std::min(std::max(a, b), std::max(c, d));
+    return (low + high) * 0.5f;
+}
+
+// MLX90640_BadPixelsCorrection without the per-frame work: the case analysis per pixel (border, neighbours that are
+// bad themselves) is resolved into a neighbour list per pixel and readout mode after begin() and whenever
+// set_detected_pixels() changes the list, what is left per sub-page is a few loads and a median / mean per bad
+// pixel. The neighbours of a bad pixel are in its own sub-page (diagonal in chess mode, same row in interleaved
+// mode), so each sub-page is corrected right after its calculation. Same results as the reference, bit for bit.
+class MlxBadPixelCorrection
+{
+public:
+    MlxBadPixelCorrection() = default;
+    explicit MlxBadPixelCorrection(const paramsMLX90640 &params) { compile(params); }
+
+    // broken pixels first, then outliers, the order of the two reference calls
+    void compile(const paramsMLX90640 &params)
+    {
+        _eeprom_pixel_count = 0;
+        for (const auto *list : {params.brokenPixels, params.outlierPixels}) {
+            for (size_t i = 0; i < 5 && list[i] < MLX_PIXEL_COUNT; i++) {
+                _pixels[_eeprom_pixel_count++] = list[i];
+            }
+        }
+        set_detected_pixels({});
+    }
+
+    // pixels found faulty at runtime, corrected after the EEPROM ones like those. Pixels beyond
+    // MLX_MAX_DETECTED_BAD_PIXEL_COUNT are counted in ignored_pixel_count().
+    void set_detected_pixels(const MlxPixelBitmap &detected)
+    {
+        _bad_pixels.clear();
+        for (size_t i = 0; i < _eeprom_pixel_count; i++) {
+            _bad_pixels.set(_pixels[i]);
+        }
+        auto pixel_count = _eeprom_pixel_count;
+        _ignored_pixel_count = 0;
+        for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+            if (!detected.test(pixel_index) || _bad_pixels.test(pixel_index)) {
+                continue;
+            }
+            if (pixel_count == _pixels.size()) {
+                _ignored_pixel_count++;
+                continue;
+            }
+            _pixels[pixel_count++] = static_cast<uint16_t>(pixel_index);
+            _bad_pixels.set(pixel_index);
+        }
+
+        // after the bitmap is complete, interleaved mode checks it for the neighbours
+        for (auto readout_mode : {Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED,
+                                  Mlx90640PixelReadoutMode::MLX90640_CHESS}) {
+            auto &corrections = _corrections[_mode_index(readout_mode)];
+            for (size_t i = 0; i < pixel_count; i++) {
+                corrections[i] = _make_correction(_pixels[i], readout_mode);
+            }
+        }
+        _correction_count = pixel_count;
+    }
+
+    // replaces the bad pixels of the sub-page in temperatures (or a relative image) by their neighbours, the new
+    // values also go to stats_sink(pixel_index, temperature) like in the calibration kernels
+    template <typename StatsSink = NoStatsSink>
+    void correct_subpage(uint8_t subpage_number,
+                         Mlx90640PixelReadoutMode readout_mode,
+                         float *temperatures,
+                         StatsSink stats_sink = {}) const
+    {
+        for (size_t i = 0; i < _correction_count; i++) {
+            const auto &correction = _corrections[_mode_index(readout_mode)][i];
+            if (correction.subpage_number != (subpage_number & 1)) {
+                continue;
+            }
+            const auto *n = correction.neighbours.data();
+            float value;
+            switch (correction.kind) {
+            case Kind::COPY:
+                value = temperatures[n[0]];
+                break;
+            case Kind::MEAN:
+                value = (temperatures[n[0]] + temperatures[n[1]]) * 0.5f;
+                break;
+            case Kind::MEDIAN:
+                value = median_of_four(temperatures[n[0]], temperatures[n[1]], temperatures[n[2]], temperatures[n[3]]);
+                break;
+            default: { // GRADIENT
+                // continues the flatter of the two gradients next to the pixel, n = {-1, -2, +1, +2}
+                auto left = temperatures[n[0]] - temperatures[n[1]];
+                auto right = temperatures[n[2]] - temperatures[n[3]];
+                value = std::fabs(right) > std::fabs(left) ? temperatures[n[0]] + left : temperatures[n[2]] + right;
+                break;
+            }
+            }
+            temperatures[correction.pixel_index] = value;
+            stats_sink(correction.pixel_index, value);
+        }
+    }
+
+    // sub-page number and readout mode from the frame words, for the frame path of the firmware
+    template <typename StatsSink = NoStatsSink>
+    void correct_subpage(const uint16_t *subpage_frame, float *temperatures, StatsSink stats_sink = {}) const
+    {
+        auto readout_mode = (subpage_frame[MLX_CONTROL_REGISTER_WORD] & MLX_CONTROL_CHESS_MODE) != 0
+                                    ? Mlx90640PixelReadoutMode::MLX90640_CHESS
+                                    : Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED;
+        correct_subpage(subpage_frame[MLX_SUBPAGE_NUMBER_WORD] & MLX_STATUS_SUBPAGE_MASK, readout_mode, temperatures,
+                        stats_sink);
+    }
+
+    bool is_bad(size_t pixel_index) const noexcept { return _bad_pixels.test(pixel_index); }
+    const MlxPixelBitmap &bad_pixels() const noexcept { return _bad_pixels; }
+    size_t bad_pixel_count() const noexcept { return _correction_count; }
+    size_t detected_pixel_count() const noexcept { return _correction_count - _eeprom_pixel_count; }
+    size_t ignored_pixel_count() const noexcept { return _ignored_pixel_count; }
+
+private:
+    enum class Kind : uint8_t
+    {
+        COPY,
+        MEAN,
+        MEDIAN,
+        GRADIENT
+    };
+
+    struct Correction
+    {
+        uint16_t pixel_index;
+        uint8_t subpage_number;
+        Kind kind;
+        std::array<uint16_t, 4> neighbours;
+    };
+
+    static size_t _mode_index(Mlx90640PixelReadoutMode readout_mode) noexcept
+    {
+        return readout_mode == Mlx90640PixelReadoutMode::MLX90640_CHESS;
+    }
+
+    // case analysis of MLX90640_BadPixelsCorrection, mode 1 is chess
+    Correction _make_correction(uint16_t pixel, Mlx90640PixelReadoutMode readout_mode) const
+    {
+        Correction correction{pixel, static_cast<uint8_t>(is_pixel_in_subpage(pixel, 1, readout_mode)), Kind::COPY,
+                              {}};
+        auto set = [&correction](Kind kind, std::array<int, 4> offsets) {
+            correction.kind = kind;
+            for (size_t i = 0; i < offsets.size(); i++) {
+                correction.neighbours[i] = static_cast<uint16_t>(correction.pixel_index + offsets[i]);
+            }
+        };
+        auto line = pixel / MLX_SENSOR_WIDTH;
+        auto column = pixel % MLX_SENSOR_WIDTH;
+        constexpr auto LAST_LINE = MLX_SENSOR_HEIGHT - 1;
+        constexpr auto LAST_COLUMN = MLX_SENSOR_WIDTH - 1;
+        if (readout_mode == Mlx90640PixelReadoutMode::MLX90640_CHESS) {
+            // diagonal neighbours, the corners copy the one inside
+            if (line == 0 || line == LAST_LINE) {
+                int inward = line == 0 ? 1 : -1;
+                if (column == 0) {
+                    set(Kind::COPY, {inward * MLX_SENSOR_WIDTH + 1});
+                } else if (column == LAST_COLUMN) {
+                    set(Kind::COPY, {inward * MLX_SENSOR_WIDTH - 1});
+                } else {
+                    set(Kind::MEAN, {inward * MLX_SENSOR_WIDTH - 1, inward * MLX_SENSOR_WIDTH + 1});
+                }
+            } else if (column == 0) {
+                set(Kind::MEAN, {-MLX_SENSOR_WIDTH + 1, MLX_SENSOR_WIDTH + 1});
+            } else if (column == LAST_COLUMN) {
+                set(Kind::MEAN, {-MLX_SENSOR_WIDTH - 1, MLX_SENSOR_WIDTH - 1});
+            } else {
+                set(Kind::MEDIAN, {-MLX_SENSOR_WIDTH - 1, -MLX_SENSOR_WIDTH + 1, MLX_SENSOR_WIDTH - 1,
+                                   MLX_SENSOR_WIDTH + 1});
+            }
+        } else if (column == 0) {
+            set(Kind::COPY, {1});
+        } else if (column == LAST_COLUMN) {
+            set(Kind::COPY, {-1});
+        } else if (column == 1 || column == LAST_COLUMN - 1 || _bad_pixels.test(pixel - 2) ||
+                   _bad_pixels.test(pixel + 2)) {
+            set(Kind::MEAN, {-1, 1});
+        } else {
+            set(Kind::GRADIENT, {-1, -2, 1, 2});
+        }
+        return correction;
+    }
+
+    static constexpr size_t MAX_CORRECTION_COUNT = MLX_MAX_BAD_PIXEL_COUNT + MLX_MAX_DETECTED_BAD_PIXEL_COUNT;
+
+    MlxPixelBitmap _bad_pixels;
+    // EEPROM pixels, then the detected ones
+    std::array<uint16_t, MAX_CORRECTION_COUNT> _pixels{};
+    size_t _eeprom_pixel_count = 0;
+    size_t _ignored_pixel_count = 0;
+    std::array<std::array<Correction, MAX_CORRECTION_COUNT>, 2> _corrections{};
+    size_t _correction_count = 0;
+};
+
+} // namespace thermocam
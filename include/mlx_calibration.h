@@ -0,0 +1,470 @@
+#pragma once
+
+#include <Adafruit_MLX90640.h>
+#include <array>
+#include <cmath>
+#include <stdint.h>
+
+#include "fourth_root.h"
+#include "mlx_acquisition.h"
+#include "mlx_pixel_layout.h"
+#include "types/common_types.h"
+#include "types/mlx_types.h"
+
+namespace thermocam {
+
+constexpr float KELVIN_OFFSET = 273.15f;
+// emissivity and reflected temperature (Ta - OPENAIR_TA_SHIFT) of Adafruit_MLX90640::calculateSubpage
+constexpr float DEFAULT_EMISSIVITY = 0.95f;
+// Ta / Vdd drift up to which the cached offset compensation is reused. With the reference sensor about 0.2 C per C
+// of Ta and 0.012 C per mV of Vdd, so at most 0.05 C off, below the noise of the sensor.
+constexpr float OFFSET_CACHE_TA_EPSILON = 0.1f;
+constexpr float OFFSET_CACHE_VDD_EPSILON = 0.002f;
+// error bound of a single-pass pixel against the two passes of MLX90640_CalculateTo, larger drifts fall back
+constexpr float SINGLE_PASS_MAX_ERROR = 0.01f;
+
+// Everything MLX90640_CalculateTo derives from the auxiliary data of a sub-page, calculated once per sub-page
+struct MlxSubpageContext
+{
+    uint8_t subpage_number;
+    Mlx90640PixelReadoutMode readout_mode;
+    // read out in the mode the sensor was calibrated in, no interleave / chess correction needed
+    bool is_calibration_mode;
+    float vdd;
+    float ta;
+    float gain;
+    // compensation pixel of this sub-page, gain and offset compensated
+    float ir_cp;
+    // Tr^4 - (Tr^4 - Ta^4) / emissivity in K^4
+    float ta_tr;
+    float delta_ta;  // Ta - 25
+    float delta_vdd; // Vdd - 3.3
+    float alpha_ta;  // sensitivity correction 1 + KsTa * (Ta - 25)
+};
+
+// Per-sensor part of the calibration: everything needed to prepare the context of a sub-page from its auxiliary
+// data, plus the constants of the extended temperature ranges. Shared by the To engines.
+class MlxSensorCalibration
+{
+public:
+    void compile(const paramsMLX90640 &params, float emissivity = DEFAULT_EMISSIVITY)
+    {
+        _emissivity = emissivity;
+        for (uint8_t resolution = 0; resolution < _vdd_resolution_correction.size(); resolution++) {
+            _vdd_resolution_correction[resolution] = static_cast<float>(1 << params.resolutionEE) / (1 << resolution);
+        }
+        _k_vdd = params.kVdd;
+        _vdd_25 = params.vdd25;
+        _kv_ptat = params.KvPTAT;
+        _kt_ptat = params.KtPTAT;
+        _v_ptat_25 = params.vPTAT25;
+        _alpha_ptat = params.alphaPTAT;
+        _gain_ee = params.gainEE;
+        _tgc = params.tgc;
+        _cp_kta = params.cpKta;
+        _cp_kv = params.cpKv;
+        _cp_offset = {static_cast<float>(params.cpOffset[0]), static_cast<float>(params.cpOffset[1])};
+        _il_chess_cp_correction = params.ilChessC[0];
+        _calibration_mode_ee = params.calibrationModeEE;
+        _ks_ta = params.KsTa;
+
+        for (size_t range = 0; range < _ks_to.size(); range++) {
+            _ks_to[range] = params.ksTo[range];
+            _ct[range] = params.ct[range];
+        }
+        _alpha_corr_range = {1.0f / (1.0f + params.ksTo[0] * 40), 1.0f, 1.0f + params.ksTo[1] * params.ct[2], 0.0f};
+        _alpha_corr_range[3] = _alpha_corr_range[2] * (1.0f + params.ksTo[2] * (params.ct[3] - params.ct[2]));
+        _ks_to_zero_celsius = 1.0f - params.ksTo[1] * KELVIN_OFFSET;
+    }
+
+    // Vdd, Ta and the compensation pixel of a raw sub-page in Melexis frame layout
+    MlxSubpageContext prepare_subpage(const uint16_t *subpage_frame) const
+    {
+        MlxSubpageContext context{};
+        auto control_register = subpage_frame[MLX_CONTROL_REGISTER_WORD];
+        context.subpage_number = subpage_frame[MLX_SUBPAGE_NUMBER_WORD] & MLX_STATUS_SUBPAGE_MASK;
+        context.readout_mode = (control_register & MLX_CONTROL_CHESS_MODE) != 0
+                                       ? Mlx90640PixelReadoutMode::MLX90640_CHESS
+                                       : Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED;
+        // same encoding as calibrationModeEE: 0x80 for chess mode
+        context.is_calibration_mode = ((control_register & MLX_CONTROL_CHESS_MODE) >> 5) == _calibration_mode_ee;
+
+        auto resolution = (control_register >> MLX_CONTROL_RESOLUTION_SHIFT) & MLX_CONTROL_RESOLUTION_MASK;
+        float vdd_raw = signed_word(subpage_frame[MLX_VDD_RAM_WORD]);
+        context.vdd = (_vdd_resolution_correction[resolution] * vdd_raw - _vdd_25) / _k_vdd + 3.3f;
+        context.delta_vdd = context.vdd - 3.3f;
+
+        float ptat = signed_word(subpage_frame[MLX_PTAT_RAM_WORD]);
+        float ptat_art = signed_word(subpage_frame[MLX_VBE_RAM_WORD]);
+        ptat_art = ptat / (ptat * _alpha_ptat + ptat_art) * static_cast<float>(1 << 18);
+        context.ta = (ptat_art / (1.0f + _kv_ptat * context.delta_vdd) - _v_ptat_25) / _kt_ptat + 25.0f;
+        context.delta_ta = context.ta - 25.0f;
+        context.alpha_ta = 1.0f + _ks_ta * context.delta_ta;
+
+        auto tr = context.ta - OPENAIR_TA_SHIFT;
+        auto ta4 = _fourth_power(context.ta + KELVIN_OFFSET);
+        auto tr4 = _fourth_power(tr + KELVIN_OFFSET);
+        context.ta_tr = tr4 - (tr4 - ta4) / _emissivity;
+
+        context.gain = _gain_ee / signed_word(subpage_frame[MLX_GAIN_RAM_WORD]);
+        auto cp_word = context.subpage_number == 0 ? MLX_CP_SUBPAGE_0_RAM_WORD : MLX_CP_SUBPAGE_1_RAM_WORD;
+        auto cp_offset = _cp_offset[context.subpage_number];
+        if (context.subpage_number == 1 && !context.is_calibration_mode) {
+            cp_offset += _il_chess_cp_correction;
+        }
+        context.ir_cp = signed_word(subpage_frame[cp_word]) * context.gain -
+                        cp_offset * (1.0f + _cp_kta * context.delta_ta) * (1.0f + _cp_kv * context.delta_vdd);
+        return context;
+    }
+
+    static float signed_word(uint16_t word) noexcept { return static_cast<int16_t>(word); }
+
+    float emissivity() const noexcept { return _emissivity; }
+    float tgc() const noexcept { return _tgc; }
+    // ksTo, ct and alpha correction of the four temperature ranges
+    const std::array<float, 4> &ks_to() const noexcept { return _ks_to; }
+    const std::array<float, 4> &ct() const noexcept { return _ct; }
+    const std::array<float, 4> &alpha_corr_range() const noexcept { return _alpha_corr_range; }
+    // 1 - ksTo[1] * 273.15
+    float ks_to_zero_celsius() const noexcept { return _ks_to_zero_celsius; }
+
+    // extended temperature range of a temperature in degree Celsius
+    size_t range(float temperature) const noexcept
+    {
+        return temperature < _ct[1] ? 0 : temperature < _ct[2] ? 1 : temperature < _ct[3] ? 2 : 3;
+    }
+
+    // alpha correction of the extended temperature range of the estimate, relative to alpha
+    float range_factor(float estimate) const noexcept
+    {
+        auto estimate_range = range(estimate);
+        return _alpha_corr_range[estimate_range] * (1.0f + _ks_to[estimate_range] * (estimate - _ct[estimate_range]));
+    }
+
+    // relative image (IR / (alpha * emissivity) in K^4) of an object at the temperature, e.g. for a color scale
+    float temperature_to_image(float temperature, const MlxSubpageContext &context) const noexcept
+    {
+        return (_fourth_power(temperature + KELVIN_OFFSET) - context.ta_tr) * range_factor(temperature);
+    }
+
+private:
+    static float _fourth_power(float value) noexcept
+    {
+        auto square = value * value;
+        return square * square;
+    }
+
+    float _emissivity = DEFAULT_EMISSIVITY;
+    std::array<float, 4> _vdd_resolution_correction{};
+    float _k_vdd = 1.0f;
+    float _vdd_25 = 0.0f;
+    float _kv_ptat = 0.0f;
+    float _kt_ptat = 1.0f;
+    float _v_ptat_25 = 0.0f;
+    float _alpha_ptat = 0.0f;
+    float _gain_ee = 0.0f;
+    float _tgc = 0.0f;
+    float _cp_kta = 0.0f;
+    float _cp_kv = 0.0f;
+    std::array<float, 2> _cp_offset{};
+    float _il_chess_cp_correction = 0.0f;
+    uint8_t _calibration_mode_ee = 0;
+    float _ks_ta = 0.0f;
+    std::array<float, 4> _ks_to{};
+    std::array<float, 4> _ct{};
+    std::array<float, 4> _alpha_corr_range{};
+    float _ks_to_zero_celsius = 1.0f;
+};
+
+struct OffsetCacheStats
+{
+    uint32_t hits;
+    uint32_t rebuilds;
+};
+
+// Ta / Vdd the per-pixel offset compensation offset * (1 + kta * (Ta - 25)) * (1 + kv * (Vdd - 3.3)) was calculated
+// for. Both drift slowly, so the compensation of a sub-page is rebuilt when they moved further than the epsilons and
+// reused otherwise. One key per sub-page, Vdd differs between the two sub-pages by a few mV.
+class OffsetCompensationCache
+{
+public:
+    // epsilons of 0 rebuild on every change
+    explicit OffsetCompensationCache(float ta_epsilon = OFFSET_CACHE_TA_EPSILON,
+                                     float vdd_epsilon = OFFSET_CACHE_VDD_EPSILON)
+        : _ta_epsilon(ta_epsilon), _vdd_epsilon(vdd_epsilon)
+    {
+    }
+
+    // true if the compensation of the sub-page has to be rebuilt for the context, which becomes the new key then
+    bool needs_rebuild(const MlxSubpageContext &context)
+    {
+        auto &key = _keys[context.subpage_number & 1];
+        if (key.is_valid && key.readout_mode == context.readout_mode &&
+            std::fabs(context.ta - key.ta) <= _ta_epsilon && std::fabs(context.vdd - key.vdd) <= _vdd_epsilon) {
+            _stats.hits++;
+            return false;
+        }
+        key = {true, context.readout_mode, context.ta, context.vdd};
+        _stats.rebuilds++;
+        return true;
+    }
+
+    void invalidate()
+    {
+        for (auto &key : _keys) {
+            key.is_valid = false;
+        }
+    }
+
+    const OffsetCacheStats &stats() const noexcept { return _stats; }
+
+private:
+    struct Key
+    {
+        bool is_valid;
+        Mlx90640PixelReadoutMode readout_mode;
+        float ta;
+        float vdd;
+    };
+
+    float _ta_epsilon;
+    float _vdd_epsilon;
+    std::array<Key, 2> _keys{};
+    OffsetCacheStats _stats{};
+};
+
+// Pixels of the latest sub-page and how many of them took the two passes of MLX90640_CalculateTo
+struct SinglePassStats
+{
+    uint32_t pixels;
+    uint32_t fallbacks;
+};
+
+// Interleave / chess pattern correction of MLX90640_CalculateTo for a pixel read out in the other mode than the one
+// the sensor was calibrated in
+inline float il_chess_correction(const paramsMLX90640 &params, size_t pixel_index)
+{
+    return params.ilChessC[2] * (2 * interleave_pattern(pixel_index) - 1) -
+           params.ilChessC[1] * conversion_pattern(pixel_index);
+}
+
+// Calibration parameters compiled into per-pixel float coefficients, so the To kernel does not scale kta/kv,
+// rebuild alpha or recalculate Vdd and Ta per pixel like MLX90640_CalculateTo. The fourth roots come from
+// fast_fourth_root(), without soft-float sqrt on cores without FPU, the offset compensation from an
+// OffsetCompensationCache. Built once after the parameters were extracted (or loaded from the cache), about 24 kB
+// with the anchors of the single-pass mode.
+class MlxCalibration
+{
+public:
+    MlxCalibration() = default;
+    explicit MlxCalibration(const paramsMLX90640 &params, float emissivity = DEFAULT_EMISSIVITY)
+    {
+        compile(params, emissivity);
+    }
+
+    void compile(const paramsMLX90640 &params, float emissivity = DEFAULT_EMISSIVITY)
+    {
+        _sensor.compile(params, emissivity);
+        auto kta_scale = static_cast<float>(1 << params.ktaScale);
+        auto kv_scale = static_cast<float>(1 << params.kvScale);
+        double alpha_scale = SCALEALPHA * (1 << params.alphaScale);
+        for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+            _offset[pixel_index] = params.offset[pixel_index];
+            _kta[pixel_index] = params.kta[pixel_index] / kta_scale;
+            _kv[pixel_index] = params.kv[pixel_index] / kv_scale;
+            _alpha[pixel_index] = static_cast<float>(alpha_scale / params.alpha[pixel_index]);
+            _il_chess_correction[pixel_index] = il_chess_correction(params, pixel_index);
+        }
+        _offset_cache.invalidate();
+        _anchor_estimate.fill(NAN);
+        _is_compiled = true;
+    }
+
+    MlxSubpageContext prepare_subpage(const uint16_t *subpage_frame) const
+    {
+        return _sensor.prepare_subpage(subpage_frame);
+    }
+
+    // To kernel: object temperatures in degree Celsius of the pixels of the sub-page, the others are not written.
+    // Each value also goes to stats_sink(pixel_index, temperature), e.g. SubpageStats::add(), while it is at hand.
+    template <typename StatsSink = NoStatsSink>
+    void calculate_to(const uint16_t *subpage_frame,
+                      const MlxSubpageContext &context,
+                      float *temperatures,
+                      StatsSink stats_sink = {})
+    {
+        const auto &pixel_indices = subpage_pixel_indices(context.subpage_number, context.readout_mode);
+        calculate_pixels_to(subpage_frame, context, pixel_indices.data(), pixel_indices.size(), temperatures,
+                            stats_sink);
+    }
+
+    // To kernel for a selection of pixels of the sub-page, e.g. the regions of interest of an MlxRoiMonitor
+    template <typename StatsSink = NoStatsSink>
+    void calculate_pixels_to(const uint16_t *subpage_frame,
+                             const MlxSubpageContext &context,
+                             const uint16_t *pixel_indices,
+                             size_t pixel_count,
+                             float *temperatures,
+                             StatsSink stats_sink = {})
+    {
+        _single_pass_stats = {static_cast<uint32_t>(pixel_count), 0};
+        _update_compensated_offset(context);
+        for (size_t i = 0; i < pixel_count; i++) {
+            auto pixel_index = pixel_indices[i];
+            auto image = _image(pixel_index, subpage_frame[pixel_index], context);
+            auto temperature = _calculate_pixel_to(pixel_index, image, context);
+            temperatures[pixel_index] = temperature;
+            stats_sink(pixel_index, temperature);
+        }
+    }
+
+    // Relative image like MLX90640_GetImage, without any fourth root: IR / (alpha * emissivity) in K^4, about
+    // (To + 273.15)^4 - Ta,r^4. Rises with To for every pixel alike, image_to_temperature() converts single values.
+    void calculate_image(const uint16_t *subpage_frame, const MlxSubpageContext &context, float *image)
+    {
+        _update_compensated_offset(context);
+        for (auto pixel_index : subpage_pixel_indices(context.subpage_number, context.readout_mode)) {
+            image[pixel_index] = _image(pixel_index, subpage_frame[pixel_index], context);
+        }
+    }
+
+    // Drop-in replacement for Adafruit_MLX90640::calculateSubpage
+    template <typename StatsSink = NoStatsSink>
+    void calculate_subpage(const uint16_t *subpage_frame, float *temperatures, StatsSink stats_sink = {})
+    {
+        _set_last_context(prepare_subpage(subpage_frame));
+        calculate_to(subpage_frame, _last_context, temperatures, stats_sink);
+    }
+
+    // Relative image of a sub-page, the contexts are kept for image_to_temperature()
+    void calculate_subpage_image(const uint16_t *subpage_frame, float *image)
+    {
+        _set_last_context(prepare_subpage(subpage_frame));
+        calculate_image(subpage_frame, _last_context, image);
+    }
+
+    // To of a pixel of the latest calculate_subpage_image() of its sub-page, with the two passes of
+    // MLX90640_CalculateTo
+    float image_to_temperature(size_t pixel_index, float image) const
+    {
+        float estimate;
+        return _two_pass_to(image, _subpage_context(pixel_index), estimate);
+    }
+
+    // image of an object at the temperature with the latest context, inverse of image_to_temperature()
+    float temperature_to_image(float temperature) const
+    {
+        return _sensor.temperature_to_image(temperature, _last_context);
+    }
+
+    void set_offset_cache_epsilon(float ta_epsilon, float vdd_epsilon)
+    {
+        _offset_cache = OffsetCompensationCache(ta_epsilon, vdd_epsilon);
+    }
+
+    // Single pass: the range and the first estimate of a pixel are predicted from its latest two-pass evaluation
+    // (its anchor), so one fourth root per pixel does instead of three. Falls back to the two passes when the
+    // estimate moves into another range or the drift from the anchor could cost more than SINGLE_PASS_MAX_ERROR.
+    void set_single_pass(bool is_single_pass)
+    {
+        _is_single_pass = is_single_pass;
+        _anchor_estimate.fill(NAN);
+    }
+
+    bool is_compiled() const noexcept { return _is_compiled; }
+    // context of the latest calculate_subpage(), e.g. for Ta
+    const MlxSubpageContext &last_context() const noexcept { return _last_context; }
+    const OffsetCacheStats &offset_cache_stats() const noexcept { return _offset_cache.stats(); }
+    const SinglePassStats &single_pass_stats() const noexcept { return _single_pass_stats; }
+
+private:
+    void _set_last_context(const MlxSubpageContext &context)
+    {
+        _last_context = context;
+        _subpage_contexts[context.subpage_number & 1] = context;
+    }
+
+    const MlxSubpageContext &_subpage_context(size_t pixel_index) const
+    {
+        return _subpage_contexts[is_pixel_in_subpage(pixel_index, 1, _last_context.readout_mode) ? 1 : 0];
+    }
+
+    void _update_compensated_offset(const MlxSubpageContext &context)
+    {
+        if (!_offset_cache.needs_rebuild(context)) {
+            return;
+        }
+        for (auto pixel_index : subpage_pixel_indices(context.subpage_number, context.readout_mode)) {
+            _compensated_offset[pixel_index] = _offset[pixel_index] * (1.0f + _kta[pixel_index] * context.delta_ta) *
+                                               (1.0f + _kv[pixel_index] * context.delta_vdd);
+        }
+    }
+
+    // IR / (alpha * emissivity) in K^4
+    float _image(size_t pixel_index, uint16_t raw, const MlxSubpageContext &context) const
+    {
+        float ir = MlxSensorCalibration::signed_word(raw) * context.gain;
+        ir -= _compensated_offset[pixel_index];
+        if (!context.is_calibration_mode) {
+            ir += _il_chess_correction[pixel_index];
+        }
+        ir -= _sensor.tgc() * context.ir_cp;
+        return ir / (_sensor.emissivity() * _alpha[pixel_index] * context.alpha_ta);
+    }
+
+    // MLX90640_CalculateTo on the image: the first estimate divides by 1 - ksTo1 * 273.15 + ksTo1 * T0 with
+    // T0 = (image + Ta,r)^(1/4) and selects the range of the second pass
+    float _two_pass_to(float image, const MlxSubpageContext &context, float &estimate) const
+    {
+        auto first_root = fast_fourth_root(image + context.ta_tr);
+        estimate = fast_fourth_root(image / (_sensor.ks_to_zero_celsius() + _sensor.ks_to()[1] * first_root) +
+                                    context.ta_tr) -
+                   KELVIN_OFFSET;
+        return fast_fourth_root(image / _sensor.range_factor(estimate) + context.ta_tr) - KELVIN_OFFSET;
+    }
+
+    float _calculate_pixel_to(size_t pixel_index, float image, const MlxSubpageContext &context)
+    {
+        auto estimate = _anchor_estimate[pixel_index];
+        if (_is_single_pass && !std::isnan(estimate)) {
+            auto signal = image / _sensor.range_factor(estimate);
+            auto to = fast_fourth_root(signal + context.ta_tr) - KELVIN_OFFSET;
+            // the first estimate follows the result, the result moves by ksTo * signal / (4 To^3) per Kelvin of it.
+            // Half of the error budget covers the first estimate drifting a little faster than the result.
+            auto range = _sensor.range(estimate);
+            auto drift = to - _anchor_to[pixel_index];
+            auto kelvin = to + KELVIN_OFFSET;
+            if (_sensor.range(estimate + drift) == range && std::fabs(_sensor.ks_to()[range] * signal * drift) <=
+                                                             2.0f * kelvin * kelvin * kelvin * SINGLE_PASS_MAX_ERROR) {
+                return to;
+            }
+        }
+
+        _single_pass_stats.fallbacks++;
+        auto to = _two_pass_to(image, context, estimate);
+        _anchor_estimate[pixel_index] = estimate;
+        _anchor_to[pixel_index] = to;
+        return to;
+    }
+
+    MlxSensorCalibration _sensor;
+    bool _is_compiled = false;
+    MlxSubpageContext _last_context{};
+    std::array<MlxSubpageContext, 2> _subpage_contexts{};
+    OffsetCompensationCache _offset_cache;
+    bool _is_single_pass = false;
+    SinglePassStats _single_pass_stats{};
+
+    // per pixel
+    std::array<float, MLX_PIXEL_COUNT> _offset{};
+    std::array<float, MLX_PIXEL_COUNT> _compensated_offset{};
+    std::array<float, MLX_PIXEL_COUNT> _kta{};
+    std::array<float, MLX_PIXEL_COUNT> _kv{};
+    std::array<float, MLX_PIXEL_COUNT> _alpha{};
+    std::array<float, MLX_PIXEL_COUNT> _il_chess_correction{};
+    // first estimate and To of the latest two-pass evaluation, NaN without one
+    std::array<float, MLX_PIXEL_COUNT> _anchor_estimate{};
+    std::array<float, MLX_PIXEL_COUNT> _anchor_to{};
+};
+
+} // namespace thermocam
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <stdint.h>
+#include <string.h>
+
+#include "buffer_pool.h"
+#include "config.h"
+#include "mlx_acquisition.h"
+
+namespace thermocam {
+
+// Capture format, all values little-endian:
+//   header   "MLXC", uint16 version, uint16 header size (bytes before the EEPROM), uint16 EEPROM words,
+//            uint16 sub-page words, uint32 flags (0), then the EEPROM dump
+//   records  uint16 type, uint16 word count, uint32 timestamp in ms, uint32 sequence number, then the sub-page in
+//            MLX90640_GetFrameData layout (RAM, control register 1, sub-page number)
+// The sequence number counts every sub-page offered to the writer, a gap means the writer dropped records.
+constexpr uint8_t CAPTURE_MAGIC[4] = {'M', 'L', 'X', 'C'};
+constexpr uint16_t CAPTURE_VERSION = 1;
+constexpr uint16_t CAPTURE_HEADER_PREFIX_SIZE = 16;
+constexpr size_t CAPTURE_HEADER_SIZE = CAPTURE_HEADER_PREFIX_SIZE + 2 * MLX_EEPROM_WORDS;
+constexpr uint16_t CAPTURE_RECORD_TYPE_SUBPAGE = 1;
+constexpr size_t CAPTURE_RECORD_PREFIX_SIZE = 12;
+constexpr size_t CAPTURE_RECORD_SIZE = CAPTURE_RECORD_PREFIX_SIZE + 2 * MLX_SUBPAGE_FRAME_WORDS;
+
+using CaptureHeaderBytes = std::array<uint8_t, CAPTURE_HEADER_SIZE>;
+using CaptureRecordBytes = std::array<uint8_t, CAPTURE_RECORD_SIZE>;
+
+namespace capture_encoding {
+
+inline void put_u16(uint8_t *bytes, uint16_t value)
+{
+    bytes[0] = value & 0xFF;
+    bytes[1] = value >> 8;
+}
+
+inline void put_u32(uint8_t *bytes, uint32_t value)
+{
+    put_u16(bytes, value & 0xFFFF);
+    put_u16(bytes + 2, value >> 16);
+}
+
+[[nodiscard]] inline uint16_t get_u16(const uint8_t *bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+[[nodiscard]] inline uint32_t get_u32(const uint8_t *bytes)
+{
+    return get_u16(bytes) | (static_cast<uint32_t>(get_u16(bytes + 2)) << 16);
+}
+
+inline void put_words(uint8_t *bytes, const uint16_t *words, size_t word_count)
+{
+    for (size_t i = 0; i < word_count; i++) {
+        put_u16(bytes + 2 * i, words[i]);
+    }
+}
+
+inline void get_words(const uint8_t *bytes, uint16_t *words, size_t word_count)
+{
+    for (size_t i = 0; i < word_count; i++) {
+        words[i] = get_u16(bytes + 2 * i);
+    }
+}
+
+} // namespace capture_encoding
+
+struct CaptureWriterStats
+{
+    uint32_t records_written;
+    // no free record buffer because the sink did not keep up
+    uint32_t records_dropped;
+    uint32_t bytes_written;
+};
+
+// Streaming writer of the capture format. record() only copies the sub-page into a free record buffer and can be
+// called from the acquisition path, drain() hands the encoded bytes to the sink as fast as the sink accepts them
+// and belongs into a stage that may wait (or a task of its own, record() and drain() are the two SPSC sides).
+class MlxCaptureWriter
+{
+public:
+    // writes up to size bytes, returns how many were accepted (0 if the sink is busy), must not block for long
+    using WriteFunction = std::function<size_t(const uint8_t *data, size_t size)>;
+
+    MlxCaptureWriter() = delete;
+    explicit MlxCaptureWriter(WriteFunction write_func)
+        : _write_func(write_func)
+    {
+        assert(_write_func != nullptr);
+    }
+
+    MlxCaptureWriter(const MlxCaptureWriter &) = delete;
+    MlxCaptureWriter &operator=(const MlxCaptureWriter &) = delete;
+
+    // Starts a capture, the header goes out with the next drain() calls before any record
+    void begin(const MlxEeprom &eeprom)
+    {
+        using namespace capture_encoding;
+
+        memcpy(_header.data(), CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+        put_u16(&_header[4], CAPTURE_VERSION);
+        put_u16(&_header[6], CAPTURE_HEADER_PREFIX_SIZE);
+        put_u16(&_header[8], MLX_EEPROM_WORDS);
+        put_u16(&_header[10], MLX_SUBPAGE_FRAME_WORDS);
+        put_u32(&_header[12], 0);
+        put_words(&_header[CAPTURE_HEADER_PREFIX_SIZE], eeprom.data(), eeprom.size());
+        _header_offset = 0;
+        _started = true;
+    }
+
+    // Producer, non-blocking. Drops the sub-page if all record buffers wait for the sink.
+    void record(const MlxSubpageFrame &subpage, uint32_t timestamp_ms)
+    {
+        if (!_started) {
+            return;
+        }
+        auto sequence_number = _sequence_number++;
+        auto *bytes = _records.acquire();
+        if (bytes == nullptr) {
+            _records_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        using namespace capture_encoding;
+        put_u16(&(*bytes)[0], CAPTURE_RECORD_TYPE_SUBPAGE);
+        put_u16(&(*bytes)[2], MLX_SUBPAGE_FRAME_WORDS);
+        put_u32(&(*bytes)[4], timestamp_ms);
+        put_u32(&(*bytes)[8], sequence_number);
+        put_words(&(*bytes)[CAPTURE_RECORD_PREFIX_SIZE], subpage.data(), subpage.size());
+        _records.publish(bytes);
+    }
+
+    // Consumer. Passes pending bytes to the sink until it stops accepting or nothing is left, returns true if
+    // everything recorded so far was written.
+    bool drain()
+    {
+        if (!_started) {
+            return true;
+        }
+        if (!_write_pending(_header.data(), _header.size(), _header_offset)) {
+            return false;
+        }
+        while (true) {
+            if (_current == nullptr) {
+                _current = _records.consume();
+                _current_offset = 0;
+                if (_current == nullptr) {
+                    return true;
+                }
+            }
+            if (!_write_pending(_current->data(), _current->size(), _current_offset)) {
+                return false;
+            }
+            _records.release(_current);
+            _current = nullptr;
+            _records_written++;
+        }
+    }
+
+    [[nodiscard]] CaptureWriterStats stats() const noexcept
+    {
+        return {_records_written, _records_dropped.load(std::memory_order_relaxed), _bytes_written};
+    }
+
+private:
+    bool _write_pending(const uint8_t *data, size_t size, size_t &offset)
+    {
+        while (offset < size) {
+            auto written = _write_func(data + offset, size - offset);
+            if (written == 0) {
+                return false;
+            }
+            offset += written;
+            _bytes_written += written;
+        }
+        return true;
+    }
+
+    WriteFunction _write_func = nullptr;
+    bool _started = false;
+
+    // producer
+    uint32_t _sequence_number = 0;
+    std::atomic<uint32_t> _records_dropped{0};
+
+    // consumer
+    CaptureHeaderBytes _header{};
+    size_t _header_offset = 0;
+    CaptureRecordBytes *_current = nullptr;
+    size_t _current_offset = 0;
+    uint32_t _records_written = 0;
+    uint32_t _bytes_written = 0;
+
+    BufferPool<CaptureRecordBytes, CAPTURE_RECORD_BUFFER_COUNT> _records;
+};
+
+enum class CaptureReadResult
+{
+    OK,
+    END_OF_CAPTURE,      // clean end between two records
+    TRUNCATED,           // the capture ends inside the header or a record
+    BAD_HEADER,          // not a capture or different EEPROM / sub-page size
+    UNSUPPORTED_VERSION, // written by a newer format version
+    BAD_RECORD           // unknown record type or size
+};
+
+struct CaptureRecord
+{
+    uint32_t timestamp_ms;
+    uint32_t sequence_number;
+    MlxSubpageFrame subpage;
+};
+
+// Reader of the capture format. The EEPROM goes into Adafruit_MLX90640::loadEEPROM (MLX90640_ExtractParameters),
+// each sub-page into calculateSubpage (MLX90640_CalculateTo) which replays the session bit-exactly.
+class MlxCaptureReader
+{
+public:
+    // reads up to size bytes, returns how many were read, 0 at the end of the capture
+    using ReadFunction = std::function<size_t(uint8_t *data, size_t size)>;
+
+    MlxCaptureReader() = delete;
+    explicit MlxCaptureReader(ReadFunction read_func)
+        : _read_func(read_func)
+    {
+        assert(_read_func != nullptr);
+    }
+
+    // Reads the header and the EEPROM dump
+    CaptureReadResult begin()
+    {
+        using namespace capture_encoding;
+
+        CaptureHeaderBytes header;
+        auto prefix_result = _read_exactly(header.data(), CAPTURE_HEADER_PREFIX_SIZE);
+        if (prefix_result != CaptureReadResult::OK) {
+            return prefix_result == CaptureReadResult::END_OF_CAPTURE ? CaptureReadResult::TRUNCATED : prefix_result;
+        }
+        if (memcmp(header.data(), CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0) {
+            return CaptureReadResult::BAD_HEADER;
+        }
+        _version = get_u16(&header[4]);
+        if (_version > CAPTURE_VERSION) {
+            return CaptureReadResult::UNSUPPORTED_VERSION;
+        }
+        if (get_u16(&header[6]) != CAPTURE_HEADER_PREFIX_SIZE || get_u16(&header[8]) != MLX_EEPROM_WORDS ||
+            get_u16(&header[10]) != MLX_SUBPAGE_FRAME_WORDS) {
+            return CaptureReadResult::BAD_HEADER;
+        }
+
+        auto eeprom_result = _read_exactly(&header[CAPTURE_HEADER_PREFIX_SIZE], 2 * MLX_EEPROM_WORDS);
+        if (eeprom_result != CaptureReadResult::OK) {
+            return CaptureReadResult::TRUNCATED;
+        }
+        get_words(&header[CAPTURE_HEADER_PREFIX_SIZE], _eeprom.data(), _eeprom.size());
+        return CaptureReadResult::OK;
+    }
+
+    // Reads the next sub-page record
+    CaptureReadResult next(CaptureRecord &record)
+    {
+        using namespace capture_encoding;
+
+        auto prefix_result = _read_exactly(_record.data(), CAPTURE_RECORD_PREFIX_SIZE);
+        if (prefix_result != CaptureReadResult::OK) {
+            return prefix_result;
+        }
+        if (get_u16(&_record[0]) != CAPTURE_RECORD_TYPE_SUBPAGE || get_u16(&_record[2]) != MLX_SUBPAGE_FRAME_WORDS) {
+            return CaptureReadResult::BAD_RECORD;
+        }
+        if (_read_exactly(&_record[CAPTURE_RECORD_PREFIX_SIZE], 2 * MLX_SUBPAGE_FRAME_WORDS) !=
+            CaptureReadResult::OK) {
+            return CaptureReadResult::TRUNCATED;
+        }
+        record.timestamp_ms = get_u32(&_record[4]);
+        record.sequence_number = get_u32(&_record[8]);
+        get_words(&_record[CAPTURE_RECORD_PREFIX_SIZE], record.subpage.data(), record.subpage.size());
+        return CaptureReadResult::OK;
+    }
+
+    const MlxEeprom &eeprom() const noexcept { return _eeprom; }
+    uint16_t version() const noexcept { return _version; }
+
+private:
+    // OK, END_OF_CAPTURE if nothing could be read or TRUNCATED if only a part
+    CaptureReadResult _read_exactly(uint8_t *data, size_t size)
+    {
+        size_t offset = 0;
+        while (offset < size) {
+            auto read = _read_func(data + offset, size - offset);
+            if (read == 0) {
+                return offset == 0 ? CaptureReadResult::END_OF_CAPTURE : CaptureReadResult::TRUNCATED;
+            }
+            offset += read;
+        }
+        return CaptureReadResult::OK;
+    }
+
+    ReadFunction _read_func = nullptr;
+    uint16_t _version = 0;
+    MlxEeprom _eeprom{};
+    CaptureRecordBytes _record{};
+};
+
+} // namespace thermocam
@@ -0,0 +1,357 @@
+#pragma once
+
+#include <Adafruit_MLX90640.h>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <stdint.h>
+
+#include "fourth_root.h"
+#include "mlx_calibration.h"
+#include "mlx_pixel_layout.h"
+
+namespace thermocam {
+
+// fraction bits of the compensated IR signal
+constexpr int FIXED_POINT_IR_FRACTION_BITS = 10;
+// fraction bits of the kta / kv / alpha correction factors (1 + kta * dTa, 1 + ksTo * dT, ...)
+constexpr int FIXED_POINT_FACTOR_FRACTION_BITS = 24;
+// fraction bits of temperatures in Kelvin and of the fourth root
+constexpr int FIXED_POINT_KELVIN_FRACTION_BITS = 16;
+// ksTo is about 1e-4 to 1e-3 per Kelvin, 32 bits keep it to 1e-6 and any EEPROM value in an int32
+constexpr int FIXED_POINT_KS_TO_FRACTION_BITS = 32;
+// factor bits dropped before the divisions, so a value in K^4 times the factor stays in 64 bit up to 2^43
+constexpr int FIXED_POINT_DIVISION_SHIFT = 4;
+
+// Per sub-page constants of the fixed-point kernel, converted once from the float MlxSubpageContext
+struct MlxFixedPointSubpageContext
+{
+    int64_t gain;           // Q24
+    int32_t kta_step;       // (Ta - 25) / 2^ktaScale, Q24
+    int32_t kv_step;        // (Vdd - 3.3) / 2^kvScale, Q24
+    int32_t ir_cp_tgc;      // tgc * compensation pixel, IR fraction
+    int64_t alpha_scale;    // 1 / (SCALEALPHA * 2^alphaScale * (1 + KsTa * (Ta - 25)) * emissivity)
+    int alpha_scale_shift;  // fraction bits of alpha_scale including the IR fraction
+    int64_t ta_tr;          // K^4
+};
+
+// To engine in integer arithmetic for cores without an FPU (ESP32-C3): per pixel there is no float operation except
+// the conversion of the result, the fourth roots come from fixed_point_fourth_root(). The auxiliary data is
+// still evaluated in float once per sub-page (MlxSensorCalibration), that is a few dozen operations against 384
+// pixels. Maximum error against MLX90640_CalculateTo: 0.01 C from -40 to 400 C (test_mlx_fixed_point), far below
+// the noise of the sensor. Same interface as MlxCalibration, about 15 kB.
+class MlxFixedPointCalibration
+{
+public:
+    MlxFixedPointCalibration() = default;
+    explicit MlxFixedPointCalibration(const paramsMLX90640 &params, float emissivity = DEFAULT_EMISSIVITY)
+    {
+        compile(params, emissivity);
+    }
+
+    void compile(const paramsMLX90640 &params, float emissivity = DEFAULT_EMISSIVITY)
+    {
+        _sensor.compile(params, emissivity);
+        _kta_scale = params.ktaScale;
+        _kv_scale = params.kvScale;
+        _alpha_scale = params.alphaScale;
+        for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+            _offset[pixel_index] = params.offset[pixel_index];
+            _kta[pixel_index] = params.kta[pixel_index];
+            _kv[pixel_index] = params.kv[pixel_index];
+            // the parameters already hold SCALEALPHA * 2^alphaScale / alpha
+            _inverse_alpha[pixel_index] = params.alpha[pixel_index];
+            _il_chess_correction[pixel_index] =
+                    _to_fixed<int16_t>(il_chess_correction(params, pixel_index), FIXED_POINT_IR_FRACTION_BITS);
+        }
+
+        for (size_t range = 0; range < _ks_to.size(); range++) {
+            _ks_to[range] = _to_fixed<int32_t>(_sensor.ks_to()[range], FIXED_POINT_KS_TO_FRACTION_BITS);
+            _ct_kelvin[range] = _to_fixed<int32_t>(_sensor.ct()[range] + KELVIN_OFFSET, FIXED_POINT_KELVIN_FRACTION_BITS);
+            _alpha_corr_range[range] =
+                    _to_fixed<int32_t>(_sensor.alpha_corr_range()[range], FIXED_POINT_FACTOR_FRACTION_BITS);
+        }
+        _offset_cache.invalidate();
+        _anchor_estimate.fill(-1);
+        _is_compiled = true;
+    }
+
+    MlxSubpageContext prepare_subpage(const uint16_t *subpage_frame) const
+    {
+        return _sensor.prepare_subpage(subpage_frame);
+    }
+
+    MlxFixedPointSubpageContext prepare_fixed_point(const MlxSubpageContext &context) const
+    {
+        MlxFixedPointSubpageContext fixed{};
+        fixed.gain = _to_fixed<int64_t>(context.gain, FIXED_POINT_FACTOR_FRACTION_BITS);
+        fixed.kta_step = _to_fixed<int32_t>(context.delta_ta, FIXED_POINT_FACTOR_FRACTION_BITS - _kta_scale);
+        fixed.kv_step = _to_fixed<int32_t>(context.delta_vdd, FIXED_POINT_FACTOR_FRACTION_BITS - _kv_scale);
+        fixed.ir_cp_tgc = _to_fixed<int32_t>(_sensor.tgc() * context.ir_cp, FIXED_POINT_IR_FRACTION_BITS);
+
+        // IR * inverse alpha is below 2^42, the scale keeps 20 significant bits so the product stays below 2^62
+        auto alpha_scale = 1.0f / (static_cast<float>(SCALEALPHA) * std::ldexp(1.0f, _alpha_scale) *
+                                   context.alpha_ta * _sensor.emissivity());
+        int exponent;
+        std::frexp(alpha_scale, &exponent);
+        fixed.alpha_scale_shift = 20 - exponent + FIXED_POINT_IR_FRACTION_BITS;
+        fixed.alpha_scale = _to_fixed<int64_t>(alpha_scale, 20 - exponent);
+        fixed.ta_tr = std::llround(context.ta_tr);
+        return fixed;
+    }
+
+    // To kernel: object temperatures in degree Celsius of the pixels of the sub-page, the others are not written.
+    // Each value also goes to stats_sink(pixel_index, temperature), e.g. SubpageStats::add(), while it is at hand.
+    template <typename StatsSink = NoStatsSink>
+    void calculate_to(const uint16_t *subpage_frame,
+                      const MlxSubpageContext &context,
+                      float *temperatures,
+                      StatsSink stats_sink = {})
+    {
+        const auto &pixel_indices = subpage_pixel_indices(context.subpage_number, context.readout_mode);
+        calculate_pixels_to(subpage_frame, context, pixel_indices.data(), pixel_indices.size(), temperatures,
+                            stats_sink);
+    }
+
+    // see MlxCalibration::calculate_pixels_to()
+    template <typename StatsSink = NoStatsSink>
+    void calculate_pixels_to(const uint16_t *subpage_frame,
+                             const MlxSubpageContext &context,
+                             const uint16_t *pixel_indices,
+                             size_t pixel_count,
+                             float *temperatures,
+                             StatsSink stats_sink = {})
+    {
+        _single_pass_stats = {static_cast<uint32_t>(pixel_count), 0};
+        auto fixed = prepare_fixed_point(context);
+        _update_compensated_offset(context, fixed);
+        for (size_t i = 0; i < pixel_count; i++) {
+            auto pixel_index = pixel_indices[i];
+            auto image = _image(pixel_index, subpage_frame[pixel_index], fixed, context.is_calibration_mode);
+            auto temperature = _calculate_pixel_to(pixel_index, image, fixed);
+            temperatures[pixel_index] = temperature;
+            stats_sink(pixel_index, temperature);
+        }
+    }
+
+    // see MlxCalibration::calculate_image(), the integer image converted to float
+    void calculate_image(const uint16_t *subpage_frame, const MlxSubpageContext &context, float *image)
+    {
+        auto fixed = prepare_fixed_point(context);
+        _update_compensated_offset(context, fixed);
+        for (auto pixel_index : subpage_pixel_indices(context.subpage_number, context.readout_mode)) {
+            image[pixel_index] = static_cast<float>(
+                    _image(pixel_index, subpage_frame[pixel_index], fixed, context.is_calibration_mode));
+        }
+    }
+
+    // Drop-in replacement for Adafruit_MLX90640::calculateSubpage
+    template <typename StatsSink = NoStatsSink>
+    void calculate_subpage(const uint16_t *subpage_frame, float *temperatures, StatsSink stats_sink = {})
+    {
+        _set_last_context(prepare_subpage(subpage_frame));
+        calculate_to(subpage_frame, _last_context, temperatures, stats_sink);
+    }
+
+    void calculate_subpage_image(const uint16_t *subpage_frame, float *image)
+    {
+        _set_last_context(prepare_subpage(subpage_frame));
+        calculate_image(subpage_frame, _last_context, image);
+    }
+
+    // see MlxCalibration::image_to_temperature()
+    float image_to_temperature(size_t pixel_index, float image) const
+    {
+        const auto &context = _subpage_contexts[is_pixel_in_subpage(pixel_index, 1, _last_context.readout_mode) ? 1
+                                                                                                                : 0];
+        int32_t estimate;
+        return _to_celsius(_two_pass_to(std::llround(image), std::llround(context.ta_tr), estimate));
+    }
+
+    float temperature_to_image(float temperature) const
+    {
+        return _sensor.temperature_to_image(temperature, _last_context);
+    }
+
+    void set_offset_cache_epsilon(float ta_epsilon, float vdd_epsilon)
+    {
+        _offset_cache = OffsetCompensationCache(ta_epsilon, vdd_epsilon);
+    }
+
+    // see MlxCalibration::set_single_pass()
+    void set_single_pass(bool is_single_pass)
+    {
+        _is_single_pass = is_single_pass;
+        _anchor_estimate.fill(-1);
+    }
+
+    bool is_compiled() const noexcept { return _is_compiled; }
+    // context of the latest calculate_subpage(), e.g. for Ta
+    const MlxSubpageContext &last_context() const noexcept { return _last_context; }
+    const OffsetCacheStats &offset_cache_stats() const noexcept { return _offset_cache.stats(); }
+    const SinglePassStats &single_pass_stats() const noexcept { return _single_pass_stats; }
+
+private:
+    static constexpr int32_t ONE_KELVIN = 1 << FIXED_POINT_KELVIN_FRACTION_BITS;
+    static constexpr int64_t ONE_FACTOR = int64_t{1} << FIXED_POINT_FACTOR_FRACTION_BITS;
+    static constexpr int32_t ZERO_CELSIUS = static_cast<int32_t>(KELVIN_OFFSET * ONE_KELVIN + 0.5f);
+    static constexpr int KS_TO_SHIFT = FIXED_POINT_KS_TO_FRACTION_BITS - FIXED_POINT_FACTOR_FRACTION_BITS +
+                                       FIXED_POINT_KELVIN_FRACTION_BITS;
+    static constexpr int64_t SINGLE_PASS_ERROR = static_cast<int64_t>(SINGLE_PASS_MAX_ERROR * ONE_KELVIN + 0.5f);
+    // larger drifts from the anchor always fall back, keeps the error estimate in 64 bit
+    static constexpr int32_t SINGLE_PASS_MAX_DRIFT = 16 * ONE_KELVIN;
+
+    template <typename Integer> static Integer _to_fixed(float value, int fraction_bits)
+    {
+        return static_cast<Integer>(std::llround(std::ldexp(static_cast<double>(value), fraction_bits)));
+    }
+
+    static int32_t _fourth_root(int64_t value) noexcept
+    {
+        return fixed_point_fourth_root<FIXED_POINT_KELVIN_FRACTION_BITS>(value);
+    }
+
+    // (value / factor + Ta,r)^(1/4) with value / factor in signal, factor with the factor fraction bits
+    int32_t _corrected_root(int64_t value, int64_t factor, int64_t ta_tr, int64_t &signal) const noexcept
+    {
+        if (factor >> FIXED_POINT_DIVISION_SHIFT <= 0) {
+            return -1;
+        }
+        signal = value * (ONE_FACTOR >> FIXED_POINT_DIVISION_SHIFT) / (factor >> FIXED_POINT_DIVISION_SHIFT);
+        return _fourth_root(signal + ta_tr);
+    }
+
+    // root with the alpha correction of the extended temperature range for a first estimate in Kelvin
+    int32_t _range_corrected_root(int64_t value, int32_t estimate, size_t range, int64_t ta_tr, int64_t &signal) const
+            noexcept
+    {
+        auto range_factor = ONE_FACTOR + ((static_cast<int64_t>(_ks_to[range]) * (estimate - _ct_kelvin[range])) >>
+                                          KS_TO_SHIFT);
+        return _corrected_root(value, (_alpha_corr_range[range] * range_factor) >> FIXED_POINT_FACTOR_FRACTION_BITS,
+                               ta_tr, signal);
+    }
+
+    size_t _range(int32_t to) const noexcept
+    {
+        return to < _ct_kelvin[1] ? 0 : to < _ct_kelvin[2] ? 1 : to < _ct_kelvin[3] ? 2 : 3;
+    }
+
+    static float _to_celsius(int32_t to) noexcept
+    {
+        return to < 0 ? NAN : static_cast<float>(to - ZERO_CELSIUS) * (1.0f / ONE_KELVIN);
+    }
+
+    void _set_last_context(const MlxSubpageContext &context)
+    {
+        _last_context = context;
+        _subpage_contexts[context.subpage_number & 1] = context;
+    }
+
+    // offset * (1 + kta * (Ta - 25)) * (1 + kv * (Vdd - 3.3)) with the IR fraction bits
+    int32_t _compensate_offset(size_t pixel_index, const MlxFixedPointSubpageContext &fixed) const noexcept
+    {
+        int64_t kta_factor = ONE_FACTOR + _kta[pixel_index] * fixed.kta_step;
+        int64_t kv_factor = ONE_FACTOR + _kv[pixel_index] * fixed.kv_step;
+        auto offset_factor = (kta_factor * kv_factor) >> FIXED_POINT_FACTOR_FRACTION_BITS;
+        return static_cast<int32_t>((_offset[pixel_index] * offset_factor) >>
+                                    (FIXED_POINT_FACTOR_FRACTION_BITS - FIXED_POINT_IR_FRACTION_BITS));
+    }
+
+    void _update_compensated_offset(const MlxSubpageContext &context, const MlxFixedPointSubpageContext &fixed)
+    {
+        if (!_offset_cache.needs_rebuild(context)) {
+            return;
+        }
+        for (auto pixel_index : subpage_pixel_indices(context.subpage_number, context.readout_mode)) {
+            _compensated_offset[pixel_index] = _compensate_offset(pixel_index, fixed);
+        }
+    }
+
+    // IR / (alpha * emissivity) in K^4, the kernel works on (v / factor + Ta,r)^(1/4) with factors close to 1
+    int64_t _image(size_t pixel_index,
+                   uint16_t raw,
+                   const MlxFixedPointSubpageContext &fixed,
+                   bool is_calibration_mode) const noexcept
+    {
+        constexpr int IR_SHIFT = FIXED_POINT_FACTOR_FRACTION_BITS - FIXED_POINT_IR_FRACTION_BITS;
+        int32_t ir = static_cast<int32_t>((static_cast<int16_t>(raw) * fixed.gain) >> IR_SHIFT);
+        ir -= _compensated_offset[pixel_index];
+        if (!is_calibration_mode) {
+            ir += _il_chess_correction[pixel_index];
+        }
+        ir -= fixed.ir_cp_tgc;
+        return (static_cast<int64_t>(ir) * _inverse_alpha[pixel_index] * fixed.alpha_scale) >> fixed.alpha_scale_shift;
+    }
+
+    // To in Kelvin of the two passes of MLX90640_CalculateTo, negative for NaN
+    int32_t _two_pass_to(int64_t v, int64_t ta_tr, int32_t &estimate) const noexcept
+    {
+        // MLX90640_CalculateTo divides by alpha * (1 - ksTo1 * 273.15) + Sx with Sx = ksTo1 * alpha * T0
+        int64_t signal;
+        auto first_root = _fourth_root(v + ta_tr);
+        auto first_factor = ONE_FACTOR + ((static_cast<int64_t>(_ks_to[1]) * (first_root - ZERO_CELSIUS)) >> KS_TO_SHIFT);
+        estimate = _corrected_root(v, first_factor, ta_tr, signal);
+        if (first_root < 0 || estimate < 0) {
+            return -1;
+        }
+        // extended temperature ranges, the first estimate selects the range
+        return _range_corrected_root(v, estimate, _range(estimate), ta_tr, signal);
+    }
+
+    float _calculate_pixel_to(size_t pixel_index, int64_t v, const MlxFixedPointSubpageContext &fixed)
+    {
+        int64_t signal = 0;
+        auto estimate = _anchor_estimate[pixel_index];
+        if (_is_single_pass && estimate >= 0) {
+            auto range = _range(estimate);
+            auto to = _range_corrected_root(v, estimate, range, fixed.ta_tr, signal);
+            // error estimate of MlxCalibration: ksTo * signal * drift within 2 To^3 * SINGLE_PASS_MAX_ERROR
+            auto drift = to - _anchor_to[pixel_index];
+            if (to >= 0 && std::abs(drift) < SINGLE_PASS_MAX_DRIFT && _range(estimate + drift) == range) {
+                int64_t kelvin = to >> FIXED_POINT_KELVIN_FRACTION_BITS;
+                auto slope = ((std::abs(signal) >> FIXED_POINT_KELVIN_FRACTION_BITS) * std::abs(_ks_to[range])) >>
+                             (FIXED_POINT_KS_TO_FRACTION_BITS - FIXED_POINT_KELVIN_FRACTION_BITS);
+                if (slope * std::abs(drift) <= 2 * kelvin * kelvin * kelvin * SINGLE_PASS_ERROR) {
+                    return _to_celsius(to);
+                }
+            }
+        }
+
+        _single_pass_stats.fallbacks++;
+        auto to = _two_pass_to(v, fixed.ta_tr, estimate);
+        _anchor_estimate[pixel_index] = to < 0 ? -1 : estimate;
+        _anchor_to[pixel_index] = to;
+        return _to_celsius(to);
+    }
+
+    MlxSensorCalibration _sensor;
+    bool _is_compiled = false;
+    MlxSubpageContext _last_context{};
+    std::array<MlxSubpageContext, 2> _subpage_contexts{};
+    OffsetCompensationCache _offset_cache;
+    bool _is_single_pass = false;
+    SinglePassStats _single_pass_stats{};
+    uint8_t _kta_scale = 0;
+    uint8_t _kv_scale = 0;
+    uint8_t _alpha_scale = 0;
+
+    // per range, Kelvin / factor fraction bits
+    std::array<int32_t, 4> _ks_to{};
+    std::array<int32_t, 4> _ct_kelvin{};
+    std::array<int32_t, 4> _alpha_corr_range{};
+
+    // per pixel
+    std::array<int16_t, MLX_PIXEL_COUNT> _offset{};
+    // offset compensation of the cached Ta / Vdd with the IR fraction bits
+    std::array<int32_t, MLX_PIXEL_COUNT> _compensated_offset{};
+    std::array<int8_t, MLX_PIXEL_COUNT> _kta{};
+    std::array<int8_t, MLX_PIXEL_COUNT> _kv{};
+    std::array<uint16_t, MLX_PIXEL_COUNT> _inverse_alpha{};
+    // interleave / chess correction with the IR fraction bits
+    std::array<int16_t, MLX_PIXEL_COUNT> _il_chess_correction{};
+    // first estimate and To of the latest two-pass evaluation in Kelvin, negative without one
+    std::array<int32_t, MLX_PIXEL_COUNT> _anchor_estimate{};
+    std::array<int32_t, MLX_PIXEL_COUNT> _anchor_to{};
+};
+
+} // namespace thermocam
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <Adafruit_MLX90640.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "algorithms.h"
+
+namespace thermocam {
+
+constexpr uint32_t PARAMS_CACHE_MAGIC = 0x4D4C5850; // "MLXP"
+// bump when the content changes without changing sizeof(paramsMLX90640), e.g. a different extraction
+constexpr uint16_t PARAMS_CACHE_VERSION = 1;
+
+// Stored in front of the parameters, in host byte order since the cache never leaves the device
+struct ParamsCacheHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t params_size;
+    uint16_t serial_number[3];
+    uint16_t reserved;
+    // over the serial number and the parameters
+    uint32_t crc;
+};
+
+struct ParamsCacheStats
+{
+    uint32_t hits;
+    // nothing stored or stored for another sensor
+    uint32_t misses;
+    // wrong format or CRC mismatch, the parameters are extracted again and overwrite the entry
+    uint32_t invalid;
+    uint32_t stores;
+    uint32_t store_failures;
+};
+
+// Validation and bookkeeping of a single cache entry, backends only move the header and the parameters
+class MlxParamsCache : public MLX90640_ParamsCache
+{
+public:
+    bool load(const uint16_t *serial_number, paramsMLX90640 *params) override
+    {
+        ParamsCacheHeader header{};
+        if (!_read_header(header)) {
+            _stats.misses++;
+            return false;
+        }
+        if (header.magic != PARAMS_CACHE_MAGIC || header.version != PARAMS_CACHE_VERSION ||
+            header.params_size != sizeof(paramsMLX90640)) {
+            _stats.invalid++;
+            return false;
+        }
+        if (memcmp(header.serial_number, serial_number, sizeof(header.serial_number)) != 0) {
+            _stats.misses++;
+            return false;
+        }
+        if (!_read_params(*params) || _crc(serial_number, *params) != header.crc) {
+            _stats.invalid++;
+            return false;
+        }
+        _stats.hits++;
+        return true;
+    }
+
+    bool store(const uint16_t *serial_number, const paramsMLX90640 *params) override
+    {
+        ParamsCacheHeader header{.magic = PARAMS_CACHE_MAGIC,
+                                 .version = PARAMS_CACHE_VERSION,
+                                 .params_size = sizeof(paramsMLX90640),
+                                 .serial_number = {serial_number[0], serial_number[1], serial_number[2]},
+                                 .reserved = 0,
+                                 .crc = _crc(serial_number, *params)};
+        if (!_write(header, *params)) {
+            _stats.store_failures++;
+            return false;
+        }
+        _stats.stores++;
+        return true;
+    }
+
+    const ParamsCacheStats &stats() const noexcept { return _stats; }
+
+protected:
+    // false if there is no entry
+    virtual bool _read_header(ParamsCacheHeader &header) = 0;
+    virtual bool _read_params(paramsMLX90640 &params) = 0;
+    virtual bool _write(const ParamsCacheHeader &header, const paramsMLX90640 &params) = 0;
+
+private:
+    static uint32_t _crc(const uint16_t *serial_number, const paramsMLX90640 &params)
+    {
+        auto crc = algorithms::crc32(reinterpret_cast<const uint8_t *>(serial_number), 3 * sizeof(uint16_t));
+        return algorithms::crc32(reinterpret_cast<const uint8_t *>(&params), sizeof(params), crc);
+    }
+
+    ParamsCacheStats _stats{};
+};
+
+// Cache entry in a file (header followed by the parameters), for native builds or a mounted file system
+class FileParamsCache : public MlxParamsCache
+{
+public:
+    FileParamsCache() = delete;
+    explicit FileParamsCache(std::string path)
+        : _path(path)
+    {
+    }
+
+protected:
+    bool _read_header(ParamsCacheHeader &header) override { return _read_at(0, &header, sizeof(header)); }
+
+    bool _read_params(paramsMLX90640 &params) override
+    {
+        return _read_at(sizeof(ParamsCacheHeader), &params, sizeof(params));
+    }
+
+    bool _write(const ParamsCacheHeader &header, const paramsMLX90640 &params) override
+    {
+        auto *file = fopen(_path.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(&params, sizeof(params), 1, file) == 1;
+        return fclose(file) == 0 && written;
+    }
+
+private:
+    bool _read_at(long offset, void *data, size_t size)
+    {
+        auto *file = fopen(_path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        bool read = fseek(file, offset, SEEK_SET) == 0 && fread(data, size, 1, file) == 1;
+        fclose(file);
+        return read;
+    }
+
+    std::string _path;
+};
+
+} // namespace thermocam
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdint.h>
+
+#include "config.h"
+#include "mlx_bad_pixels.h"
+#include "mlx_pixel_layout.h"
+#include "types/mlx_types.h"
+
+namespace thermocam {
+
+// weight of the latest frame in the per-pixel moving averages, about 1 / frames of memory
+constexpr float PIXEL_FAULT_SMOOTHING = 1.0f / 16;
+// frames per sub-page before any pixel is judged, the averages need that long to settle
+constexpr uint32_t PIXEL_FAULT_WARMUP_FRAMES = 32;
+// temporal variance of a pixel against the (outlier-capped) mean of its sub-page: below the stuck ratio the pixel
+// does not follow the sensor noise anymore, above the noisy ratio it is 5x noisier than a typical pixel
+constexpr float PIXEL_FAULT_STUCK_RATIO = 0.01f;
+constexpr float PIXEL_FAULT_NOISY_RATIO = 25.0f;
+// average residual outside the range of the neighbours, in C and in multiples of the RMS residual of the sub-page
+constexpr float PIXEL_FAULT_MIN_RESIDUAL = 3.0f;
+constexpr float PIXEL_FAULT_RESIDUAL_SIGMAS = 8.0f;
+// the neighbour range is widened by this share of its width, the end of a hot line or the edge of an object over a
+// gradient is a little beyond its neighbours too
+constexpr float PIXEL_FAULT_RANGE_MARGIN = 0.25f;
+// frames a condition has to hold before a pixel is flagged, and to be gone before it is cleared again
+constexpr uint8_t PIXEL_FAULT_CONFIRM_FRAMES = 8;
+
+enum class PixelFault : uint8_t
+{
+    NONE,
+    STUCK,  // reading does not change
+    NOISY,  // temporal noise far above the other pixels
+    OFFSET, // reading far off its neighbours over many frames (dead, hot or NaN)
+};
+
+// Online detector of pixels that fail in the field, after the EEPROM list of MLX90640_ExtractDeviatingPixels was
+// written. Fed with each calculated sub-page before the bad-pixel correction, it keeps per pixel moving averages of
+// the squared frame-to-frame change (temporal variance) and of the residual outside the range of its neighbours in
+// the same sub-page, O(1) per pixel and about 10 kB in total. The thresholds are relative to the sub-page, so a
+// moving scene or a noisier resolution does not flag healthy pixels. faulty_pixels() goes to
+// MlxBadPixelCorrection::set_detected_pixels(), generation() tells when it changed.
+class MlxPixelFaultDetector
+{
+public:
+    MlxPixelFaultDetector() { reset(); }
+
+    // temperatures of a calculated sub-page, only the pixels of that sub-page are read
+    void update_subpage(uint8_t subpage_number, Mlx90640PixelReadoutMode readout_mode, const float *temperatures)
+    {
+        subpage_number &= 1;
+        auto frames = _frames[subpage_number]++;
+        float variance_cap = PIXEL_FAULT_NOISY_RATIO * _mean_variance[subpage_number];
+        auto residual_rms = std::sqrt(_mean_squared_residual[subpage_number]);
+        float residual_limit = std::max(PIXEL_FAULT_MIN_RESIDUAL, PIXEL_FAULT_RESIDUAL_SIGMAS * residual_rms);
+        float variance_sum = 0.0f;
+        float squared_residual_sum = 0.0f;
+        for (auto pixel_index : subpage_pixel_indices(subpage_number, readout_mode)) {
+            auto temperature = temperatures[pixel_index];
+            auto residual = _neighbour_residual(pixel_index, readout_mode, temperatures);
+            // a NaN pixel is off, a NaN neighbour leaves the pixel as it is
+            auto condition = std::isnan(temperature) ? PixelFault::OFFSET : PixelFault::NONE;
+            if (!std::isnan(residual)) {
+                if (std::isnan(_residual[pixel_index])) { // first valid reading
+                    _previous[pixel_index] = temperature;
+                    _residual[pixel_index] = residual;
+                }
+                auto change = temperature - _previous[pixel_index];
+                _previous[pixel_index] = temperature;
+                _variance[pixel_index] += PIXEL_FAULT_SMOOTHING * (change * change - _variance[pixel_index]);
+                _residual[pixel_index] += PIXEL_FAULT_SMOOTHING * (residual - _residual[pixel_index]);
+                condition = _condition(_variance[pixel_index], _residual[pixel_index], variance_cap, residual_limit,
+                                       subpage_number);
+                variance_sum += std::min(_variance[pixel_index], variance_cap);
+                squared_residual_sum += std::min(_residual[pixel_index] * _residual[pixel_index],
+                                                 residual_limit * residual_limit);
+            }
+            if (frames >= PIXEL_FAULT_WARMUP_FRAMES) {
+                _update_score(pixel_index, condition);
+            }
+        }
+        if (frames > 0) {
+            _mean_variance[subpage_number] = variance_sum / MLX_SUBPAGE_PIXEL_COUNT;
+            _mean_squared_residual[subpage_number] = squared_residual_sum / MLX_SUBPAGE_PIXEL_COUNT;
+        }
+    }
+
+    // sub-page number and readout mode from the frame words, for the frame path of the firmware
+    void update_subpage(const uint16_t *subpage_frame, const float *temperatures)
+    {
+        auto readout_mode = (subpage_frame[MLX_CONTROL_REGISTER_WORD] & MLX_CONTROL_CHESS_MODE) != 0
+                                    ? Mlx90640PixelReadoutMode::MLX90640_CHESS
+                                    : Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED;
+        update_subpage(subpage_frame[MLX_SUBPAGE_NUMBER_WORD] & MLX_STATUS_SUBPAGE_MASK, readout_mode, temperatures);
+    }
+
+    void reset()
+    {
+        _frames = {0, 0};
+        _mean_variance = {INFINITY, INFINITY};
+        _mean_squared_residual = {INFINITY, INFINITY};
+        _variance.fill(0.0f);
+        _residual.fill(NAN);
+        _scores.fill(0);
+        _faults.fill(PixelFault::NONE);
+        _faulty_pixels.clear();
+        _fault_counts.fill(0);
+        _fault_counts[static_cast<size_t>(PixelFault::NONE)] = MLX_PIXEL_COUNT;
+        _generation++;
+    }
+
+    PixelFault fault(size_t pixel_index) const noexcept { return _faults[pixel_index]; }
+    const MlxPixelBitmap &faulty_pixels() const noexcept { return _faulty_pixels; }
+    // counts up whenever a pixel is flagged or cleared
+    uint32_t generation() const noexcept { return _generation; }
+    // pixels flagged right now with the fault, NONE counts the good pixels
+    uint32_t fault_count(PixelFault fault) const noexcept { return _fault_counts[static_cast<size_t>(fault)]; }
+
+private:
+    static size_t _mirror(int position, int size) noexcept
+    {
+        return position < 0 ? -position : position >= size ? 2 * (size - 1) - position : position;
+    }
+
+    // How far the pixel is outside the (widened) range of its eight nearest neighbours in the same sub-page, mirrored
+    // at the border. Each neighbourhood holds a neighbour along every row, column and diagonal through the pixel, so
+    // an object of two pixels or a line of one pixel width stays inside, only a single pixel on its own sticks out.
+    static float _neighbour_residual(size_t pixel_index,
+                                     Mlx90640PixelReadoutMode readout_mode,
+                                     const float *temperatures)
+    {
+        // {row, column} offsets, chess mode: diagonals and two steps along row and column, interleaved mode: the row
+        // and two rows up / down
+        constexpr int8_t CHESS_NEIGHBOURS[8][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1},
+                                                   {0, -2}, {0, 2}, {-2, 0}, {2, 0}};
+        constexpr int8_t INTERLEAVED_NEIGHBOURS[8][2] = {{0, -1}, {0, 1}, {-2, 0}, {2, 0},
+                                                         {-2, -2}, {-2, 2}, {2, -2}, {2, 2}};
+        const auto &neighbours = readout_mode == Mlx90640PixelReadoutMode::MLX90640_CHESS ? CHESS_NEIGHBOURS
+                                                                                          : INTERLEAVED_NEIGHBOURS;
+        int row = pixel_index / MLX_SENSOR_WIDTH;
+        int column = pixel_index % MLX_SENSOR_WIDTH;
+        float low = INFINITY;
+        float high = -INFINITY;
+        for (const auto &offset : neighbours) {
+            auto neighbour = temperatures[_mirror(row + offset[0], MLX_SENSOR_HEIGHT) * MLX_SENSOR_WIDTH +
+                                          _mirror(column + offset[1], MLX_SENSOR_WIDTH)];
+            low = std::min(low, neighbour);
+            high = std::max(high, neighbour);
+        }
+        if (low > high) {
+            return 0.0f; // all neighbours NaN
+        }
+        auto margin = PIXEL_FAULT_RANGE_MARGIN * (high - low);
+        auto temperature = temperatures[pixel_index];
+        return temperature - std::clamp(temperature, low - margin, high + margin);
+    }
+
+    PixelFault _condition(float variance, float residual, float variance_cap, float residual_limit,
+                          uint8_t subpage_number) const noexcept
+    {
+        if (variance < PIXEL_FAULT_STUCK_RATIO * _mean_variance[subpage_number]) {
+            return PixelFault::STUCK;
+        }
+        if (variance > variance_cap) {
+            return PixelFault::NOISY;
+        }
+        if (std::fabs(residual) > residual_limit) {
+            return PixelFault::OFFSET;
+        }
+        return PixelFault::NONE;
+    }
+
+    // counts up while a condition holds and down while it does not, flags at PIXEL_FAULT_CONFIRM_FRAMES and clears
+    // at 0. A flagged pixel takes the latest condition, e.g. a stuck pixel is off its neighbours before its variance
+    // has decayed.
+    void _update_score(size_t pixel_index, PixelFault condition)
+    {
+        auto &score = _scores[pixel_index];
+        if (condition != PixelFault::NONE) {
+            score = std::min<uint8_t>(score + 1, PIXEL_FAULT_CONFIRM_FRAMES);
+            if (score == PIXEL_FAULT_CONFIRM_FRAMES && _faults[pixel_index] != condition) {
+                _set_fault(pixel_index, condition);
+            }
+        } else if (score > 0 && --score == 0 && _faults[pixel_index] != PixelFault::NONE) {
+            _set_fault(pixel_index, PixelFault::NONE);
+        }
+    }
+
+    void _set_fault(size_t pixel_index, PixelFault fault)
+    {
+        auto was_faulty = _faults[pixel_index] != PixelFault::NONE;
+        _fault_counts[static_cast<size_t>(_faults[pixel_index])]--;
+        _fault_counts[static_cast<size_t>(fault)]++;
+        _faults[pixel_index] = fault;
+        if (fault == PixelFault::NONE) {
+            _faulty_pixels.reset(pixel_index);
+        } else {
+            _faulty_pixels.set(pixel_index);
+        }
+        if (was_faulty != (fault != PixelFault::NONE)) {
+            _generation++;
+        }
+    }
+
+    std::array<uint32_t, 2> _frames{};
+    // per sub-page of the previous update, the thresholds of the next one
+    std::array<float, 2> _mean_variance{INFINITY, INFINITY};
+    std::array<float, 2> _mean_squared_residual{INFINITY, INFINITY};
+    uint32_t _generation = 0;
+    std::array<uint32_t, 4> _fault_counts{};
+    MlxPixelBitmap _faulty_pixels;
+
+    // per pixel
+    std::array<float, MLX_PIXEL_COUNT> _previous{};
+    std::array<float, MLX_PIXEL_COUNT> _variance{};
+    std::array<float, MLX_PIXEL_COUNT> _residual{};
+    std::array<uint8_t, MLX_PIXEL_COUNT> _scores{};
+    std::array<PixelFault, MLX_PIXEL_COUNT> _faults{};
+};
+
+} // namespace thermocam
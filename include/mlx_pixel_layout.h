@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "types/mlx_types.h"
+
+namespace thermocam {
+
+constexpr size_t MLX_PIXEL_COUNT = MLX_SENSOR_WIDTH * MLX_SENSOR_HEIGHT;
+
+// Pixel selection of MLX90640_CalculateTo: interleaved mode splits by row, chess mode by row ^ column
+[[nodiscard]] constexpr bool is_pixel_in_subpage(size_t pixel_index, uint8_t subpage_number,
+                                                 Mlx90640PixelReadoutMode readout_mode) noexcept
+{
+    auto row_pattern = (pixel_index / MLX_SENSOR_WIDTH) % 2;
+    auto pattern = readout_mode == Mlx90640PixelReadoutMode::MLX90640_CHESS ? row_pattern ^ (pixel_index % 2)
+                                                                             : row_pattern;
+    return pattern == subpage_number;
+}
+
+// Interleave pattern of MLX90640_CalculateTo: 0 in even rows, 1 in odd rows
+[[nodiscard]] constexpr int interleave_pattern(size_t pixel_index) noexcept
+{
+    return (pixel_index / MLX_SENSOR_WIDTH) % 2;
+}
+
+// Conversion pattern of MLX90640_CalculateTo: -1 / +1 for the 2nd / 4th pixel of every group of four, sign flipped
+// in odd rows
+[[nodiscard]] constexpr int conversion_pattern(size_t pixel_index) noexcept
+{
+    constexpr int GROUP_PATTERN[4] = {0, -1, 0, 1};
+    return GROUP_PATTERN[pixel_index % 4] * (1 - 2 * interleave_pattern(pixel_index));
+}
+
+// One bit per pixel, a 32 bit word per sensor row
+class MlxPixelBitmap
+{
+public:
+    void set(size_t pixel_index) noexcept { _words[pixel_index / 32] |= 1u << (pixel_index % 32); }
+    void reset(size_t pixel_index) noexcept { _words[pixel_index / 32] &= ~(1u << (pixel_index % 32)); }
+    void clear() noexcept { _words.fill(0); }
+    bool test(size_t pixel_index) const noexcept { return (_words[pixel_index / 32] >> (pixel_index % 32)) & 1; }
+    // bits of the row, bit n is column n
+    uint32_t row(size_t row) const noexcept { return _words[row]; }
+    void set_row(size_t row, uint32_t bits) noexcept { _words[row] = bits; }
+    size_t count() const noexcept
+    {
+        size_t count = 0;
+        for (auto word : _words) {
+            count += __builtin_popcount(word);
+        }
+        return count;
+    }
+
+private:
+    static_assert(MLX_SENSOR_WIDTH == 32);
+    std::array<uint32_t, MLX_SENSOR_HEIGHT> _words{};
+};
+
+constexpr size_t MLX_SUBPAGE_PIXEL_COUNT = MLX_PIXEL_COUNT / 2;
+// pixels of one sub-page in ascending order
+using SubpagePixelIndices = std::array<uint16_t, MLX_SUBPAGE_PIXEL_COUNT>;
+
+constexpr SubpagePixelIndices make_subpage_pixel_indices(uint8_t subpage_number,
+                                                         Mlx90640PixelReadoutMode readout_mode) noexcept
+{
+    SubpagePixelIndices indices{};
+    size_t count = 0;
+    for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+        if (is_pixel_in_subpage(pixel_index, subpage_number, readout_mode)) {
+            indices[count++] = static_cast<uint16_t>(pixel_index);
+        }
+    }
+    return indices;
+}
+
+// [readout mode][sub-page number], so a sub-page pass touches its 384 pixels without testing the other 384
+inline constexpr std::array<std::array<SubpagePixelIndices, 2>, 2> SUBPAGE_PIXEL_INDICES = {{
+        {make_subpage_pixel_indices(0, Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED),
+         make_subpage_pixel_indices(1, Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED)},
+        {make_subpage_pixel_indices(0, Mlx90640PixelReadoutMode::MLX90640_CHESS),
+         make_subpage_pixel_indices(1, Mlx90640PixelReadoutMode::MLX90640_CHESS)},
+}};
+
+[[nodiscard]] constexpr const SubpagePixelIndices &subpage_pixel_indices(uint8_t subpage_number,
+                                                                         Mlx90640PixelReadoutMode readout_mode) noexcept
+{
+    return SUBPAGE_PIXEL_INDICES[readout_mode == Mlx90640PixelReadoutMode::MLX90640_CHESS][subpage_number & 1];
+}
+
+} // namespace thermocam
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <stdint.h>
+
+#include "config.h"
+#include "mlx_utils.h"
+#include "types/container_types.h"
+#include "types/mlx_types.h"
+
+namespace thermocam {
+
+// smoothing of the measured pipeline utilization (exponential moving average)
+constexpr float GOVERNOR_UTILIZATION_SMOOTHING = 0.25f;
+// pipeline time / sub-page period above which the pipeline is about to fall behind the sensor
+constexpr float GOVERNOR_OVERLOAD_UTILIZATION = 0.85f;
+// a step up doubles the utilization, it has to stay below this afterwards
+constexpr float GOVERNOR_STEP_UP_UTILIZATION = 0.6f;
+// scene change is the mean absolute temperature change of all pixels over one window
+constexpr uint32_t GOVERNOR_SCENE_WINDOW_MS = 500;
+constexpr float GOVERNOR_DYNAMIC_SCENE_CHANGE = 0.5f;
+constexpr float GOVERNOR_STATIC_SCENE_CHANGE = 0.2f;
+// consecutive updates / scene windows a condition has to hold before the settings change
+constexpr uint32_t GOVERNOR_OVERLOAD_UPDATES = 3;
+constexpr uint32_t GOVERNOR_DYNAMIC_WINDOWS = 2;
+constexpr uint32_t GOVERNOR_STATIC_WINDOWS = 4;
+// updates ignored after a change, the sensor finishes the sub-page that was running with the old settings
+constexpr uint32_t GOVERNOR_SETTLE_UPDATES = 2;
+
+struct GovernorSettings
+{
+    Mlx90640RefreshRate refresh_rate;
+    Mlx90640BitResolution resolution;
+};
+
+enum class GovernorDecision
+{
+    HOLD,
+    SETTLING,           // measurements after a change are not used yet
+    RATE_UP,            // moving scene and enough headroom
+    RATE_DOWN_OVERLOAD, // pipeline falls behind the sensor
+    LOW_NOISE           // static scene, slower and with the static resolution
+};
+
+struct GovernorStats
+{
+    uint32_t updates;
+    uint32_t rate_increases;
+    uint32_t rate_decreases;
+    uint32_t resolution_changes;
+    // apply function refused, retried with the next update
+    uint32_t apply_failures;
+    GovernorDecision last_decision;
+};
+
+// Adapts refresh rate and ADC resolution of the sensor at runtime. Fed once per displayed sub-page with the merged
+// frame and the pipeline time spent on that sub-page, it compares the time with the sub-page period and the frame
+// with the one of the previous scene window:
+//   - the pipeline gets close to the sensor period -> one rate step down
+//   - the scene moves and a doubled rate still leaves headroom -> one rate step up, dynamic resolution
+//   - the scene is static -> step down to the static rate, static resolution (less noise)
+// Thresholds and required repetitions differ between the directions so the settings do not oscillate.
+class MlxRateGovernor
+{
+public:
+    // changes the sensor (and the acquisition timing), false if that is not possible right now
+    using ApplyFunction = std::function<bool(const GovernorSettings &settings)>;
+    using TimestampFunction = std::function<unsigned long()>;
+
+    MlxRateGovernor() = delete;
+    MlxRateGovernor(ApplyFunction apply_func,
+                    TimestampFunction timestamp_func,
+                    GovernorSettings initial_settings,
+                    Mlx90640RefreshRate min_refresh_rate = GOVERNOR_MIN_REFRESH_RATE,
+                    Mlx90640RefreshRate max_refresh_rate = GOVERNOR_MAX_REFRESH_RATE)
+        : _apply_func(apply_func),
+          _timestamp_func(timestamp_func),
+          _settings(initial_settings),
+          _min_refresh_rate(min_refresh_rate),
+          _max_refresh_rate(max_refresh_rate)
+    {
+        assert(_apply_func != nullptr);
+        assert(_timestamp_func != nullptr);
+        assert(_min_refresh_rate <= _max_refresh_rate);
+    }
+
+    // pipeline_us: time spent on this sub-page (calculation, drawing, ...), not the time waiting for the sensor.
+    // units_per_degree: change of the frame values per degree Celsius, e.g. of a relative image
+    GovernorDecision update(const ThermoImage &frame, uint32_t pipeline_us, float units_per_degree = 1.0f)
+    {
+        _stats.updates++;
+        if (_settle_updates > 0) {
+            _settle_updates--;
+            _has_utilization = false;
+            _has_reference = false;
+            return _decide(GovernorDecision::SETTLING);
+        }
+
+        _update_utilization(pipeline_us);
+        _update_scene_change(frame, units_per_degree);
+        _overload_updates = _utilization > GOVERNOR_OVERLOAD_UTILIZATION ? _overload_updates + 1 : 0;
+
+        auto next = _settings;
+        auto decision = GovernorDecision::HOLD;
+        if (_overload_updates >= GOVERNOR_OVERLOAD_UPDATES && _settings.refresh_rate > _min_refresh_rate) {
+            next.refresh_rate = _step(_settings.refresh_rate, -1);
+            decision = GovernorDecision::RATE_DOWN_OVERLOAD;
+        } else if (_dynamic_windows >= GOVERNOR_DYNAMIC_WINDOWS && _settings.refresh_rate < _max_refresh_rate &&
+                   2 * _utilization < GOVERNOR_STEP_UP_UTILIZATION) {
+            next = {_step(_settings.refresh_rate, 1), GOVERNOR_DYNAMIC_RESOLUTION};
+            decision = GovernorDecision::RATE_UP;
+        } else if (_static_windows >= GOVERNOR_STATIC_WINDOWS && _is_above_low_noise()) {
+            auto static_rate = std::max(GOVERNOR_STATIC_REFRESH_RATE, _min_refresh_rate);
+            next = {std::min(_settings.refresh_rate, static_rate), GOVERNOR_STATIC_RESOLUTION};
+            decision = GovernorDecision::LOW_NOISE;
+        }
+        if (decision == GovernorDecision::HOLD) {
+            return _decide(decision);
+        }
+
+        if (!_apply_func(next)) {
+            _stats.apply_failures++;
+            return _decide(GovernorDecision::HOLD);
+        }
+        _stats.rate_increases += next.refresh_rate > _settings.refresh_rate;
+        _stats.rate_decreases += next.refresh_rate < _settings.refresh_rate;
+        _stats.resolution_changes += next.resolution != _settings.resolution;
+        _settings = next;
+        _settle_updates = GOVERNOR_SETTLE_UPDATES;
+        _overload_updates = 0;
+        _dynamic_windows = 0;
+        _static_windows = 0;
+        return _decide(decision);
+    }
+
+    const GovernorSettings &settings() const noexcept { return _settings; }
+    const GovernorStats &stats() const noexcept { return _stats; }
+    // smoothed pipeline time per sub-page period
+    float utilization() const noexcept { return _utilization; }
+    // share of the sub-page period the pipeline leaves unused, negative when it falls behind
+    float headroom() const noexcept { return 1.0f - _utilization; }
+    // mean absolute change per pixel over the last scene window in degree Celsius
+    float scene_change() const noexcept { return _scene_change; }
+
+private:
+    GovernorDecision _decide(GovernorDecision decision) noexcept
+    {
+        _stats.last_decision = decision;
+        return decision;
+    }
+
+    static Mlx90640RefreshRate _step(Mlx90640RefreshRate refresh_rate, int direction) noexcept
+    {
+        return static_cast<Mlx90640RefreshRate>(static_cast<int>(refresh_rate) + direction);
+    }
+
+    bool _is_above_low_noise() const noexcept
+    {
+        auto static_rate = std::max(GOVERNOR_STATIC_REFRESH_RATE, _min_refresh_rate);
+        return _settings.refresh_rate > static_rate || _settings.resolution != GOVERNOR_STATIC_RESOLUTION;
+    }
+
+    void _update_utilization(uint32_t pipeline_us)
+    {
+        float period_us = mlx_utils::convert_refresh_rate_to_ms(_settings.refresh_rate) * 1000.0f;
+        float utilization = pipeline_us / period_us;
+        if (!_has_utilization) {
+            _utilization = utilization;
+            _has_utilization = true;
+            return;
+        }
+        _utilization += GOVERNOR_UTILIZATION_SMOOTHING * (utilization - _utilization);
+    }
+
+    void _update_scene_change(const ThermoImage &frame, float units_per_degree)
+    {
+        auto now = _timestamp_func();
+        if (!_has_reference) {
+            _reference = frame;
+            _reference_time = now;
+            _has_reference = true;
+            return;
+        }
+        if (now - _reference_time < GOVERNOR_SCENE_WINDOW_MS) {
+            return;
+        }
+
+        float change_sum = 0.0f;
+        for (size_t i = 0; i < frame.size(); i++) {
+            change_sum += std::fabs(frame[i] - _reference[i]);
+        }
+        _scene_change = change_sum / (frame.size() * units_per_degree);
+        _reference = frame;
+        _reference_time = now;
+
+        _dynamic_windows = _scene_change > GOVERNOR_DYNAMIC_SCENE_CHANGE ? _dynamic_windows + 1 : 0;
+        _static_windows = _scene_change < GOVERNOR_STATIC_SCENE_CHANGE ? _static_windows + 1 : 0;
+    }
+
+    ApplyFunction _apply_func = nullptr;
+    TimestampFunction _timestamp_func = nullptr;
+    GovernorSettings _settings;
+    Mlx90640RefreshRate _min_refresh_rate;
+    Mlx90640RefreshRate _max_refresh_rate;
+    GovernorStats _stats{};
+
+    uint32_t _settle_updates = 0;
+    bool _has_utilization = false;
+    float _utilization = 0.0f;
+    uint32_t _overload_updates = 0;
+
+    bool _has_reference = false;
+    ThermoImage _reference{};
+    unsigned long _reference_time = 0;
+    float _scene_change = 0.0f;
+    uint32_t _dynamic_windows = 0;
+    uint32_t _static_windows = 0;
+};
+
+} // namespace thermocam
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <stdint.h>
+
+#include "config.h"
+#include "mlx_pixel_layout.h"
+#include "types/mlx_types.h"
+
+namespace thermocam {
+
+// regions an MlxRoiMonitor watches at the same time
+constexpr size_t MLX_MAX_ROI_COUNT = 8;
+
+// Rectangle on the sensor grid in pixels, a point spot is 1 x 1
+struct MlxRoi
+{
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;
+    uint8_t height;
+
+    static constexpr MlxRoi point(uint8_t x, uint8_t y) noexcept { return {x, y, 1, 1}; }
+
+    constexpr bool is_on_sensor() const noexcept
+    {
+        return width > 0 && height > 0 && x + width <= MLX_SENSOR_WIDTH && y + height <= MLX_SENSOR_HEIGHT;
+    }
+
+    constexpr bool contains(size_t pixel_index) const noexcept
+    {
+        auto column = pixel_index % MLX_SENSOR_WIDTH;
+        auto row = pixel_index / MLX_SENSOR_WIDTH;
+        return column >= x && column < x + width && row >= y && row < y + height;
+    }
+};
+
+// Temperatures of the pixels of a region, NaN pixels (and pixels whose sub-page was not calculated yet) left out
+struct MlxRoiStats
+{
+    float min_temp;
+    float max_temp;
+    float average_temp;
+    uint32_t min_temp_index;
+    uint32_t max_temp_index;
+    uint32_t pixel_count;
+};
+
+// Radiometry of a few regions instead of the full frame: per sub-page the engine calculates To only for the pixels
+// inside the active regions (calculate_pixels_to()), then every active region gets its min / max / mean. Regions
+// are added and removed at runtime and may overlap, a shared pixel is calculated once. Like the full frame, the
+// stats combine the latest sub-page with the other half of the previous one. Works with MlxCalibration and
+// MlxFixedPointCalibration, the engine's single-pass mode and offset cache apply as with full sub-pages. Next to the
+// relative-image display the regions take their To from the image of the sub-page instead.
+template <typename Calibration> class MlxRoiMonitor
+{
+public:
+    explicit MlxRoiMonitor(Calibration &calibration) : _calibration(calibration) { _temperatures.fill(NAN); }
+
+    // index of the new region, -1 if it is not on the sensor or all MLX_MAX_ROI_COUNT slots are taken
+    int add(const MlxRoi &roi, bool is_active = true)
+    {
+        if (!roi.is_on_sensor()) {
+            return -1;
+        }
+        for (size_t roi_index = 0; roi_index < _slots.size(); roi_index++) {
+            if (!_slots[roi_index].is_used) {
+                _slots[roi_index] = {roi, true, is_active};
+                _stats[roi_index] = _empty_stats();
+                _is_layout_valid = false;
+                return static_cast<int>(roi_index);
+            }
+        }
+        return -1;
+    }
+
+    // indices out of range (e.g. a failed add() cast to size_t) are ignored here and in the setters and getters below
+    void remove(size_t roi_index)
+    {
+        if (roi_index >= _slots.size()) {
+            return;
+        }
+        _slots[roi_index] = {};
+        _is_layout_valid = false;
+    }
+
+    void clear()
+    {
+        _slots.fill({});
+        _is_layout_valid = false;
+    }
+
+    // inactive regions keep their slot but cost nothing, their stats are not updated
+    void set_active(size_t roi_index, bool is_active)
+    {
+        if (roi_index < _slots.size() && _slots[roi_index].is_used && _slots[roi_index].is_active != is_active) {
+            _slots[roi_index].is_active = is_active;
+            _is_layout_valid = false;
+        }
+    }
+
+    // To of the region pixels of the sub-page, then the stats of every active region
+    void process_subpage(const uint16_t *subpage_frame)
+    {
+        auto context = _calibration.prepare_subpage(subpage_frame);
+        _prepare_layout(context.readout_mode);
+        auto subpage_number = context.subpage_number & 1;
+        _calibration.calculate_pixels_to(subpage_frame, context, _subpage_pixels[subpage_number].data(),
+                                         _subpage_pixel_counts[subpage_number], _temperatures.data());
+        _update_active_stats();
+    }
+
+    // Same for a sub-page the engine already turned into the relative image (calculate_subpage_image()), e.g. for
+    // the display: To only for the region pixels with image_to_temperature()
+    void process_subpage_image(uint8_t subpage_number, Mlx90640PixelReadoutMode readout_mode, const float *image)
+    {
+        _prepare_layout(readout_mode);
+        subpage_number &= 1;
+        for (size_t i = 0; i < _subpage_pixel_counts[subpage_number]; i++) {
+            auto pixel_index = _subpage_pixels[subpage_number][i];
+            _temperatures[pixel_index] = _calibration.image_to_temperature(pixel_index, image[pixel_index]);
+        }
+        _update_active_stats();
+    }
+
+    bool is_used(size_t roi_index) const noexcept { return roi_index < _slots.size() && _slots[roi_index].is_used; }
+    bool is_active(size_t roi_index) const noexcept
+    {
+        return roi_index < _slots.size() && _slots[roi_index].is_active;
+    }
+    // an empty region and empty stats out of range
+    const MlxRoi &roi(size_t roi_index) const noexcept
+    {
+        return roi_index < _slots.size() ? _slots[roi_index].roi : NO_ROI;
+    }
+    const MlxRoiStats &stats(size_t roi_index) const noexcept
+    {
+        return roi_index < _stats.size() ? _stats[roi_index] : NO_STATS;
+    }
+    // pixels calculated per frame, the union of the active regions
+    size_t pixel_count() const noexcept { return _subpage_pixel_counts[0] + _subpage_pixel_counts[1]; }
+
+private:
+    struct Slot
+    {
+        MlxRoi roi;
+        bool is_used;
+        bool is_active;
+    };
+
+    static constexpr MlxRoi NO_ROI{0, 0, 0, 0};
+    static constexpr MlxRoiStats NO_STATS{NAN, NAN, NAN, 0, 0, 0};
+
+    static MlxRoiStats _empty_stats() noexcept { return NO_STATS; }
+
+    void _prepare_layout(Mlx90640PixelReadoutMode readout_mode)
+    {
+        if (!_is_layout_valid || readout_mode != _readout_mode) {
+            _update_layout(readout_mode);
+        }
+    }
+
+    void _update_active_stats()
+    {
+        for (size_t roi_index = 0; roi_index < _slots.size(); roi_index++) {
+            if (_slots[roi_index].is_active) {
+                _update_stats(roi_index);
+            }
+        }
+    }
+
+    // pixel lists of the union of the active regions per sub-page. Pixels new to the union are NaN until their
+    // sub-page was calculated, the others keep their latest To.
+    void _update_layout(Mlx90640PixelReadoutMode readout_mode)
+    {
+        std::bitset<MLX_PIXEL_COUNT> mask;
+        for (const auto &slot : _slots) {
+            if (!slot.is_active) {
+                continue;
+            }
+            for (uint8_t row = slot.roi.y; row < slot.roi.y + slot.roi.height; row++) {
+                for (uint8_t column = slot.roi.x; column < slot.roi.x + slot.roi.width; column++) {
+                    mask.set(row * MLX_SENSOR_WIDTH + column);
+                }
+            }
+        }
+
+        _subpage_pixel_counts = {0, 0};
+        for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+            if (!mask[pixel_index]) {
+                continue;
+            }
+            if (!_mask[pixel_index]) {
+                _temperatures[pixel_index] = NAN;
+            }
+            auto subpage_number = is_pixel_in_subpage(pixel_index, 1, readout_mode) ? 1 : 0;
+            _subpage_pixels[subpage_number][_subpage_pixel_counts[subpage_number]++] =
+                    static_cast<uint16_t>(pixel_index);
+        }
+        if (readout_mode != _readout_mode) {
+            _temperatures.fill(NAN); // the halves of the previous frame belong to the other layout
+        }
+        _mask = mask;
+        _readout_mode = readout_mode;
+        _is_layout_valid = true;
+    }
+
+    void _update_stats(size_t roi_index)
+    {
+        const auto &roi = _slots[roi_index].roi;
+        auto stats = _empty_stats();
+        float sum = 0.0f;
+        for (uint8_t row = roi.y; row < roi.y + roi.height; row++) {
+            for (uint8_t column = roi.x; column < roi.x + roi.width; column++) {
+                uint32_t pixel_index = row * MLX_SENSOR_WIDTH + column;
+                auto temperature = _temperatures[pixel_index];
+                if (std::isnan(temperature)) {
+                    continue;
+                }
+                if (stats.pixel_count == 0 || temperature < stats.min_temp) {
+                    stats.min_temp = temperature;
+                    stats.min_temp_index = pixel_index;
+                }
+                if (stats.pixel_count == 0 || temperature > stats.max_temp) {
+                    stats.max_temp = temperature;
+                    stats.max_temp_index = pixel_index;
+                }
+                sum += temperature;
+                stats.pixel_count++;
+            }
+        }
+        if (stats.pixel_count > 0) {
+            stats.average_temp = sum / stats.pixel_count;
+        }
+        _stats[roi_index] = stats;
+    }
+
+    Calibration &_calibration;
+    std::array<Slot, MLX_MAX_ROI_COUNT> _slots{};
+    std::array<MlxRoiStats, MLX_MAX_ROI_COUNT> _stats{};
+    bool _is_layout_valid = false;
+    Mlx90640PixelReadoutMode _readout_mode = Mlx90640PixelReadoutMode::MLX90640_CHESS;
+    std::bitset<MLX_PIXEL_COUNT> _mask;
+    std::array<SubpagePixelIndices, 2> _subpage_pixels{};
+    std::array<size_t, 2> _subpage_pixel_counts{};
+    // To of the pixels of the union, NaN elsewhere
+    std::array<float, MLX_PIXEL_COUNT> _temperatures{};
+};
+
+} // namespace thermocam
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+
+#include <headers/MLX90640_Transport.h>
+
+#include "config.h"
+#include "mlx_acquisition.h"
+
+namespace thermocam {
+
+constexpr uint16_t MLX_CONTROL_REGISTER_EEPROM_WORD = 0x000C;
+
+constexpr uint16_t MLX_STATUS_OVERWRITE_ENABLE = 0x0010;
+// bits the host can write, the sub-page number is read only
+constexpr uint16_t MLX_STATUS_WRITABLE_MASK = 0x0038;
+constexpr uint16_t MLX_CONTROL_SUBPAGE_REPEAT = 0x0008;
+constexpr uint16_t MLX_CONTROL_SUBPAGE_SELECT_SHIFT = 4;
+constexpr uint16_t MLX_CONTROL_REFRESH_RATE_SHIFT = 7;
+
+// bits per transferred byte: 8 data + ACK/NACK
+constexpr uint32_t I2C_BITS_PER_BYTE = 9;
+// clock cycles of a start, repeated start or stop condition
+constexpr uint32_t I2C_CONDITION_BITS = 1;
+
+struct MlxSimulatorStats
+{
+    uint32_t subpages_measured;
+    // measurements finished while the previous sub-page was not acknowledged yet (new data bit still set),
+    // one of the two sub-pages is lost depending on the overwrite enable bit
+    uint32_t subpages_dropped;
+    uint32_t read_transactions;
+    uint32_t write_transactions;
+    // not acknowledged, injected with inject_bus_errors() or hold_bus()
+    uint32_t failed_transactions;
+    uint32_t bus_bytes;
+    uint64_t bus_busy_us;
+};
+
+// Register-level model of an MLX90640 for native builds, plugged into Adafruit_MLX90640::begin(MLX90640_Transport *).
+// Serves the EEPROM (0x2400), RAM (0x0400), status (0x8000) and control register 1 (0x800D). The sensor measures one
+// sub-page per refresh period of a virtual clock: the pixels of the sub-page (chess or interleaved pattern) and the
+// auxiliary data are copied from a template frame into the RAM, the sub-page number is updated and the new data bit is
+// set. Every bus transaction advances the virtual clock by its duration at the configured I2C clock, the measurement
+// keeps running meanwhile so RAM can be overwritten in the middle of a transfer like on the real device.
+// The Vdd word follows the ADC resolution of control register 1, the pixel data is not rescaled.
+// Not modeled: data hold, step mode and EEPROM writes.
+class MlxSimulator : public MLX90640_Transport
+{
+public:
+    // defaults to the Melexis example data, see mlx_reference_data.h
+    MlxSimulator();
+    MlxSimulator(const std::array<uint16_t, MLX_EEPROM_WORDS> &eeprom,
+                 const std::array<MlxSubpageFrame, 2> &subpage_templates);
+
+    int read(uint16_t start_address, uint16_t word_count, uint16_t *data) override;
+    int write(uint16_t address, uint16_t value) override;
+
+    // Time the host spends outside of bus transactions, the sensor keeps measuring
+    void advance_us(uint64_t duration_us);
+    void advance_ms(uint32_t duration_ms) { advance_us(duration_ms * 1000ull); }
+
+    uint64_t now_us() const noexcept { return _now_us; }
+    unsigned long now_ms() const noexcept { return static_cast<unsigned long>(_now_us / 1000); }
+
+    void set_i2c_clock_hz(uint32_t i2c_clock_hz) noexcept { _i2c_clock_hz = i2c_clock_hz; }
+    // Longest read per bus transaction, longer reads are split like the BusIO transport does (0 = unlimited)
+    void set_max_read_words(uint16_t max_read_words) noexcept { _max_read_words = max_read_words; }
+    // Raw ADC counts added to a pixel on top of the template, e.g. to put a hot object into the scene
+    void set_pixel_offset(size_t pixel_index, int16_t raw_offset) { _pixel_offsets[pixel_index] = raw_offset; }
+    // Fault injection: the next writes are acknowledged but the register keeps its value
+    void ignore_next_writes(uint32_t write_count) noexcept { _ignored_writes = write_count; }
+    // Fault injection: the next transactions are not acknowledged (e.g. a glitch on marginal wiring)
+    void inject_bus_errors(uint32_t transaction_count) noexcept { _failing_transactions = transaction_count; }
+    // Fault injection: no transaction is acknowledged until release_bus(), like a slave holding SDA low
+    void hold_bus() noexcept { _is_bus_held = true; }
+    void release_bus() noexcept { _is_bus_held = false; }
+
+    uint32_t subpage_period_us() const noexcept;
+    uint32_t i2c_clock_hz() const noexcept { return _i2c_clock_hz; }
+    uint16_t status_register() const noexcept { return _status_register; }
+    uint16_t control_register() const noexcept { return _control_register; }
+    const MlxSimulatorStats &stats() const noexcept { return _stats; }
+    void reset_stats() noexcept { _stats = {}; }
+
+private:
+    uint64_t _bus_time_us(uint32_t bits) const noexcept;
+    void _advance_to(uint64_t time_us);
+    void _measure_subpage();
+    bool _read_word(uint16_t address, uint16_t &value) const;
+    bool _fail_transaction();
+
+    std::array<uint16_t, MLX_EEPROM_WORDS> _eeprom;
+    std::array<MlxSubpageFrame, 2> _subpage_templates;
+    std::array<uint16_t, MLX_RAM_WORDS> _ram{};
+    std::array<int16_t, MLX_SENSOR_WIDTH * MLX_SENSOR_HEIGHT> _pixel_offsets{};
+
+    uint16_t _status_register = 0;
+    uint16_t _control_register;
+    uint16_t _next_subpage = 0;
+    uint32_t _ignored_writes = 0;
+    uint32_t _failing_transactions = 0;
+    bool _is_bus_held = false;
+
+    uint32_t _i2c_clock_hz = I2C_FREQUENCY_IN_HZ;
+    uint16_t _max_read_words = 0;
+    uint64_t _now_us = 0;
+    uint64_t _next_measurement_us;
+    MlxSimulatorStats _stats{};
+};
+
+} // namespace thermocam
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <stdint.h>
+
+#include "buffer_pool.h"
+#include "config.h"
+#include "mlx_acquisition.h"
+#include "mlx_pixel_layout.h"
+#include "spsc_ring.h"
+#include "types/common_types.h"
+#include "types/container_types.h"
+#include "types/mlx_types.h"
+
+namespace thermocam {
+
+struct ComputedSubpage
+{
+    uint8_t subpage_number;
+    Mlx90640PixelReadoutMode readout_mode;
+    uint32_t sequence_number;
+    // the sub-page was lost (bus errors), temperatures are not written and a merged frame keeps the last good values
+    // of this half
+    bool is_substitute;
+    // only the pixels belonging to this sub-page are valid
+    const ThermoImage *temperatures;
+    // of the temperatures as the calculate function accumulated them, no pixels when it does not
+    SubpageStats stats;
+};
+
+// set in the sub-page number word of a raw buffer that stands in for a lost sub-page
+constexpr uint16_t MLX_SUBPAGE_MISSING_FLAG = 0x8000;
+
+// Overwrite the pixels of the sub-page in frame, the pixels of the other sub-page keep their previous values
+inline void merge_subpage_into_frame(const ComputedSubpage &subpage, ThermoImage &frame)
+{
+    assert(subpage.temperatures != nullptr);
+    if (subpage.is_substitute) {
+        return;
+    }
+
+    const auto &temperatures = *subpage.temperatures;
+    for (auto pixel_index : subpage_pixel_indices(subpage.subpage_number, subpage.readout_mode)) {
+        frame[pixel_index] = temperatures[pixel_index];
+    }
+}
+
+using RawSubpagePool = BufferPool<MlxSubpageFrame, RAW_SUBPAGE_BUFFER_COUNT>;
+using TemperaturePool = BufferPool<ThermoImage, TEMPERATURE_BUFFER_COUNT>;
+
+// Sub-page pipeline on top of MlxSubpageAcquisition. Every sub-page is handed out as soon as its temperatures are
+// calculated instead of waiting for the second half of the frame like getFrame() does.
+// Three stages connected by buffer pools, each stage may run in its own thread or task:
+//   acquire()        reads raw sub-pages straight into RawSubpagePool buffers
+//   process()        calculates the temperatures of a raw sub-page into a TemperaturePool buffer
+//   next()/release() hands the calculated sub-pages to the caller and takes the buffers back
+// A sub-page the acquisition gives up on is replaced by a substitute of the expected sub-page number, so the consumer
+// keeps its cadence and shows the last good values of that half instead of stalling.
+class MlxSubpageStream
+{
+public:
+    // calculates the temperatures of one raw sub-page, e.g. Adafruit_MLX90640::calculateSubpage
+    using CalculateFunction = std::function<void(uint16_t *subpage_frame, float *temperatures)>;
+    // same with the stats of the temperatures accumulated on the way (the stats sink of the calibration engines),
+    // handed out in ComputedSubpage::stats
+    using CalculateWithStatsFunction =
+            std::function<void(uint16_t *subpage_frame, float *temperatures, SubpageStats &stats)>;
+    // sees every raw sub-page read from the sensor, dropped ones included, in the acquisition stage
+    // (e.g. MlxCaptureWriter::record), must not block
+    using RawSubpageFunction = std::function<void(const MlxSubpageFrame &subpage_frame, uint32_t timestamp_ms)>;
+
+    MlxSubpageStream() = delete;
+    MlxSubpageStream(MlxSubpageAcquisition &acquisition, CalculateWithStatsFunction calculate_func,
+                     RawSubpageFunction raw_subpage_func = nullptr)
+        : _acquisition(acquisition),
+          _raw_subpage_func(raw_subpage_func),
+          _calculate_func(calculate_func)
+    {
+        assert(_calculate_func != nullptr);
+    }
+    MlxSubpageStream(MlxSubpageAcquisition &acquisition, CalculateFunction calculate_func,
+                     RawSubpageFunction raw_subpage_func = nullptr)
+        : MlxSubpageStream(
+                  acquisition,
+                  [calculate_func](uint16_t *subpage_frame, float *temperatures, SubpageStats &) {
+                      calculate_func(subpage_frame, temperatures);
+                  },
+                  raw_subpage_func)
+    {
+        assert(calculate_func != nullptr);
+    }
+
+    // Acquisition stage, non-blocking. Without a free raw buffer the sub-page is still read to keep the sensor
+    // timing but dropped.
+    void acquire()
+    {
+        if (_acquisition.state() == AcquisitionState::IDLE) {
+            _begin_subpage();
+        }
+        auto state = _acquisition.poll();
+        if (state == AcquisitionState::IDLE) {
+            _substitute_lost_subpage();
+            return;
+        }
+        if (state != AcquisitionState::READY) {
+            return;
+        }
+        _last_subpage_number = _acquisition.subpage_frame()[MLX_SUBPAGE_NUMBER_WORD];
+        _last_control_register = _acquisition.subpage_frame()[MLX_CONTROL_REGISTER_WORD];
+        _has_subpage = true;
+        if (_raw_subpage_func != nullptr) {
+            _raw_subpage_func(_acquisition.subpage_frame(), _acquisition.last_ready_time());
+        }
+
+        if (_raw_subpage != nullptr) {
+            _raw_pool.publish(_raw_subpage);
+            _raw_subpage = nullptr;
+        } else {
+            _dropped_subpages.fetch_add(1, std::memory_order_relaxed);
+        }
+        _acquisition.release_subpage();
+        _begin_subpage(); // sensor is already integrating the next one
+    }
+
+    // Processing stage. Returns true when a raw sub-page was calculated. Waits with the raw sub-pages (and
+    // eventually starves the acquisition stage) while the caller holds all temperature buffers.
+    bool process()
+    {
+        if (!_raw_pool.has_ready()) {
+            return false;
+        }
+        auto *temperatures = _temperature_pool.acquire();
+        if (temperatures == nullptr) {
+            return false;
+        }
+
+        auto *raw_subpage = _raw_pool.consume();
+        bool is_substitute = ((*raw_subpage)[MLX_SUBPAGE_NUMBER_WORD] & MLX_SUBPAGE_MISSING_FLAG) != 0;
+        SubpageStats stats{};
+        if (!is_substitute) {
+            _calculate_func(raw_subpage->data(), temperatures->data(), stats);
+        }
+
+        ComputedSubpage computed{
+                .subpage_number = static_cast<uint8_t>((*raw_subpage)[MLX_SUBPAGE_NUMBER_WORD] & MLX_STATUS_SUBPAGE_MASK),
+                .readout_mode = ((*raw_subpage)[MLX_CONTROL_REGISTER_WORD] & MLX_CONTROL_CHESS_MODE) != 0
+                                        ? Mlx90640PixelReadoutMode::MLX90640_CHESS
+                                        : Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED,
+                .sequence_number = _sequence_number++,
+                .is_substitute = is_substitute,
+                .temperatures = temperatures,
+                .stats = stats};
+        _raw_pool.release(raw_subpage);
+
+        // the metadata travels in a ring of its own, in the same order as the temperature buffers
+        [[maybe_unused]] bool pushed = _computed.push(computed);
+        assert(pushed);
+        _temperature_pool.publish(temperatures);
+        return true;
+    }
+
+    // Non-blocking. Returns true and fills subpage when a calculated sub-page is available.
+    // subpage.temperatures stays valid until release(subpage).
+    bool next(ComputedSubpage &subpage)
+    {
+        auto *temperatures = _temperature_pool.consume();
+        if (temperatures == nullptr) {
+            return false;
+        }
+        [[maybe_unused]] bool popped = _computed.pop(subpage);
+        assert(popped && subpage.temperatures == temperatures);
+        if (!subpage.is_substitute) {
+            _received_subpages |= 1 << subpage.subpage_number;
+        }
+        return true;
+    }
+
+    void release(const ComputedSubpage &subpage)
+    {
+        _temperature_pool.release(const_cast<ThermoImage *>(subpage.temperatures));
+    }
+
+    // true once both sub-pages were received, i.e. every pixel of a merged frame is valid
+    bool has_full_frame() const noexcept { return _received_subpages == 0b11; }
+    int last_error() const noexcept { return _acquisition.last_error(); }
+    uint32_t dropped_subpages() const noexcept { return _dropped_subpages.load(std::memory_order_relaxed); }
+    // sub-pages lost to bus errors, replaced by a substitute when a raw buffer was free
+    uint32_t lost_subpages() const noexcept { return _lost_subpages.load(std::memory_order_relaxed); }
+    BufferPoolStats raw_pool_stats() const noexcept { return _raw_pool.stats(); }
+    BufferPoolStats temperature_pool_stats() const noexcept { return _temperature_pool.stats(); }
+
+private:
+    void _begin_subpage()
+    {
+        if (_raw_subpage == nullptr) {
+            _raw_subpage = _raw_pool.acquire();
+        }
+        if (_raw_subpage != nullptr) {
+            _acquisition.begin_subpage(*_raw_subpage);
+        } else {
+            _acquisition.begin_subpage();
+        }
+    }
+
+    // The acquisition gave up on a sub-page. The sensor alternates the sub-pages, so the lost one is most likely the
+    // counterpart of the last one read. The raw buffer goes through the pipeline with the missing flag set and keeps
+    // the control register of the last good sub-page for the readout mode.
+    void _substitute_lost_subpage()
+    {
+        _lost_subpages.fetch_add(1, std::memory_order_relaxed);
+        if (!_has_subpage || _raw_subpage == nullptr) {
+            return; // nothing to re-use yet or no buffer, the next sub-page is requested with the next call
+        }
+        (*_raw_subpage)[MLX_CONTROL_REGISTER_WORD] = _last_control_register;
+        _last_subpage_number ^= 1;
+        (*_raw_subpage)[MLX_SUBPAGE_NUMBER_WORD] = MLX_SUBPAGE_MISSING_FLAG | _last_subpage_number;
+        _raw_pool.publish(_raw_subpage);
+        _raw_subpage = nullptr;
+    }
+
+    // acquisition stage
+    MlxSubpageAcquisition &_acquisition;
+    MlxSubpageFrame *_raw_subpage = nullptr;
+    RawSubpageFunction _raw_subpage_func = nullptr;
+    std::atomic<uint32_t> _dropped_subpages{0};
+    std::atomic<uint32_t> _lost_subpages{0};
+    bool _has_subpage = false;
+    uint16_t _last_subpage_number = 0;
+    uint16_t _last_control_register = 0;
+
+    // processing stage
+    CalculateWithStatsFunction _calculate_func = nullptr;
+    uint32_t _sequence_number = 0;
+
+    // consumer
+    uint8_t _received_subpages = 0;
+
+    RawSubpagePool _raw_pool;
+    TemperaturePool _temperature_pool;
+    SpscRing<ComputedSubpage, TEMPERATURE_BUFFER_COUNT> _computed;
+};
+
+} // namespace thermocam
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <functional>
+#include <stdint.h>
+
+#include <headers/MLX90640_Transport.h>
+
+namespace thermocam {
+
+// largest single transaction: the whole RAM (one sub-page) or the whole EEPROM
+constexpr uint16_t MLX_TRANSPORT_MAX_READ_WORDS = 832;
+
+enum class TransferState
+{
+    IDLE,   // nothing submitted yet
+    BUSY,   // transaction on the bus
+    DONE,   // data copied to the destination, completion function called
+    FAILED  // bus error, last_error() holds the code
+};
+
+struct TransportStats
+{
+    uint32_t transactions;
+    uint32_t failed_transactions;
+    uint64_t bytes;
+    // from submit to completion, includes the time the bus waits for the backend to pick the request up
+    uint64_t busy_us;
+
+    [[nodiscard]] uint32_t bytes_per_second() const noexcept
+    {
+        return busy_us > 0 ? static_cast<uint32_t>(bytes * 1'000'000 / busy_us) : 0;
+    }
+};
+
+// Big endian words as they come over the bus to host order, fused with the copy out of the transfer buffer
+inline void copy_words_from_wire(const uint8_t *wire_bytes, uint16_t word_count, uint16_t *data) noexcept
+{
+    for (uint16_t word_index = 0; word_index < word_count; word_index++) {
+        data[word_index] = static_cast<uint16_t>(wire_bytes[2 * word_index] << 8) | wire_bytes[2 * word_index + 1];
+    }
+}
+
+// Submit/complete model for the MLX90640 register reads. A read is submitted as one transaction (no chunking) into
+// a transfer buffer owned by the transport. The caller keeps working and calls poll(), the byte order conversion and
+// the copy into the destination only happen on completion.
+// The blocking MLX90640_Transport::read used by Adafruit_MLX90640 is implemented on top, so one transport serves both.
+class AsyncMlxTransport : public MLX90640_Transport
+{
+public:
+    using CompletionFunction = std::function<void(int error)>;
+    using TimestampFunction = std::function<unsigned long()>;
+
+    AsyncMlxTransport() = delete;
+    // timestamps in microseconds, only used for the statistics
+    explicit AsyncMlxTransport(TimestampFunction timestamp_func)
+        : _timestamp_func(timestamp_func)
+    {
+        assert(_timestamp_func != nullptr);
+    }
+
+    int read(uint16_t start_address, uint16_t word_count, uint16_t *data) override
+    {
+        if (!submit_read(start_address, word_count, data)) {
+            return -1;
+        }
+        while (poll() == TransferState::BUSY) {
+            _wait_for_transfer();
+        }
+        return _last_error;
+    }
+
+    // Returns false if a transaction is still in flight or the read does not fit into one transaction.
+    // data is written on completion only. on_complete is called from poll().
+    bool submit_read(uint16_t start_address, uint16_t word_count, uint16_t *data,
+                     CompletionFunction on_complete = nullptr)
+    {
+        if (_state == TransferState::BUSY || word_count > MLX_TRANSPORT_MAX_READ_WORDS) {
+            return false;
+        }
+
+        _data = data;
+        _word_count = word_count;
+        _on_complete = on_complete;
+        _submit_time = _timestamp_func();
+        _state = TransferState::BUSY;
+        if (!_start_transfer(start_address, word_count, _wire_bytes.data())) {
+            _complete(-1);
+        }
+        return true;
+    }
+
+    // Non-blocking, finishes the transaction once the backend reports it done
+    TransferState poll()
+    {
+        int error = 0;
+        if (_state == TransferState::BUSY && _is_transfer_finished(error)) {
+            _complete(error);
+        }
+        return _state;
+    }
+
+    bool is_busy() const noexcept { return _state == TransferState::BUSY; }
+    TransferState state() const noexcept { return _state; }
+    int last_error() const noexcept { return _last_error; }
+    const TransportStats &stats() const noexcept { return _stats; }
+    void reset_stats() noexcept { _stats = {}; }
+
+protected:
+    // Put the read on the bus, the backend fills wire_bytes with the bytes in bus order (big endian words)
+    virtual bool _start_transfer(uint16_t start_address, uint16_t word_count, uint8_t *wire_bytes) = 0;
+    // true once wire_bytes is complete or the transaction failed, error is 0 on success
+    virtual bool _is_transfer_finished(int &error) = 0;
+    // called between polls of a blocking read, backends can sleep until the transaction is done
+    virtual void _wait_for_transfer() {}
+
+private:
+    void _complete(int error)
+    {
+        if (error == 0) {
+            copy_words_from_wire(_wire_bytes.data(), _word_count, _data);
+            _stats.bytes += 2 * _word_count;
+        } else {
+            _stats.failed_transactions++;
+        }
+        _stats.transactions++;
+        _stats.busy_us += _timestamp_func() - _submit_time;
+
+        _last_error = error;
+        _state = error == 0 ? TransferState::DONE : TransferState::FAILED;
+        if (_on_complete != nullptr) {
+            _on_complete(error);
+        }
+    }
+
+    TimestampFunction _timestamp_func = nullptr;
+    CompletionFunction _on_complete = nullptr;
+    TransferState _state = TransferState::IDLE;
+    int _last_error = 0;
+    uint16_t *_data = nullptr;
+    uint16_t _word_count = 0;
+    unsigned long _submit_time = 0;
+    TransportStats _stats{};
+    std::array<uint8_t, 2 * MLX_TRANSPORT_MAX_READ_WORDS> _wire_bytes{};
+};
+
+} // namespace thermocam
@@ -1,14 +1,24 @@
 #pragma once
 
 #include <Adafruit_MLX90640.h>
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <string>
 
+#include "algorithms.h"
 #include "color.h"
 #include "types/common_types.h"
 #include "types/container_types.h"
 
 namespace thermocam::mlx_utils {
 
-std::string get_serial_number(Adafruit_MLX90640 &mlx)
+// spot of the center temperature
+constexpr size_t CENTER_PIXEL_INDEX = (MLX_SENSOR_HEIGHT / 2) * MLX_SENSOR_WIDTH + MLX_SENSOR_WIDTH / 2;
+
+inline std::string get_serial_number(Adafruit_MLX90640 &mlx)
 {
     std::stringstream ss;
     ss << std::hex << std::setfill('0') << std::setw(4) << mlx.serialNumber[0] << '-' 
@@ -17,7 +27,7 @@ std::string get_serial_number(Adafruit_MLX90640 &mlx)
     return ss.str();
 }
 
-void update_thermo_image_stats_from_frame(ThermoImage &raw_frame, ThermoImageStats &tis)
+inline void update_thermo_image_stats_from_frame(ThermoImage &raw_frame, ThermoImageStats &tis)
 {
     tis.average_temp = std::accumulate(raw_frame.begin(), raw_frame.end(), 0.0f) / raw_frame.size();
     auto [min_temp_frame, max_temp_frame] = std::minmax_element(raw_frame.begin(), raw_frame.end());
@@ -25,9 +35,51 @@ void update_thermo_image_stats_from_frame(ThermoImage &raw_frame, ThermoImageSta
     tis.max_temp_index = std::distance(raw_frame.begin(), max_temp_frame);
     tis.min_temp = *min_temp_frame;
     tis.max_temp = *max_temp_frame;
+    tis.center_temp = raw_frame[CENTER_PIXEL_INDEX];
+}
+
+// Same stats from the sums and extremes of the two sub-pages of the frame, accumulated by the stats sink of the
+// calibration engines: O(1) instead of two passes over the frame. Only the center pixel is read from raw_frame.
+inline void update_thermo_image_stats_from_subpages(const std::array<SubpageStats, 2> &subpage_stats,
+                                                    const ThermoImage &raw_frame,
+                                                    ThermoImageStats &tis)
+{
+    const auto &[first, second] = subpage_stats;
+    tis.average_temp = (first.sum + second.sum) / (first.pixel_count + second.pixel_count);
+    // ties to the lower index for the min and to the higher one for the max, like std::minmax_element
+    auto is_min_first = first.min_temp < second.min_temp ||
+                        (first.min_temp == second.min_temp && first.min_temp_index < second.min_temp_index);
+    const auto &min_stats = is_min_first ? first : second;
+    tis.min_temp = min_stats.min_temp;
+    tis.min_temp_index = min_stats.min_temp_index;
+    auto is_max_first = first.max_temp > second.max_temp ||
+                        (first.max_temp == second.max_temp && first.max_temp_index > second.max_temp_index);
+    const auto &max_stats = is_max_first ? first : second;
+    tis.max_temp = max_stats.max_temp;
+    tis.max_temp_index = max_stats.max_temp_index;
+    tis.center_temp = raw_frame[CENTER_PIXEL_INDEX];
+}
+
+// Same stats from a relative image (calculate_image() of the calibration engines), which rises with the temperature
+// for every pixel alike: the extremes are found in the image and only the reported pixels are converted by
+// image_to_temperature(pixel_index, image). The average is the temperature of the mean image, a little above the mean
+// temperature for scenes with a large spread.
+template <typename ImageToTemperature>
+void update_thermo_image_stats_from_image(const ThermoImage &image_frame,
+                                          ThermoImageStats &tis,
+                                          ImageToTemperature image_to_temperature)
+{
+    auto average_image = std::accumulate(image_frame.begin(), image_frame.end(), 0.0f) / image_frame.size();
+    auto [min_image, max_image] = std::minmax_element(image_frame.begin(), image_frame.end());
+    tis.min_temp_index = std::distance(image_frame.begin(), min_image);
+    tis.max_temp_index = std::distance(image_frame.begin(), max_image);
+    tis.min_temp = image_to_temperature(tis.min_temp_index, *min_image);
+    tis.max_temp = image_to_temperature(tis.max_temp_index, *max_image);
+    tis.center_temp = image_to_temperature(CENTER_PIXEL_INDEX, image_frame[CENTER_PIXEL_INDEX]);
+    tis.average_temp = image_to_temperature(CENTER_PIXEL_INDEX, average_image);
 }
 
-void convert_raw_temp_to_color(ThermoImage &raw_frame, RGBThermoImage &rgb_frame, ThermoDisplaySettings &tds)
+inline void convert_raw_temp_to_color(const ThermoImage &raw_frame, RGBThermoImage &rgb_frame, ThermoDisplaySettings &tds)
 {
     size_t rgb_array_index = 0;
     for (const auto &temp_at_pixel : raw_frame) {
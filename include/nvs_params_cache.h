@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Preferences.h>
+
+#include "mlx_params_cache.h"
+
+namespace thermocam {
+
+// Cache entry in the NVS partition, header and parameters are two blobs of one namespace
+class NvsParamsCache : public MlxParamsCache
+{
+public:
+    explicit NvsParamsCache(const char *nvs_namespace = "mlx90640")
+        : _nvs_namespace(nvs_namespace)
+    {
+    }
+
+protected:
+    bool _read_header(ParamsCacheHeader &header) override { return _read_blob("header", &header, sizeof(header)); }
+
+    bool _read_params(paramsMLX90640 &params) override { return _read_blob("params", &params, sizeof(params)); }
+
+    bool _write(const ParamsCacheHeader &header, const paramsMLX90640 &params) override
+    {
+        Preferences preferences;
+        if (!preferences.begin(_nvs_namespace, false)) {
+            return false;
+        }
+        // parameters first, an interrupted write leaves a header that does not match them
+        bool written = preferences.putBytes("params", &params, sizeof(params)) == sizeof(params) &&
+                       preferences.putBytes("header", &header, sizeof(header)) == sizeof(header);
+        preferences.end();
+        return written;
+    }
+
+private:
+    bool _read_blob(const char *key, void *data, size_t size)
+    {
+        Preferences preferences;
+        if (!preferences.begin(_nvs_namespace, true)) {
+            return false; // namespace does not exist before the first store
+        }
+        bool read = preferences.getBytesLength(key) == size && preferences.getBytes(key, data, size) == size;
+        preferences.end();
+        return read;
+    }
+
+    const char *_nvs_namespace;
+};
+
+} // namespace thermocam
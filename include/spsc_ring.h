@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <stddef.h>
+
+namespace thermocam {
+
+// Lock-free single producer / single consumer queue. push() may only be called from one thread (or task) and pop()
+// from one other, no locks and no allocation. One slot stays empty to tell a full ring from an empty one.
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity > 0);
+
+public:
+    // producer side, false if the ring is full
+    bool push(const T &value)
+    {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        auto next_tail = _increment(tail);
+        if (next_tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        _slots[tail] = value;
+        _tail.store(next_tail, std::memory_order_release); // publishes the slot content
+        return true;
+    }
+
+    // consumer side, false if the ring is empty
+    bool pop(T &value)
+    {
+        auto head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = _slots[head];
+        _head.store(_increment(head), std::memory_order_release); // hands the slot back to the producer
+        return true;
+    }
+
+    // exact only when called from one of the two sides while the other one is idle
+    [[nodiscard]] size_t size() const noexcept
+    {
+        auto head = _head.load(std::memory_order_acquire);
+        auto tail = _tail.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : SLOT_COUNT - head + tail;
+    }
+
+    [[nodiscard]] constexpr size_t capacity() const noexcept { return Capacity; }
+
+private:
+    static constexpr size_t SLOT_COUNT = Capacity + 1;
+
+    static constexpr size_t _increment(size_t index) noexcept { return index + 1 == SLOT_COUNT ? 0 : index + 1; }
+
+    std::array<T, SLOT_COUNT> _slots{};
+    std::atomic<size_t> _head{0}; // written by the consumer
+    std::atomic<size_t> _tail{0}; // written by the producer
+};
+
+} // namespace thermocam
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types/container_types.h"
+
+namespace thermocam {
+
+// object temperature range of the MLX90640 in bins of a quarter degree, about 2.7 kB of counts
+constexpr float TEMPERATURE_HISTOGRAM_MIN_TEMP = -40.0f;
+constexpr float TEMPERATURE_HISTOGRAM_BIN_WIDTH = 0.25f;
+constexpr size_t TEMPERATURE_HISTOGRAM_BIN_COUNT = 1360;
+
+// Fixed-bin histogram of the temperatures of a frame: one pass to count, percentiles, median and mode from a walk
+// over the bins, no sorting and no allocation. Values outside the range count in the first / last bin, NaN is left
+// out. Percentiles are interpolated within their bin, so they are off by less than a bin width.
+class TemperatureHistogram
+{
+public:
+    void clear() noexcept
+    {
+        _counts.fill(0);
+        _count = 0;
+    }
+
+    void add(float temperature) noexcept
+    {
+        if (std::isnan(temperature)) {
+            return;
+        }
+        auto position = (temperature - TEMPERATURE_HISTOGRAM_MIN_TEMP) * (1.0f / TEMPERATURE_HISTOGRAM_BIN_WIDTH);
+        auto bin = static_cast<size_t>(std::clamp(position, 0.0f, TEMPERATURE_HISTOGRAM_BIN_COUNT - 1.0f));
+        _counts[bin]++;
+        _count++;
+    }
+
+    void update_from_frame(const ThermoImage &frame) noexcept
+    {
+        clear();
+        for (auto temperature : frame) {
+            add(temperature);
+        }
+    }
+
+    // temperature below which the fraction (0 .. 1) of the values lies, NaN without values
+    float percentile(float fraction) const noexcept
+    {
+        if (_count == 0) {
+            return NAN;
+        }
+        auto target = std::clamp(fraction, 0.0f, 1.0f) * _count;
+        uint32_t below = 0;
+        size_t bin = 0;
+        while (bin < _counts.size() - 1 && (_counts[bin] == 0 || below + _counts[bin] < target)) {
+            below += _counts[bin++];
+        }
+        auto within_bin = std::min((target - below) / _counts[bin], 1.0f);
+        return _bin_start(bin) + within_bin * TEMPERATURE_HISTOGRAM_BIN_WIDTH;
+    }
+
+    float median() const noexcept { return percentile(0.5f); }
+
+    // center of the fullest bin, the lowest one of equals. NaN without values.
+    float mode() const noexcept
+    {
+        if (_count == 0) {
+            return NAN;
+        }
+        auto fullest = std::max_element(_counts.begin(), _counts.end()) - _counts.begin();
+        return _bin_start(fullest) + 0.5f * TEMPERATURE_HISTOGRAM_BIN_WIDTH;
+    }
+
+    uint32_t count() const noexcept { return _count; }
+    const std::array<uint16_t, TEMPERATURE_HISTOGRAM_BIN_COUNT> &counts() const noexcept { return _counts; }
+
+private:
+    static float _bin_start(size_t bin) noexcept
+    {
+        return TEMPERATURE_HISTOGRAM_MIN_TEMP + bin * TEMPERATURE_HISTOGRAM_BIN_WIDTH;
+    }
+
+    std::array<uint16_t, TEMPERATURE_HISTOGRAM_BIN_COUNT> _counts{};
+    uint32_t _count = 0;
+};
+
+} // namespace thermocam
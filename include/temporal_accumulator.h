@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types/container_types.h"
+
+namespace thermocam {
+
+// blocks of the windowed mean, the memory it needs in frames
+constexpr size_t TEMPORAL_WINDOW_BLOCKS = 4;
+
+// Per-pixel statistics over time of the frames passed to update(), O(1) per pixel and frame, without keeping the
+// frames themselves. The windowed mean sums its frames in TEMPORAL_WINDOW_BLOCKS blocks, so it needs that many frames
+// of memory for any window and covers the latest window_frames frames less up to one block. The min / max holds
+// move back towards the current frame by hold_decay C per frame, 0 holds them until reset_holds(). NaN values are
+// left out of the mean and the holds and carried through the windowed mean until they leave the window.
+class TemporalAccumulator
+{
+public:
+    // smoothing: weight of the latest frame in the exponential mean
+    explicit TemporalAccumulator(float smoothing = 0.1f, uint32_t window_frames = 32, float hold_decay = 0.0f)
+        : _smoothing(smoothing),
+          _block_frames(std::max<uint32_t>(1, (window_frames + TEMPORAL_WINDOW_BLOCKS - 1) / TEMPORAL_WINDOW_BLOCKS)),
+          _hold_decay(hold_decay)
+    {
+        reset();
+    }
+
+    void update(const ThermoImage &frame)
+    {
+        auto &block = _blocks[_block_index];
+        float window_weight = 1.0f / (_window_frame_count + 1);
+        for (size_t pixel_index = 0; pixel_index < frame.size(); pixel_index++) {
+            auto temperature = frame[pixel_index];
+            block[pixel_index] += temperature;
+            _windowed_mean[pixel_index] += (temperature - _windowed_mean[pixel_index]) * window_weight;
+            if (std::isnan(temperature)) {
+                continue;
+            }
+            auto &mean = _mean[pixel_index];
+            mean = std::isnan(mean) ? temperature : mean + _smoothing * (temperature - mean);
+            // NaN holds (after a reset) take the value, the comparisons are false
+            auto &min_hold = _min_hold[pixel_index];
+            min_hold = !(temperature >= min_hold + _hold_decay) ? temperature : min_hold + _hold_decay;
+            auto &max_hold = _max_hold[pixel_index];
+            max_hold = !(temperature <= max_hold - _hold_decay) ? temperature : max_hold - _hold_decay;
+        }
+        _frame_count++;
+        _window_frame_count++;
+        if (++_block_frame_counts[_block_index] == _block_frames) {
+            _next_block();
+        }
+    }
+
+    // starts all statistics over with the next frame
+    void reset()
+    {
+        _mean.fill(NAN);
+        _windowed_mean.fill(0.0f);
+        for (auto &block : _blocks) {
+            block.fill(0.0f);
+        }
+        _block_frame_counts.fill(0);
+        _block_index = 0;
+        _window_frame_count = 0;
+        _frame_count = 0;
+        reset_holds();
+    }
+
+    // peak-hold reset, the min / max holds start over with the next frame
+    void reset_holds()
+    {
+        _min_hold.fill(NAN);
+        _max_hold.fill(NAN);
+    }
+
+    const ThermoImage &mean() const noexcept { return _mean; }
+    const ThermoImage &windowed_mean() const noexcept { return _windowed_mean; }
+    const ThermoImage &min_hold() const noexcept { return _min_hold; }
+    const ThermoImage &max_hold() const noexcept { return _max_hold; }
+    // the frame to show for the view, live for TemporalView::LIVE
+    const ThermoImage &view(TemporalView view, const ThermoImage &live) const noexcept
+    {
+        switch (view) {
+        case TemporalView::MEAN:
+            return _mean;
+        case TemporalView::WINDOWED_MEAN:
+            return _windowed_mean;
+        case TemporalView::MIN_HOLD:
+            return _min_hold;
+        case TemporalView::MAX_HOLD:
+            return _max_hold;
+        default:
+            return live;
+        }
+    }
+    uint32_t frame_count() const noexcept { return _frame_count; }
+    // frames in the windowed mean right now
+    uint32_t window_frame_count() const noexcept { return _window_frame_count; }
+
+private:
+    // the oldest block leaves the window and takes the next frames, the mean is summed up again from the blocks
+    // left so the running updates do not drift
+    void _next_block()
+    {
+        _block_index = (_block_index + 1) % TEMPORAL_WINDOW_BLOCKS;
+        auto &oldest = _blocks[_block_index];
+        _window_frame_count -= _block_frame_counts[_block_index];
+        _block_frame_counts[_block_index] = 0;
+        oldest.fill(0.0f);
+        if (_window_frame_count == 0) {
+            return;
+        }
+        auto inverse_count = 1.0f / _window_frame_count;
+        for (size_t pixel_index = 0; pixel_index < _windowed_mean.size(); pixel_index++) {
+            float sum = 0.0f;
+            for (const auto &block : _blocks) {
+                sum += block[pixel_index];
+            }
+            _windowed_mean[pixel_index] = sum * inverse_count;
+        }
+    }
+
+    float _smoothing;
+    uint32_t _block_frames;
+    float _hold_decay;
+    uint32_t _frame_count = 0;
+    uint32_t _window_frame_count = 0;
+    size_t _block_index = 0;
+    std::array<uint32_t, TEMPORAL_WINDOW_BLOCKS> _block_frame_counts{};
+
+    ThermoImage _mean;
+    ThermoImage _windowed_mean;
+    ThermoImage _min_hold;
+    ThermoImage _max_hold;
+    std::array<ThermoImage, TEMPORAL_WINDOW_BLOCKS> _blocks;
+};
+
+} // namespace thermocam
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+#include <stddef.h>
 #include <stdint.h>
 
 namespace thermocam {
@@ -25,9 +27,61 @@ struct ThermoImageStats
     float average_temp;
     float min_temp;
     float max_temp;
+    float center_temp;
     uint32_t min_temp_index;
     uint32_t max_temp_index;
     uint32_t frame_index;
 };
 
+// Hotspot followed over frames by the HotspotTracker (hotspot_tracker.h), positions in pixels of the frame
+struct HotspotTrack
+{
+    uint16_t id;
+    // frames since the track started, frames since its blob was last seen
+    uint16_t age;
+    uint16_t missed_frames;
+    // centroid of the latest blob, predicted while it is missed
+    float x;
+    float y;
+    // pixels per frame
+    float velocity_x;
+    float velocity_y;
+    // of the latest blob
+    float peak_temp;
+    uint16_t area;
+};
+
+// Sum and extremes of the temperatures of a sub-page, accumulated while the calibration kernel writes them (the
+// stats sink of calculate_subpage()) and merged per frame by mlx_utils::update_thermo_image_stats_from_subpages().
+// Ties go to the first min and the last max like std::minmax_element.
+struct SubpageStats
+{
+    float sum = 0.0f;
+    float min_temp = INFINITY;
+    float max_temp = -INFINITY;
+    uint16_t min_temp_index = 0;
+    uint16_t max_temp_index = 0;
+    uint16_t pixel_count = 0;
+
+    void add(size_t pixel_index, float temperature) noexcept
+    {
+        sum += temperature;
+        pixel_count++;
+        if (temperature < min_temp) {
+            min_temp = temperature;
+            min_temp_index = static_cast<uint16_t>(pixel_index);
+        }
+        if (temperature >= max_temp) {
+            max_temp = temperature;
+            max_temp_index = static_cast<uint16_t>(pixel_index);
+        }
+    }
+};
+
+// stats sink of the calibration kernels that drops the values
+struct NoStatsSink
+{
+    void operator()(size_t, float) const noexcept {}
+};
+
 } // namespace thermocam
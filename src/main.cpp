@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <array>
 #include <numeric>
 #include <string>
+#include <type_traits>
 
 #include <Adafruit_MLX90640.h>
 #include <Arduino.h>
@@ -8,20 +10,37 @@
 
 #include "config.h"
 
+#include "adafruit_mlx_acquisition.h"
 #include "algorithms.h"
 #include "arduino_pin.h"
 #include "color.h"
 #include "debug_utils.h"
 #include "draw_utils.h"
+#include "esp32_wire_transport.h"
 #include "fixed_matrix.h"
+#include "fourth_root.h"
+#include "hotspot_blobs.h"
+#include "hotspot_tracker.h"
+#include "mlx_acquisition.h"
+#include "mlx_bad_pixels.h"
+#include "mlx_calibration.h"
+#include "mlx_capture.h"
+#include "mlx_fixed_point_calibration.h"
+#include "mlx_pixel_faults.h"
+#include "mlx_rate_governor.h"
+#include "mlx_roi.h"
+#include "mlx_subpage_stream.h"
 #include "mlx_utils.h"
+#include "nvs_params_cache.h"
+#include "temperature_histogram.h"
+#include "temporal_accumulator.h"
 #include "types/common_types.h"
 #include "types/container_types.h"
 
 using namespace thermocam;
 using namespace thermocam::color;
 
-// buffer for full frame of temperatures
+// buffer for full frame of temperatures, of the relative image with RELATIVE_IMAGE_DISPLAY
 ThermoImage raw_frame;
 RGBThermoImage rgb_frame;
 UpscaledRGBThermoImage upscaled_frame;
@@ -34,14 +53,138 @@ ThermoDisplaySettings tds{.min_scale_temp = DEFAULT_MANUAL_MIN_TEMP,
 ThermoImageStats tis{.average_temp = 0.0,
                      .min_temp = 0.0,
                      .max_temp = 0.0,
+                     .center_temp = 0.0,
                      .min_temp_index = 0,
                      .max_temp_index = 0,
                      .frame_index = 0};
+// hotspots of the latest frames with stable ids, HOTSPOT_DETECTION only
+HotspotTracker hotspot_tracker(HOTSPOT_TRACK_GATE, HOTSPOT_TRACK_MAX_MISSED_FRAMES);
+
+// time to first frame, with and without cached calibration
+unsigned long mlx_init_start_ms = 0;
+bool first_frame_reported = false;
 
 Adafruit_MLX90640 mlx;
 TFT_eSPI tft;
 TwoWire mlx_i2c(0);
+Esp32WireTransport mlx_transport(mlx_i2c, MLX90640_I2CADDR_DEFAULT);
+NvsParamsCache mlx_params_cache;
+std::conditional_t<TEMPERATURE_ENGINE == TemperatureEngine::FIXED_POINT, MlxFixedPointCalibration, MlxCalibration>
+        mlx_calibration;
+MlxBadPixelCorrection mlx_bad_pixels;
+MlxPixelFaultDetector mlx_pixel_faults;
+uint32_t mlx_pixel_fault_generation = 0;
 ArduinoPin button1(UI_BTN_PIN, PinMode::IN_PULLDOWN);
+AdafruitMlxAcquisition mlx_acquisition(mlx, mlx_transport,
+                                       mlx_utils::convert_refresh_rate_to_ms(DEFAULT_MLX_REFRESH_RATE));
+// the capture shares Serial with the text output
+static_assert(!(DEBUG_OUTPUT && CAPTURE_OUTPUT));
+// the relative image and its conversion come from the compiled engines
+static_assert(!RELATIVE_IMAGE_DISPLAY || TEMPERATURE_ENGINE != TemperatureEngine::REFERENCE);
+static_assert(!ROI_MONITORING || TEMPERATURE_ENGINE != TemperatureEngine::REFERENCE);
+// To only for the regions and no display, next to the relative-image display the regions come from its image
+constexpr bool ROI_ONLY = ROI_MONITORING && !RELATIVE_IMAGE_DISPLAY;
+// stand-in without regions while ROI_MONITORING is off, saves the To buffer of the monitor
+struct NoRoiMonitor
+{
+    template <typename Calibration> explicit NoRoiMonitor(Calibration &) {}
+    int add(const MlxRoi &, bool = true) { return -1; }
+    void process_subpage(const uint16_t *) {}
+    void process_subpage_image(uint8_t, Mlx90640PixelReadoutMode, const float *) {}
+    bool is_active(size_t) const noexcept { return false; }
+    MlxRoi roi(size_t) const noexcept { return {0, 0, 0, 0}; }
+    MlxRoiStats stats(size_t) const noexcept { return {NAN, NAN, NAN, 0, 0, 0}; }
+};
+std::conditional_t<ROI_MONITORING, MlxRoiMonitor<decltype(mlx_calibration)>, NoRoiMonitor> mlx_roi_monitor(
+        mlx_calibration);
+// frame stats merged from the sums and extremes the engine accumulates per sub-page instead of two passes over
+// raw_frame, not from the reference engine or a relative image
+constexpr bool FUSED_FRAME_STATS = TEMPERATURE_ENGINE != TemperatureEngine::REFERENCE && !RELATIVE_IMAGE_DISPLAY;
+// of the latest sub-page of each half of raw_frame
+std::array<SubpageStats, 2> subpage_stats{};
+constexpr bool PERCENTILE_AUTOSCALE = AUTOSCALE_MODE == AutoscaleMode::PERCENTILE && !RELATIVE_IMAGE_DISPLAY;
+TemperatureHistogram frame_histogram;
+// stand-in that shows the live frame with TemporalView::LIVE, saves the frames of the accumulator
+struct NoTemporalAccumulator
+{
+    NoTemporalAccumulator(float, uint32_t, float) {}
+    void update(const ThermoImage &) {}
+    void reset_holds() {}
+    const ThermoImage &view(TemporalView, const ThermoImage &live) const noexcept { return live; }
+};
+std::conditional_t<TEMPORAL_VIEW != TemporalView::LIVE, TemporalAccumulator, NoTemporalAccumulator> frame_accumulator(
+        TEMPORAL_MEAN_SMOOTHING, TEMPORAL_WINDOW_FRAMES, TEMPORAL_HOLD_DECAY);
+HotspotLabeler hotspot_labeler;
+MlxCaptureWriter mlx_capture([](const uint8_t *data, size_t size) {
+    return Serial.write(data, std::min<size_t>(size, Serial.availableForWrite()));
+});
+// pixels per sub-page that took the two passes of the To calculation, both halves of the displayed frame
+std::array<uint32_t, 2> two_pass_pixels{};
+MlxSubpageStream mlx_stream(
+        mlx_acquisition,
+        [](uint16_t *subpage_frame, float *temperatures, SubpageStats &stats) {
+            if constexpr (ROI_ONLY) {
+                mlx_roi_monitor.process_subpage(subpage_frame);
+            } else if constexpr (RELATIVE_IMAGE_DISPLAY) {
+                mlx_calibration.calculate_subpage_image(subpage_frame, temperatures);
+            } else if constexpr (TEMPERATURE_ENGINE != TemperatureEngine::REFERENCE) {
+                // the bad pixels go into the stats with their corrected values
+                auto good_pixel_stats = [&stats](size_t pixel_index, float temperature) {
+                    if (!BAD_PIXEL_CORRECTION || !mlx_bad_pixels.is_bad(pixel_index)) {
+                        stats.add(pixel_index, temperature);
+                    }
+                };
+                mlx_calibration.calculate_subpage(subpage_frame, temperatures, good_pixel_stats);
+                two_pass_pixels[mlx_calibration.last_context().subpage_number] =
+                        mlx_calibration.single_pass_stats().fallbacks;
+            } else {
+                mlx.calculateSubpage(subpage_frame, temperatures);
+            }
+            // before the correction, the detector has to see the pixels as they are. New pixels are corrected from
+            // the next sub-page on, the stats of this one skipped the old ones.
+            bool has_new_faults = false;
+            if constexpr (PIXEL_FAULT_DETECTION && BAD_PIXEL_CORRECTION && !ROI_MONITORING &&
+                          !RELATIVE_IMAGE_DISPLAY) {
+                mlx_pixel_faults.update_subpage(subpage_frame, temperatures);
+                has_new_faults = mlx_pixel_faults.generation() != mlx_pixel_fault_generation;
+            }
+            if constexpr (BAD_PIXEL_CORRECTION && !ROI_ONLY) {
+                mlx_bad_pixels.correct_subpage(subpage_frame, temperatures, [&stats](size_t pixel_index, float value) {
+                    if constexpr (FUSED_FRAME_STATS) {
+                        stats.add(pixel_index, value);
+                    }
+                });
+            }
+            if (has_new_faults) {
+                mlx_pixel_fault_generation = mlx_pixel_faults.generation();
+                mlx_bad_pixels.set_detected_pixels(mlx_pixel_faults.faulty_pixels());
+            }
+            // from the corrected image
+            if constexpr (ROI_MONITORING && RELATIVE_IMAGE_DISPLAY) {
+                const auto &context = mlx_calibration.last_context();
+                mlx_roi_monitor.process_subpage_image(context.subpage_number, context.readout_mode, temperatures);
+            }
+        },
+        [](const MlxSubpageFrame &subpage_frame, uint32_t timestamp_ms) {
+            if constexpr (CAPTURE_OUTPUT) {
+                mlx_capture.record(subpage_frame, timestamp_ms);
+            }
+        });
+MlxRateGovernor mlx_governor(
+        [](const GovernorSettings &settings) {
+            if (mlx_transport.is_busy()) {
+                return false; // the worker owns the bus until the RAM read is done
+            }
+            mlx.setRefreshRate(settings.refresh_rate);
+            mlx.setResolution(settings.resolution);
+            mlx_acquisition.set_subpage_period_ms(mlx_utils::convert_refresh_rate_to_ms(settings.refresh_rate));
+            return true;
+        },
+        millis, {DEFAULT_MLX_REFRESH_RATE, DEFAULT_MLX_RESOLUTION});
+// time spent on the current sub-page, without waiting for the sensor
+uint32_t pipeline_us = 0;
+// CPU cycles of the latest temperature calculation, to compare the engines on the target
+uint32_t calculation_cycles = 0;
 
 void init_tft(TFT_eSPI &tft)
 {
@@ -75,16 +218,94 @@ void draw_thermo_legend_to_ui(TFT_eSPI &tft, const RGB8Color &min_temp_color,
 void init_mlx()
 {
     Serial.println("Search for MLX90640");
+    mlx_i2c.setBufferSize(MLX_WIRE_BUFFER_SIZE); // whole RAM block in one transaction
     mlx_i2c.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_FREQUENCY_IN_HZ);
-    if (!mlx.begin(MLX90640_I2CADDR_DEFAULT, &mlx_i2c)) {
+    mlx_init_start_ms = millis();
+    if (!mlx.begin(&mlx_transport, &mlx_params_cache)) {
         Serial.println("MLX90640 not found!");
         while (1)
             delay(10);
     }
     Serial.println(("Found MLX90640 with serial number: " + mlx_utils::get_serial_number(mlx)).c_str());
+    mlx_bad_pixels.compile(mlx.getParams());
+    if constexpr (TEMPERATURE_ENGINE != TemperatureEngine::REFERENCE) {
+        mlx_calibration.compile(mlx.getParams());
+        mlx_calibration.set_single_pass(SINGLE_PASS_TO);
+    }
+    if constexpr (ROI_MONITORING) {
+        // example regions, more can be added and removed at runtime
+        mlx_roi_monitor.add({4, 4, 8, 6});
+        mlx_roi_monitor.add({20, 14, 6, 6});
+        mlx_roi_monitor.add(MlxRoi::point(MLX_SENSOR_WIDTH / 2, MLX_SENSOR_HEIGHT / 2));
+    }
+    Serial.printf("Calibration from %s in %lu ms\n", mlx_params_cache.stats().hits > 0 ? "cache" : "EEPROM",
+                  millis() - mlx_init_start_ms);
+    if constexpr (BAD_PIXEL_CORRECTION) {
+        Serial.printf("%u bad pixels in the EEPROM\n", static_cast<unsigned>(mlx_bad_pixels.bad_pixel_count()));
+    }
+    mlx_acquisition.set_bus_reset_function(
+            []() { return mlx_transport.reset_bus(I2C_SDA_PIN, I2C_SCL_PIN, I2C_FREQUENCY_IN_HZ); });
     mlx.setMode(Mlx90640PixelReadoutMode::MLX90640_CHESS);
-    mlx.setResolution(Mlx90640BitResolution::MLX90640_ADC_18BIT);
+    mlx.setResolution(DEFAULT_MLX_RESOLUTION);
     mlx.setRefreshRate(DEFAULT_MLX_REFRESH_RATE);
+
+    if constexpr (CAPTURE_OUTPUT) {
+        MlxEeprom eeprom;
+        if (mlx.MLX90640_I2CRead(0, MLX_EEPROM_START_ADDRESS, MLX_EEPROM_WORDS, eeprom.data()) == 0) {
+            Serial.println("Capture starts after this line");
+            mlx_capture.begin(eeprom);
+        }
+    }
+}
+
+// cycles per fourth root on the target against FOURTH_ROOT_TARGET_CYCLES, inputs of -40 to 400 C
+void report_fourth_root_cycles()
+{
+    std::array<float, 64> inputs;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        auto kelvin = 233.0f + i * 7.0f;
+        inputs[i] = kelvin * kelvin * kelvin * kelvin;
+    }
+    constexpr uint32_t ROUNDS = 16;
+    constexpr uint32_t ROOTS = ROUNDS * inputs.size();
+    volatile float sink;
+
+    auto start_cycles = ESP.getCycleCount();
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        for (auto input : inputs) {
+            sink = fourth_root(input);
+        }
+    }
+    auto fourth_root_cycles = (ESP.getCycleCount() - start_cycles) / ROOTS;
+    start_cycles = ESP.getCycleCount();
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        for (auto input : inputs) {
+            sink = std::sqrt(std::sqrt(input));
+        }
+    }
+    auto sqrt_cycles = (ESP.getCycleCount() - start_cycles) / ROOTS;
+    (void)sink;
+    Serial.printf("fourth root: %lu cycles (target %lu), sqrt(sqrt()): %lu cycles\n",
+                  static_cast<unsigned long>(fourth_root_cycles),
+                  static_cast<unsigned long>(FOURTH_ROOT_TARGET_CYCLES), static_cast<unsigned long>(sqrt_cycles));
+}
+
+// min / max / mean of every active region, once per frame
+void report_roi_stats()
+{
+    static uint32_t subpages = 0;
+    if (++subpages % 2 != 0) {
+        return;
+    }
+    for (size_t roi_index = 0; roi_index < MLX_MAX_ROI_COUNT; roi_index++) {
+        if (!mlx_roi_monitor.is_active(roi_index)) {
+            continue;
+        }
+        const auto &roi = mlx_roi_monitor.roi(roi_index);
+        const auto &stats = mlx_roi_monitor.stats(roi_index);
+        Serial.printf("ROI %u (%u,%u %ux%u): min %.2f C, max %.2f C, mean %.2f C\n", static_cast<unsigned>(roi_index),
+                      roi.x, roi.y, roi.width, roi.height, stats.min_temp, stats.max_temp, stats.average_temp);
+    }
 }
 
 void setup()
@@ -92,6 +313,9 @@ void setup()
     wait_for_serial();
     init_tft(tft);
     draw_thermo_legend_to_ui(tft, MIN_TEMP_COLOR, MAX_TEMP_COLOR, COLOR_BLEND_STEPS);
+    if constexpr (DEBUG_OUTPUT) {
+        report_fourth_root_cycles();
+    }
     init_mlx();
 }
 
@@ -99,27 +323,142 @@ void loop()
 {
     if (button1.was_edge_detected(EdgeType::RISING_EDGE)) { // TODO: this could also return the current detected behaviour
         tds.autoscale_active = !tds.autoscale_active;
+        frame_accumulator.reset_holds();
+    }
+    // both stages return right away while the sensor integrates, the previous frame stays on screen.
+    // Bus errors are retried and counted inside, a lost sub-page arrives as a substitute that keeps the old half.
+    mlx_stream.acquire();
+    auto process_start_us = micros();
+    auto process_start_cycles = ESP.getCycleCount();
+    if (mlx_stream.process()) {
+        calculation_cycles = ESP.getCycleCount() - process_start_cycles;
+        pipeline_us += micros() - process_start_us;
+    }
+    if constexpr (CAPTURE_OUTPUT) {
+        mlx_capture.drain(); // only what the USB / UART buffer takes right now
     }
-    if (mlx.getFrame(raw_frame.data()) != 0) {
-        Serial.println("frame read failed");
+
+    ComputedSubpage subpage;
+    if (!mlx_stream.next(subpage)) {
         return;
     }
+    if constexpr (ROI_MONITORING) {
+        report_roi_stats();
+    }
+    if constexpr (ROI_ONLY) {
+        mlx_stream.release(subpage);
+        return;
+    }
+    auto display_start_us = micros();
+    // every sub-page refreshes half of the pixels -> display updates twice per sensor frame
+    merge_subpage_into_frame(subpage, raw_frame);
+    if (!subpage.is_substitute) {
+        subpage_stats[subpage.subpage_number] = subpage.stats;
+    }
+    mlx_stream.release(subpage);
+    if (!mlx_stream.has_full_frame()) {
+        return;
+    }
+    if (!first_frame_reported && !CAPTURE_OUTPUT) {
+        Serial.printf("First frame %lu ms after sensor init\n", millis() - mlx_init_start_ms);
+    }
+    first_frame_reported = true;
+
     tis.frame_index++;
     tis.frame_index %= 1000;
-    mlx_utils::update_thermo_image_stats_from_frame(raw_frame, tis);
+    if constexpr (RELATIVE_IMAGE_DISPLAY) {
+        mlx_utils::update_thermo_image_stats_from_image(raw_frame, tis, [](size_t pixel_index, float image) {
+            return mlx_calibration.image_to_temperature(pixel_index, image);
+        });
+    } else if constexpr (FUSED_FRAME_STATS) {
+        mlx_utils::update_thermo_image_stats_from_subpages(subpage_stats, raw_frame, tis);
+    } else {
+        mlx_utils::update_thermo_image_stats_from_frame(raw_frame, tis);
+    }
 
-    if (tds.autoscale_active) {
-        tds.min_scale_temp = tis.min_temp - 1.0;
-        tds.max_scale_temp = tis.max_temp + 1.0;
+    if (tds.autoscale_active && PERCENTILE_AUTOSCALE) {
+        frame_histogram.update_from_frame(raw_frame);
+        tds.min_scale_temp = frame_histogram.percentile(AUTOSCALE_LOW_PERCENTILE) - AUTOSCALE_MARGIN;
+        tds.max_scale_temp = frame_histogram.percentile(AUTOSCALE_HIGH_PERCENTILE) + AUTOSCALE_MARGIN;
+    } else if (tds.autoscale_active) {
+        tds.min_scale_temp = tis.min_temp - AUTOSCALE_MARGIN;
+        tds.max_scale_temp = tis.max_temp + AUTOSCALE_MARGIN;
     } else {
         tds.min_scale_temp = DEFAULT_MANUAL_MIN_TEMP;
         tds.max_scale_temp = DEFAULT_MANUAL_MAX_TEMP;
     }
+    if constexpr (HOTSPOT_DETECTION && !RELATIVE_IMAGE_DISPLAY) {
+        hotspot_labeler.update(raw_frame, HOTSPOT_THRESHOLD, HOTSPOT_MIN_AREA);
+        hotspot_tracker.update(hotspot_labeler);
+    }
     if constexpr (DEBUG_OUTPUT) {
         Serial.println(debug_utils::generate_debug_string(tds, tis).c_str());
+        if constexpr (HOTSPOT_DETECTION && !RELATIVE_IMAGE_DISPLAY) {
+            Serial.printf("hotspots: %lu blobs (%lu dropped)", static_cast<unsigned long>(hotspot_labeler.blob_count()),
+                          static_cast<unsigned long>(hotspot_labeler.dropped_blob_count()));
+            for (size_t i = 0; i < hotspot_tracker.track_count(); i++) {
+                const auto &track = hotspot_tracker.tracks()[i];
+                Serial.printf(" #%u [%.1f,%.1f] %+.2f,%+.2f px/frame %u frames %.1f C", track.id, track.x, track.y,
+                              track.velocity_x, track.velocity_y, track.age, track.peak_temp);
+            }
+            Serial.println();
+        }
+        Serial.printf("sub-pages: %lu dropped, %lu raw buffer starvations\n",
+                      static_cast<unsigned long>(mlx_stream.dropped_subpages()),
+                      static_cast<unsigned long>(mlx_stream.raw_pool_stats().starvations));
+        Serial.printf("calculation: %lu cycles/sub-page (%s)\n", static_cast<unsigned long>(calculation_cycles),
+                      TEMPERATURE_ENGINE == TemperatureEngine::FIXED_POINT ? "fixed-point"
+                      : TEMPERATURE_ENGINE == TemperatureEngine::COMPILED  ? "compiled"
+                                                                           : "reference");
+        if constexpr (TEMPERATURE_ENGINE != TemperatureEngine::REFERENCE) {
+            Serial.printf("offset cache: %lu hits, %lu rebuilds\n",
+                          static_cast<unsigned long>(mlx_calibration.offset_cache_stats().hits),
+                          static_cast<unsigned long>(mlx_calibration.offset_cache_stats().rebuilds));
+            Serial.printf("single pass: %lu/%lu pixels fell back to two passes\n",
+                          static_cast<unsigned long>(two_pass_pixels[0] + two_pass_pixels[1]),
+                          static_cast<unsigned long>(MLX_PIXEL_COUNT));
+        }
+        if constexpr (PIXEL_FAULT_DETECTION && BAD_PIXEL_CORRECTION && !RELATIVE_IMAGE_DISPLAY) {
+            Serial.printf("pixel faults: %lu stuck, %lu noisy, %lu offset, %lu over the correction limit\n",
+                          static_cast<unsigned long>(mlx_pixel_faults.fault_count(PixelFault::STUCK)),
+                          static_cast<unsigned long>(mlx_pixel_faults.fault_count(PixelFault::NOISY)),
+                          static_cast<unsigned long>(mlx_pixel_faults.fault_count(PixelFault::OFFSET)),
+                          static_cast<unsigned long>(mlx_bad_pixels.ignored_pixel_count()));
+        }
+        Serial.printf("errors: %lu sub-pages lost, %lu bus errors (%lu recovered), %lu bus resets\n",
+                      static_cast<unsigned long>(mlx_stream.lost_subpages()),
+                      static_cast<unsigned long>(mlx_acquisition.stats().bus_errors),
+                      static_cast<unsigned long>(mlx_acquisition.stats().recovered_errors),
+                      static_cast<unsigned long>(mlx_acquisition.stats().bus_resets));
+        Serial.printf("I2C: %lu bytes/s, %lu/%lu register writes failed verification\n",
+                      static_cast<unsigned long>(mlx_transport.stats().bytes_per_second()),
+                      static_cast<unsigned long>(mlx.getWriteStats().verificationFailures),
+                      static_cast<unsigned long>(mlx.getWriteStats().verifications));
+        Serial.printf("governor: %.1f Hz, %d bit, headroom %.2f, scene change %.2f C, %lu up / %lu down\n",
+                      0.5f * (1 << static_cast<int>(mlx_governor.settings().refresh_rate)),
+                      16 + static_cast<int>(mlx_governor.settings().resolution), mlx_governor.headroom(),
+                      mlx_governor.scene_change(), static_cast<unsigned long>(mlx_governor.stats().rate_increases),
+                      static_cast<unsigned long>(mlx_governor.stats().rate_decreases));
+    }
+
+    if constexpr (TEMPORAL_VIEW != TemporalView::LIVE) {
+        frame_accumulator.update(raw_frame);
     }
+    // colors from the live frame or a statistic over time of it
+    const auto &color_frame = frame_accumulator.view(TEMPORAL_VIEW, raw_frame);
 
-    mlx_utils::convert_raw_temp_to_color(raw_frame, rgb_frame, tds);
+    // frame values per degree Celsius for the scene change of the governor
+    float frame_units_per_degree = 1.0f;
+    if constexpr (RELATIVE_IMAGE_DISPLAY) {
+        auto image_scale = tds;
+        image_scale.min_scale_temp = mlx_calibration.temperature_to_image(tds.min_scale_temp);
+        image_scale.max_scale_temp = mlx_calibration.temperature_to_image(tds.max_scale_temp);
+        mlx_utils::convert_raw_temp_to_color(color_frame, rgb_frame, image_scale);
+        frame_units_per_degree = mlx_calibration.temperature_to_image(tis.average_temp + 0.5f) -
+                                 mlx_calibration.temperature_to_image(tis.average_temp - 0.5f);
+    } else {
+        mlx_utils::convert_raw_temp_to_color(color_frame, rgb_frame, tds);
+    }
 
     algorithms::bilinear_upscale(rgb_frame, upscaled_frame);
 
@@ -128,4 +467,10 @@ void loop()
                                                        common_colors::CYAN, common_colors::RED);
     draw_utils::draw_thermo_image(tft, upscaled_frame, DRAW_INTERPOLATION_FACTOR, tds.mirror_mode);
     draw_utils::draw_live_ui(tft, tds, tis);
+
+    pipeline_us += micros() - display_start_us;
+    if constexpr (ADAPTIVE_REFRESH_RATE) {
+        mlx_governor.update(raw_frame, pipeline_us, frame_units_per_degree);
+    }
+    pipeline_us = 0;
 }
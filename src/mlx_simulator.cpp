@@ -0,0 +1,210 @@
+#include "mlx_simulator.h"
+
+#include <algorithm>
+
+#include "mlx_reference_data.h"
+#include "mlx_subpage_stream.h"
+
+namespace thermocam {
+
+namespace {
+
+constexpr uint16_t MLX_AUX_DATA_START_WORD = MLX_SENSOR_WIDTH * MLX_SENSOR_HEIGHT;
+
+bool is_in_block(uint16_t address, uint16_t start_address, uint16_t word_count)
+{
+    return address >= start_address && address < start_address + word_count;
+}
+
+int adc_resolution(uint16_t control_register)
+{
+    return (control_register >> MLX_CONTROL_RESOLUTION_SHIFT) & MLX_CONTROL_RESOLUTION_MASK;
+}
+
+} // namespace
+
+// public
+
+MlxSimulator::MlxSimulator()
+    : MlxSimulator(mlx_reference_data::EEPROM, mlx_reference_data::SUBPAGE_FRAMES)
+{
+}
+
+MlxSimulator::MlxSimulator(const std::array<uint16_t, MLX_EEPROM_WORDS> &eeprom,
+                           const std::array<MlxSubpageFrame, 2> &subpage_templates)
+    : _eeprom(eeprom),
+      _subpage_templates(subpage_templates),
+      _control_register(eeprom[MLX_CONTROL_REGISTER_EEPROM_WORD]) // loaded from EEPROM at power-up
+{
+    // RAM holds the last measurement before the first sub-page is ready
+    std::copy_n(_subpage_templates[1].begin(), MLX_RAM_WORDS, _ram.begin());
+    _next_measurement_us = subpage_period_us();
+}
+
+int MlxSimulator::read(uint16_t start_address, uint16_t word_count, uint16_t *data)
+{
+    if (_fail_transaction()) {
+        return -1;
+    }
+    for (uint16_t word_index = 0; word_index < word_count; word_index++) {
+        uint16_t unused;
+        if (!_read_word(start_address + word_index, unused)) {
+            return -1;
+        }
+    }
+
+    uint16_t max_read_words = _max_read_words > 0 ? _max_read_words : word_count;
+    uint16_t word_index = 0;
+    while (word_index < word_count) {
+        uint16_t chunk_words = std::min<uint16_t>(max_read_words, word_count - word_index);
+        // device address (write) + register address, repeated start, device address (read), then the data words.
+        // Each word is sampled when its transfer ends, so a measurement finishing mid-transfer shows up in the data.
+        uint64_t chunk_start_us = _now_us;
+        uint32_t bits = 4 * I2C_BITS_PER_BYTE + 2 * I2C_CONDITION_BITS;
+        for (uint16_t chunk_word = 0; chunk_word < chunk_words; chunk_word++, word_index++) {
+            bits += 2 * I2C_BITS_PER_BYTE;
+            _advance_to(chunk_start_us + _bus_time_us(bits));
+            _read_word(start_address + word_index, data[word_index]);
+        }
+        bits += I2C_CONDITION_BITS;
+        _advance_to(chunk_start_us + _bus_time_us(bits));
+
+        _stats.read_transactions++;
+        _stats.bus_bytes += 4 + 2 * chunk_words;
+        _stats.bus_busy_us += _now_us - chunk_start_us;
+    }
+    return 0;
+}
+
+int MlxSimulator::write(uint16_t address, uint16_t value)
+{
+    if (_fail_transaction()) {
+        return -1;
+    }
+    // device address + register address + value, the register is updated with the stop condition
+    uint64_t start_us = _now_us;
+    _advance_to(start_us + _bus_time_us(5 * I2C_BITS_PER_BYTE + 2 * I2C_CONDITION_BITS));
+    _stats.write_transactions++;
+    _stats.bus_bytes += 5;
+    _stats.bus_busy_us += _now_us - start_us;
+
+    bool is_register = address == MLX_STATUS_REGISTER || address == MLX_CONTROL_REGISTER_1;
+    if (is_register && _ignored_writes > 0) {
+        _ignored_writes--;
+        return 0;
+    }
+    if (address == MLX_STATUS_REGISTER) {
+        _status_register = (_status_register & ~MLX_STATUS_WRITABLE_MASK) | (value & MLX_STATUS_WRITABLE_MASK);
+        return 0;
+    }
+    if (address == MLX_CONTROL_REGISTER_1) {
+        auto previous_period_us = subpage_period_us();
+        _control_register = value;
+        if (subpage_period_us() != previous_period_us) {
+            // a new refresh rate restarts the running measurement
+            _next_measurement_us = _now_us + subpage_period_us();
+        }
+        return 0;
+    }
+    return -1;
+}
+
+void MlxSimulator::advance_us(uint64_t duration_us)
+{
+    _advance_to(_now_us + duration_us);
+}
+
+uint32_t MlxSimulator::subpage_period_us() const noexcept
+{
+    // 0.5 Hz (2 s per sub-page) doubling up to 64 Hz
+    auto refresh_rate = (_control_register >> MLX_CONTROL_REFRESH_RATE_SHIFT) & 0x07;
+    return 2'000'000 >> refresh_rate;
+}
+
+// private
+
+uint64_t MlxSimulator::_bus_time_us(uint32_t bits) const noexcept
+{
+    return (static_cast<uint64_t>(bits) * 1'000'000 + _i2c_clock_hz - 1) / _i2c_clock_hz;
+}
+
+// Injected NACK of the device address, the transaction ends after the first byte
+bool MlxSimulator::_fail_transaction()
+{
+    if (!_is_bus_held && _failing_transactions == 0) {
+        return false;
+    }
+    if (_failing_transactions > 0) {
+        _failing_transactions--;
+    }
+    uint64_t start_us = _now_us;
+    _advance_to(start_us + _bus_time_us(I2C_BITS_PER_BYTE + 2 * I2C_CONDITION_BITS));
+    _stats.failed_transactions++;
+    _stats.bus_bytes += 1;
+    _stats.bus_busy_us += _now_us - start_us;
+    return true;
+}
+
+void MlxSimulator::_advance_to(uint64_t time_us)
+{
+    while (_next_measurement_us <= time_us) {
+        _now_us = _next_measurement_us;
+        _measure_subpage();
+        _next_measurement_us += subpage_period_us();
+    }
+    _now_us = time_us;
+}
+
+void MlxSimulator::_measure_subpage()
+{
+    uint16_t subpage_number = _next_subpage;
+    if ((_control_register & MLX_CONTROL_SUBPAGE_REPEAT) != 0) {
+        subpage_number = (_control_register >> MLX_CONTROL_SUBPAGE_SELECT_SHIFT) & MLX_STATUS_SUBPAGE_MASK;
+    } else {
+        _next_subpage ^= 1;
+    }
+    _stats.subpages_measured++;
+
+    if ((_status_register & MLX_STATUS_DATA_READY) != 0) {
+        _stats.subpages_dropped++;
+        if ((_status_register & MLX_STATUS_OVERWRITE_ENABLE) == 0) {
+            return; // RAM keeps the unread sub-page
+        }
+    }
+
+    auto readout_mode = (_control_register & MLX_CONTROL_CHESS_MODE) != 0 ? Mlx90640PixelReadoutMode::MLX90640_CHESS
+                                                                          : Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED;
+    const auto &subpage_template = _subpage_templates[subpage_number];
+    for (auto pixel_index : subpage_pixel_indices(subpage_number, readout_mode)) {
+        _ram[pixel_index] = subpage_template[pixel_index] + _pixel_offsets[pixel_index];
+    }
+    std::copy(subpage_template.begin() + MLX_AUX_DATA_START_WORD,
+              subpage_template.begin() + MLX_RAM_WORDS,
+              _ram.begin() + MLX_AUX_DATA_START_WORD);
+    // MLX90640_GetVdd scales the Vdd reading with the resolution in control register 1, the templates were
+    // recorded with the resolution of their own control register word
+    int resolution_shift = adc_resolution(_control_register) - adc_resolution(subpage_template[MLX_CONTROL_REGISTER_WORD]);
+    auto vdd = static_cast<int16_t>(_ram[MLX_VDD_RAM_WORD]);
+    _ram[MLX_VDD_RAM_WORD] = static_cast<uint16_t>(resolution_shift >= 0 ? vdd * (1 << resolution_shift)
+                                                                          : vdd / (1 << -resolution_shift));
+
+    _status_register = (_status_register & ~MLX_STATUS_SUBPAGE_MASK) | subpage_number | MLX_STATUS_DATA_READY;
+}
+
+bool MlxSimulator::_read_word(uint16_t address, uint16_t &value) const
+{
+    if (is_in_block(address, MLX_RAM_START_ADDRESS, MLX_RAM_WORDS)) {
+        value = _ram[address - MLX_RAM_START_ADDRESS];
+    } else if (is_in_block(address, MLX_EEPROM_START_ADDRESS, MLX_EEPROM_WORDS)) {
+        value = _eeprom[address - MLX_EEPROM_START_ADDRESS];
+    } else if (address == MLX_STATUS_REGISTER) {
+        value = _status_register;
+    } else if (address == MLX_CONTROL_REGISTER_1) {
+        value = _control_register;
+    } else {
+        return false; // not modeled
+    }
+    return true;
+}
+
+} // namespace thermocam
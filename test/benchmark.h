@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <stdint.h>
+
+#include "unity.h"
+
+// Shared by the native benchmarks: host timings, printed next to the test results
+namespace thermocam::benchmark {
+
+// best of a few rounds, the first one also warms up the caches
+template <typename Function> double microseconds_per_call(Function function, uint32_t calls)
+{
+    double best_us = INFINITY;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t call = 0; call < calls; call++) {
+            function();
+        }
+        std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+        best_us = std::min(best_us, duration.count() / calls);
+    }
+    return best_us;
+}
+
+// TEST_MESSAGE with printf formatting
+__attribute__((format(printf, 1, 2))) inline void report(const char *format, ...)
+{
+    char message[200];
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(message, sizeof(message), format, arguments);
+    va_end(arguments);
+    TEST_MESSAGE(message);
+}
+
+} // namespace thermocam::benchmark
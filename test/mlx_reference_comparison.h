@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Adafruit_MLX90640.h>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+
+#include "mlx_acquisition.h"
+#include "mlx_pixel_layout.h"
+#include "mlx_reference_data.h"
+#include "pseudo_random.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+// Shared by the native tests of the To engines: comparison against MLX90640_CalculateTo on the reference data
+namespace thermocam::mlx_reference_comparison {
+
+// largest difference between the reference implementation and the engine over the sub-page pixels, the other
+// pixels must not be written
+template <typename Engine>
+float max_difference_to_reference(Adafruit_MLX90640 &mlx, Engine &engine, MlxSubpageFrame subpage_frame)
+{
+    ThermoImage reference{};
+    ThermoImage calculated{};
+    mlx.calculateSubpage(subpage_frame.data(), reference.data());
+    engine.calculate_subpage(subpage_frame.data(), calculated.data());
+
+    auto context = engine.last_context();
+    float max_difference = 0.0f;
+    for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+        if (!is_pixel_in_subpage(pixel_index, context.subpage_number, context.readout_mode)) {
+            TEST_ASSERT_EQUAL_FLOAT(0.0f, calculated[pixel_index]); // not written
+            continue;
+        }
+        TEST_ASSERT_EQUAL(std::isnan(reference[pixel_index]), std::isnan(calculated[pixel_index]));
+        if (!std::isnan(reference[pixel_index])) {
+            max_difference = std::max(max_difference, std::fabs(reference[pixel_index] - calculated[pixel_index]));
+        }
+    }
+    return max_difference;
+}
+
+// reference sub-page with every pixel shifted by raw_offset counts (300 counts are about 50 C) plus noise of up to
+// +-noise counts
+inline MlxSubpageFrame shifted_subpage(size_t subpage_number, int raw_offset, int noise = 0)
+{
+    static pseudo_random::Lcg random;
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[subpage_number];
+    for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+        subpage_frame[pixel_index] = static_cast<uint16_t>(static_cast<int16_t>(subpage_frame[pixel_index]) +
+                                                           raw_offset + random.counts(noise));
+    }
+    return subpage_frame;
+}
+
+} // namespace thermocam::mlx_reference_comparison
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+// Shared by the native tests: reproducible noise and scenes, the same numbers on every host
+namespace thermocam::pseudo_random {
+
+// linear congruential generator with the Numerical Recipes constants
+class Lcg
+{
+public:
+    explicit Lcg(uint32_t seed = 1) : _state(seed) {}
+
+    uint32_t next() noexcept
+    {
+        _state = _state * 1664525u + 1013904223u;
+        return _state;
+    }
+
+    // upper 24 bits, the lower ones repeat with short periods
+    uint32_t next_24_bits() noexcept { return next() >> 8; }
+
+    // in [0, 1), exact in a float
+    float uniform() noexcept { return static_cast<float>(next_24_bits()) * 0x1p-24f; }
+
+    // from -amplitude to +amplitude, e.g. raw ADC counts of noise
+    int counts(int amplitude) noexcept
+    {
+        return static_cast<int>((next() >> 16) % (2 * amplitude + 1)) - amplitude;
+    }
+
+private:
+    uint32_t _state;
+};
+
+} // namespace thermocam::pseudo_random
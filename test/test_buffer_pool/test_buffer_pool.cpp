@@ -0,0 +1,206 @@
+#include <ArduinoFake.h>
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include "buffer_pool.h"
+#include "mlx_acquisition.h"
+#include "mlx_simulator.h"
+#include "mlx_subpage_stream.h"
+#include "spsc_ring.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+using TestBuffer = std::array<uint32_t, 64>;
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), delay)).AlwaysReturn(); // settle time after register writes
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_ring_keeps_order_and_capacity(void)
+{
+    SpscRing<int, 3> ring;
+    TEST_ASSERT_TRUE(ring.push(1));
+    TEST_ASSERT_TRUE(ring.push(2));
+    TEST_ASSERT_TRUE(ring.push(3));
+    TEST_ASSERT_FALSE(ring.push(4));
+    TEST_ASSERT_EQUAL_UINT32(3, ring.size());
+
+    int value = 0;
+    for (int expected = 1; expected <= 3; expected++) {
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL_INT(expected, value);
+        TEST_ASSERT_TRUE(ring.push(expected + 3)); // wraps around
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, ring.size());
+}
+
+void test_pool_hands_out_every_buffer_once(void)
+{
+    BufferPool<TestBuffer, 3> pool;
+    std::array<TestBuffer *, 3> buffers{};
+    for (auto &buffer : buffers) {
+        buffer = pool.acquire();
+        TEST_ASSERT_NOT_NULL(buffer);
+    }
+    TEST_ASSERT_TRUE(buffers[0] != buffers[1] && buffers[1] != buffers[2] && buffers[0] != buffers[2]);
+    TEST_ASSERT_NULL(pool.acquire());
+    TEST_ASSERT_EQUAL_UINT32(1, pool.stats().starvations);
+
+    pool.publish(buffers[0]);
+    pool.publish(buffers[1]);
+    TEST_ASSERT_TRUE(pool.has_ready());
+    TEST_ASSERT_TRUE(pool.consume() == buffers[0]);
+    pool.release(buffers[0]);
+    TEST_ASSERT_TRUE(pool.acquire() == buffers[0]);
+}
+
+void test_consume_latest_skips_stale_buffers(void)
+{
+    BufferPool<TestBuffer, 3> pool;
+    for (uint32_t value = 0; value < 3; value++) {
+        auto *buffer = pool.acquire();
+        buffer->fill(value);
+        pool.publish(buffer);
+    }
+    auto *latest = pool.consume_latest();
+    TEST_ASSERT_NOT_NULL(latest);
+    TEST_ASSERT_EQUAL_UINT32(2, (*latest)[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, pool.stats().overwrites);
+    TEST_ASSERT_NULL(pool.consume_latest());
+
+    // the skipped buffers are free again
+    TEST_ASSERT_NOT_NULL(pool.acquire());
+    TEST_ASSERT_NOT_NULL(pool.acquire());
+    TEST_ASSERT_NULL(pool.acquire());
+}
+
+// Producer and consumer on their own threads, the consumer checks that no buffer is written while it owns it.
+// Meant to run under -fsanitize=thread (env:native_tsan).
+void test_two_threads_hand_over_without_tearing(void)
+{
+    constexpr uint32_t BUFFER_COUNT = 20'000;
+    BufferPool<TestBuffer, 4> pool;
+    std::atomic<bool> producer_done{false};
+
+    std::thread producer([&]() {
+        uint32_t sequence = 0;
+        while (sequence < BUFFER_COUNT) {
+            auto *buffer = pool.acquire();
+            if (buffer == nullptr) {
+                std::this_thread::yield();
+                continue;
+            }
+            buffer->fill(sequence++);
+            pool.publish(buffer);
+        }
+        producer_done.store(true);
+    });
+
+    uint32_t expected_sequence = 0;
+    bool torn = false;
+    bool out_of_order = false;
+    while (expected_sequence < BUFFER_COUNT) {
+        auto *buffer = pool.consume();
+        if (buffer == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (auto value : *buffer) {
+            torn |= value != (*buffer)[0];
+        }
+        out_of_order |= (*buffer)[0] != expected_sequence++;
+        pool.release(buffer);
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(producer_done.load());
+    TEST_ASSERT_FALSE(torn);
+    TEST_ASSERT_FALSE(out_of_order);
+    TEST_ASSERT_EQUAL_UINT32(BUFFER_COUNT, pool.stats().published);
+    TEST_ASSERT_EQUAL_UINT32(BUFFER_COUNT, pool.stats().consumed);
+}
+
+// Acquisition stage on the simulated sensor in one thread, processing and consumer in the other
+void test_stream_stages_on_two_threads(void)
+{
+    constexpr uint32_t SUBPAGE_COUNT = 40;
+    MlxSimulator simulator;
+    Adafruit_MLX90640 mlx;
+    TEST_ASSERT_TRUE(mlx.begin(&simulator));
+    mlx.setRefreshRate(Mlx90640RefreshRate::MLX90640_64_HZ);
+
+    MlxSubpageAcquisition acquisition(
+            [&mlx](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                return mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+            },
+            [&mlx](uint16_t address, uint16_t value) { return mlx.MLX90640_I2CWrite(0, address, value); },
+            [&simulator]() { return simulator.now_ms(); },
+            simulator.subpage_period_us() / 1000);
+    MlxSubpageStream stream(acquisition, [&mlx](uint16_t *subpage_frame, float *temperatures) {
+        mlx.calculateSubpage(subpage_frame, temperatures);
+    });
+
+    std::atomic<bool> stop{false};
+    std::thread acquisition_thread([&]() {
+        while (!stop.load()) {
+            stream.acquire();
+            simulator.advance_us(500);
+        }
+    });
+
+    uint32_t received = 0;
+    uint32_t last_sequence_number = 0;
+    bool sequence_gap = false;
+    bool implausible_temperature = false;
+    while (received < SUBPAGE_COUNT) {
+        stream.process();
+        ComputedSubpage subpage;
+        if (!stream.next(subpage)) {
+            std::this_thread::yield();
+            continue;
+        }
+        sequence_gap |= received > 0 && subpage.sequence_number != last_sequence_number + 1;
+        last_sequence_number = subpage.sequence_number;
+        // first pixel of the sub-page in chess mode, the reference scene is at about 30 deg C
+        auto temperature = (*subpage.temperatures)[subpage.subpage_number];
+        implausible_temperature |= temperature < 25.0f || temperature > 35.0f;
+        stream.release(subpage);
+        received++;
+    }
+    stop.store(true);
+    acquisition_thread.join();
+
+    TEST_ASSERT_FALSE(sequence_gap);
+    TEST_ASSERT_FALSE(implausible_temperature);
+    TEST_ASSERT_TRUE(stream.has_full_frame());
+    // a sub-page is only dropped when the acquisition stage found no free raw buffer
+    auto raw_stats = stream.raw_pool_stats();
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(raw_stats.starvations, stream.dropped_subpages());
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(SUBPAGE_COUNT, raw_stats.published);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_keeps_order_and_capacity);
+    RUN_TEST(test_pool_hands_out_every_buffer_once);
+    RUN_TEST(test_consume_latest_skips_stale_buffers);
+    RUN_TEST(test_two_threads_hand_over_without_tearing);
+    RUN_TEST(test_stream_stages_on_two_threads);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,165 @@
+#include <ArduinoFake.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "fourth_root.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+// rounding of the float result to 24 bits
+constexpr double FLOAT_ROUNDING = 6e-8;
+// the fourth roots of the To calculation see (To^4 or Ta,r^4 +- IR / alpha), far beyond the -40 to 300 C of the
+// sensor: 50 K to 1500 K
+constexpr float MIN_PHYSICAL_INPUT = 50.0f * 50.0f * 50.0f * 50.0f;
+constexpr float MAX_PHYSICAL_INPUT = 1500.0f * 1500.0f * 1500.0f * 1500.0f;
+
+uint32_t float_bits(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bits_to_float(uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// best of a few rounds over all inputs, the first one also warms up the caches
+template <typename Function> double nanoseconds_per_root(const std::vector<float> &inputs, Function function)
+{
+    double best_ns = INFINITY;
+    volatile float sink = 0.0f;
+    for (int round = 0; round < 5; round++) {
+        float sum = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (auto input : inputs) {
+            sum += function(input);
+        }
+        std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+        best_ns = std::min(best_ns, duration.count() / inputs.size());
+        sink = sink + sum;
+    }
+    return best_ns;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_every_float_of_the_physical_range(void)
+{
+    double max_error = 0.0;
+    uint32_t count = 0;
+    for (auto bits = float_bits(MIN_PHYSICAL_INPUT); bits <= float_bits(MAX_PHYSICAL_INPUT); bits++) {
+        auto value = bits_to_float(bits);
+        auto expected = std::pow(static_cast<double>(value), 0.25);
+        auto error = std::fabs(fourth_root(value) - expected) / expected;
+        if (error > max_error) {
+            max_error = error;
+        }
+        count++;
+    }
+
+    char message[120];
+    snprintf(message, sizeof(message), "%lu floats, max relative error %.3g (%d Newton steps)",
+             static_cast<unsigned long>(count), max_error, fourth_root_internal::NEWTON_STEPS);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(max_error < FOURTH_ROOT_MAX_RELATIVE_ERROR + FLOAT_ROUNDING);
+}
+
+void test_whole_float_range(void)
+{
+    // one float per binade and mantissa step, including subnormals
+    double max_error = 0.0;
+    for (uint32_t bits = 1; bits < float_bits(INFINITY); bits += 997) {
+        auto value = bits_to_float(bits);
+        auto expected = std::pow(static_cast<double>(value), 0.25);
+        max_error = std::max(max_error, std::fabs(fourth_root(value) - expected) / expected);
+    }
+    TEST_ASSERT_TRUE(max_error < FOURTH_ROOT_MAX_RELATIVE_ERROR + FLOAT_ROUNDING);
+}
+
+void test_special_values_follow_sqrt(void)
+{
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fourth_root(0.0f));
+    TEST_ASSERT_TRUE(std::signbit(fourth_root(-0.0f)));
+    TEST_ASSERT_TRUE(std::isnan(fourth_root(-1.0f)));
+    TEST_ASSERT_TRUE(std::isnan(fourth_root(NAN)));
+    TEST_ASSERT_TRUE(std::isinf(fourth_root(INFINITY)));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fourth_root(1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, fourth_root(16.0f));
+    TEST_ASSERT_EQUAL_FLOAT(300.0f, fourth_root(8.1e9f));
+}
+
+void test_fixed_point_fourth_root(void)
+{
+    TEST_ASSERT_EQUAL_INT32(0, fixed_point_fourth_root<16>(0));
+    TEST_ASSERT_EQUAL_INT32(-1, fixed_point_fourth_root<16>(-1));
+    TEST_ASSERT_EQUAL_INT32(300 << 16, fixed_point_fourth_root<16>(int64_t{8'100'000'000}));
+
+    // every normalization shift from 1 to 2^48, steps through the seed table intervals
+    double max_error = 0.0;
+    for (int64_t value = 1; value < (int64_t{1} << 48); value += value / 4099 + 1) {
+        auto expected = std::pow(static_cast<double>(value), 0.25);
+        auto root = fixed_point_fourth_root<16>(value) / 65536.0;
+        // half a step of the 16 fraction bits, relative to the root
+        max_error = std::max(max_error, std::fabs(root - expected) / expected - 0.5 / 65536 / expected);
+    }
+    char message[80];
+    snprintf(message, sizeof(message), "fixed point: max relative error %.3g", max_error);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(max_error < FOURTH_ROOT_MAX_RELATIVE_ERROR);
+}
+
+void test_fourth_root_benchmark(void)
+{
+    // the inputs of the To calculation, -40 to 400 C
+    std::vector<float> inputs;
+    for (float kelvin = 233.0f; kelvin < 673.0f; kelvin += 0.1f) {
+        inputs.push_back(kelvin * kelvin * kelvin * kelvin);
+    }
+    auto sqrt_ns = nanoseconds_per_root(inputs, [](float value) { return std::sqrt(std::sqrt(value)); });
+    auto pow_ns = nanoseconds_per_root(inputs, [](float value) { return static_cast<float>(std::pow(double{value}, 0.25)); });
+    auto fourth_root_ns = nanoseconds_per_root(inputs, [](float value) { return fourth_root(value); });
+    auto fixed_point_ns = nanoseconds_per_root(inputs, [](float value) {
+        return static_cast<float>(fixed_point_fourth_root<16>(static_cast<int64_t>(value)));
+    });
+
+    // the host has hardware sqrt, the target cycles are printed by the firmware with DEBUG_OUTPUT
+    char message[200];
+    snprintf(message, sizeof(message),
+             "per root: sqrt(sqrt()) %.1f ns, pow %.1f ns, fourth_root %.1f ns, fixed point %.1f ns "
+             "(target %lu cycles on the ESP32-C3)",
+             sqrt_ns, pow_ns, fourth_root_ns, fixed_point_ns, static_cast<unsigned long>(FOURTH_ROOT_TARGET_CYCLES));
+    TEST_MESSAGE(message);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_float_of_the_physical_range);
+    RUN_TEST(test_whole_float_range);
+    RUN_TEST(test_special_values_follow_sqrt);
+    RUN_TEST(test_fixed_point_fourth_root);
+    RUN_TEST(test_fourth_root_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,318 @@
+#include <ArduinoFake.h>
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+#include <vector>
+
+#include "benchmark.h"
+#include "hotspot_blobs.h"
+#include "mlx_capture.h"
+#include "mlx_fixed_point_calibration.h"
+#include "mlx_reference_data.h"
+#include "pseudo_random.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+
+constexpr float THRESHOLD = 40.0f;
+constexpr uint32_t CAPTURE_FRAMES = 64;
+
+std::vector<uint8_t> capture;
+size_t read_offset = 0;
+pseudo_random::Lcg scene_random;
+
+// flood fill over the 8 neighbours, blobs sorted like HotspotLabeler::blobs()
+std::vector<HotspotBlob> flood_fill_blobs(const ThermoImage &frame, float threshold)
+{
+    std::vector<HotspotBlob> blobs;
+    std::array<bool, MLX_PIXEL_COUNT> is_visited{};
+    for (size_t seed = 0; seed < MLX_PIXEL_COUNT; seed++) {
+        if (is_visited[seed] || !(frame[seed] > threshold)) {
+            continue;
+        }
+        HotspotBlob blob{0, static_cast<uint16_t>(seed), -INFINITY, 0.0f, 0.0f, 0.0f};
+        double sum = 0.0, weight_sum = 0.0, x_sum = 0.0, y_sum = 0.0;
+        std::vector<size_t> stack{seed};
+        is_visited[seed] = true;
+        while (!stack.empty()) {
+            auto pixel_index = stack.back();
+            stack.pop_back();
+            int row = pixel_index / MLX_SENSOR_WIDTH;
+            int column = pixel_index % MLX_SENSOR_WIDTH;
+            auto temperature = frame[pixel_index];
+            blob.area++;
+            if (temperature > blob.peak_temp || (temperature == blob.peak_temp && pixel_index < blob.peak_index)) {
+                blob.peak_temp = temperature;
+                blob.peak_index = static_cast<uint16_t>(pixel_index);
+            }
+            sum += temperature;
+            weight_sum += temperature - threshold;
+            x_sum += (temperature - threshold) * column;
+            y_sum += (temperature - threshold) * row;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int y = row + dy;
+                    int x = column + dx;
+                    if (y < 0 || y >= static_cast<int>(MLX_SENSOR_HEIGHT) || x < 0 ||
+                        x >= static_cast<int>(MLX_SENSOR_WIDTH)) {
+                        continue;
+                    }
+                    size_t neighbour = y * MLX_SENSOR_WIDTH + x;
+                    if (!is_visited[neighbour] && frame[neighbour] > threshold) {
+                        is_visited[neighbour] = true;
+                        stack.push_back(neighbour);
+                    }
+                }
+            }
+        }
+        blob.mean_temp = sum / blob.area;
+        blob.centroid_x = x_sum / weight_sum;
+        blob.centroid_y = y_sum / weight_sum;
+        blobs.push_back(blob);
+    }
+    std::stable_sort(blobs.begin(), blobs.end(),
+                     [](const HotspotBlob &a, const HotspotBlob &b) { return a.peak_temp > b.peak_temp; });
+    return blobs;
+}
+
+void assert_blobs_match_flood_fill(const HotspotLabeler &labeler, const ThermoImage &frame, float threshold)
+{
+    auto expected = flood_fill_blobs(frame, threshold);
+    TEST_ASSERT_EQUAL(std::min(expected.size(), HOTSPOT_MAX_BLOB_COUNT), labeler.blob_count());
+    for (size_t i = 0; i < labeler.blob_count(); i++) {
+        const auto &blob = labeler.blobs()[i];
+        TEST_ASSERT_EQUAL_UINT16(expected[i].area, blob.area);
+        TEST_ASSERT_EQUAL_UINT16(expected[i].peak_index, blob.peak_index);
+        TEST_ASSERT_EQUAL_FLOAT(expected[i].peak_temp, blob.peak_temp);
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, expected[i].mean_temp, blob.mean_temp);
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, expected[i].centroid_x, blob.centroid_x);
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, expected[i].centroid_y, blob.centroid_y);
+    }
+}
+
+// frame at 25 C with the pixels of the pattern ('#') at 50 C plus a little per pixel, so the peaks differ
+ThermoImage frame_from_pattern(const std::vector<const char *> &pattern)
+{
+    ThermoImage frame{};
+    frame.fill(25.0f);
+    for (size_t row = 0; row < pattern.size(); row++) {
+        for (size_t column = 0; pattern[row][column] != '\0'; column++) {
+            if (pattern[row][column] == '#') {
+                auto pixel_index = row * MLX_SENSOR_WIDTH + column;
+                frame[pixel_index] = 50.0f + pixel_index * 0.01f;
+            }
+        }
+    }
+    return frame;
+}
+
+// Records a session of the reference sensor with three hot objects crossing the scene, a 3 x 3 one, a U-shaped one
+// and a single pixel, about +40 to +65 C
+void record_capture()
+{
+    capture.clear();
+    read_offset = 0;
+    MlxCaptureWriter writer([](const uint8_t *data, size_t size) {
+        capture.insert(capture.end(), data, data + size);
+        return size;
+    });
+    writer.begin(mlx_reference_data::EEPROM);
+    for (uint32_t frame = 0; frame < CAPTURE_FRAMES; frame++) {
+        for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[subpage_number];
+            auto add = [&subpage_frame](int row, int column, int counts) {
+                if (row >= 0 && row < static_cast<int>(MLX_SENSOR_HEIGHT) && column >= 0 &&
+                    column < static_cast<int>(MLX_SENSOR_WIDTH)) {
+                    subpage_frame[row * MLX_SENSOR_WIDTH + column] += counts;
+                }
+            };
+            int x = frame / 2;
+            for (int dy = 0; dy < 3; dy++) {
+                for (int dx = 0; dx < 3; dx++) {
+                    add(4 + dy, x + dx, 300);
+                }
+            }
+            for (int dy = 0; dy < 4; dy++) {
+                add(12 + dy, 28 - x / 2, 250);
+                add(12 + dy, 31 - x / 2, 250);
+            }
+            for (int dx = 0; dx < 4; dx++) {
+                add(15, 28 - x / 2 + dx, 250);
+            }
+            add(20, (3 * frame) % MLX_SENSOR_WIDTH, 400);
+            writer.record(subpage_frame, frame * 125);
+            TEST_ASSERT_TRUE(writer.drain());
+        }
+    }
+}
+
+// calculated frames of the capture
+std::vector<ThermoImage> replay_capture()
+{
+    read_offset = 0;
+    MlxCaptureReader reader([](uint8_t *data, size_t size) {
+        auto count = std::min(size, capture.size() - read_offset);
+        memcpy(data, capture.data() + read_offset, count);
+        read_offset += count;
+        return count;
+    });
+    TEST_ASSERT_TRUE(reader.begin() == CaptureReadResult::OK);
+    Adafruit_MLX90640 mlx;
+    TEST_ASSERT_TRUE(mlx.loadEEPROM(reader.eeprom().data()));
+    MlxFixedPointCalibration calibration(mlx.getParams());
+    std::vector<ThermoImage> frames;
+    ThermoImage temperatures{};
+    CaptureRecord record;
+    for (uint32_t subpage_count = 1; reader.next(record) == CaptureReadResult::OK; subpage_count++) {
+        calibration.calculate_subpage(record.subpage.data(), temperatures.data());
+        if (subpage_count % 2 == 0) {
+            frames.push_back(temperatures);
+        }
+    }
+    return frames;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    if (capture.empty()) {
+        record_capture();
+    }
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_threshold_mask(void)
+{
+    auto frame = frame_from_pattern({"#..#", "...........................#####"});
+    frame[40] = NAN;
+    MlxPixelBitmap mask;
+    threshold_mask(frame, THRESHOLD, mask);
+    TEST_ASSERT_EQUAL_HEX32(0b1001, mask.row(0));
+    TEST_ASSERT_EQUAL_HEX32(0xF8000000, mask.row(1));
+    TEST_ASSERT_EQUAL(7, mask.count());
+}
+
+void test_shapes_match_flood_fill(void)
+{
+    // a U joined only in its last row, diagonal neighbours, a full row, a blob in the corner
+    auto frame = frame_from_pattern({
+            "#...#.......#..................#",
+            "#...#........#.................#",
+            "#...#.........#.................",
+            "#####...........................",
+            "................................",
+            "################################",
+            "................................",
+            "..#.#.#.........................",
+            "...#.#..........................",
+    });
+    frame[23 * MLX_SENSOR_WIDTH + 31] = 60.0f;
+    HotspotLabeler labeler;
+    TEST_ASSERT_EQUAL(6, labeler.update(frame, THRESHOLD));
+    assert_blobs_match_flood_fill(labeler, frame, THRESHOLD);
+    // the U in one piece
+    auto u_blob = std::find_if(labeler.blobs().begin(), labeler.blobs().end(),
+                               [](const HotspotBlob &blob) { return blob.area == 11; });
+    TEST_ASSERT_TRUE(u_blob != labeler.blobs().end());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 2.0f, u_blob->centroid_x);
+
+    // blobs smaller than min_area are left out
+    TEST_ASSERT_EQUAL(3, labeler.update(frame, THRESHOLD, 4));
+}
+
+void test_random_frames_match_flood_fill(void)
+{
+    HotspotLabeler labeler;
+    for (int round = 0; round < 50; round++) {
+        ThermoImage frame{};
+        // sparse to dense
+        uint32_t density = 10 + round;
+        for (auto &temperature : frame) {
+            auto is_hot = scene_random.next_24_bits() % 100 < density;
+            temperature = is_hot ? 41.0f + scene_random.next_24_bits() % 1000 * 0.01f : 30.0f;
+        }
+        labeler.update(frame, THRESHOLD);
+        assert_blobs_match_flood_fill(labeler, frame, THRESHOLD);
+    }
+}
+
+void test_blob_capacity(void)
+{
+    // every other pixel of every other row: 192 single pixel blobs
+    ThermoImage frame{};
+    frame.fill(20.0f);
+    for (size_t row = 0; row < MLX_SENSOR_HEIGHT; row += 2) {
+        for (size_t column = 0; column < MLX_SENSOR_WIDTH; column += 2) {
+            frame[row * MLX_SENSOR_WIDTH + column] = 45.0f + scene_random.next_24_bits() % 1000 * 0.01f;
+        }
+    }
+    HotspotLabeler labeler;
+    TEST_ASSERT_EQUAL(HOTSPOT_MAX_BLOB_COUNT, labeler.update(frame, THRESHOLD));
+    TEST_ASSERT_EQUAL(192 - HOTSPOT_MAX_BLOB_COUNT, labeler.dropped_blob_count());
+    assert_blobs_match_flood_fill(labeler, frame, THRESHOLD);
+
+    // a run on every other pixel of every row, the worst case of the label storage, joins into one blob
+    for (size_t row = 1; row < MLX_SENSOR_HEIGHT; row += 2) {
+        for (size_t column = 0; column < MLX_SENSOR_WIDTH; column += 2) {
+            frame[row * MLX_SENSOR_WIDTH + column + 1] = 45.0f;
+        }
+    }
+    TEST_ASSERT_EQUAL(1, labeler.update(frame, THRESHOLD));
+    TEST_ASSERT_EQUAL_UINT16(MLX_PIXEL_COUNT / 2, labeler.blobs()[0].area);
+}
+
+void test_recorded_scene_and_benchmark(void)
+{
+    constexpr uint32_t CALLS = 20;
+    auto frames = replay_capture();
+    TEST_ASSERT_EQUAL(CAPTURE_FRAMES, frames.size());
+    HotspotLabeler labeler;
+    size_t blob_sum = 0;
+    for (const auto &frame : frames) {
+        labeler.update(frame, THRESHOLD);
+        assert_blobs_match_flood_fill(labeler, frame, THRESHOLD);
+        blob_sum += labeler.blob_count();
+    }
+    TEST_ASSERT_TRUE(blob_sum >= 2 * frames.size());
+
+    auto labeling_us = microseconds_per_call(
+            [&]() {
+                for (const auto &frame : frames) {
+                    labeler.update(frame, THRESHOLD);
+                }
+            },
+            CALLS) / frames.size();
+    auto flood_fill_us = microseconds_per_call(
+            [&]() {
+                for (const auto &frame : frames) {
+                    blob_sum += flood_fill_blobs(frame, THRESHOLD).size();
+                }
+            },
+            CALLS) / frames.size();
+
+    report("recorded scene, %.1f blobs per frame: labeling %.2f us per frame (flood fill %.2f us)",
+           static_cast<double>(blob_sum) / (frames.size() * (1 + 5 * CALLS)), labeling_us, flood_fill_us);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_threshold_mask);
+    RUN_TEST(test_shapes_match_flood_fill);
+    RUN_TEST(test_random_frames_match_flood_fill);
+    RUN_TEST(test_blob_capacity);
+    RUN_TEST(test_recorded_scene_and_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,218 @@
+#include <ArduinoFake.h>
+#include <cmath>
+#include <vector>
+
+#include "benchmark.h"
+#include "hotspot_blobs.h"
+#include "hotspot_tracker.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+
+constexpr float THRESHOLD = 40.0f;
+
+HotspotBlob blob_at(float x, float y, float peak_temp = 50.0f)
+{
+    return {4, 0, peak_temp, peak_temp - 2.0f, x, y};
+}
+
+const HotspotTrack *track_with_id(const HotspotTracker &tracker, uint16_t id)
+{
+    for (size_t i = 0; i < tracker.track_count(); i++) {
+        if (tracker.tracks()[i].id == id) {
+            return &tracker.tracks()[i];
+        }
+    }
+    return nullptr;
+}
+
+// 25 C frame with a hot 2 x 2 object at each position, 60 C minus a little per object so the peaks differ
+ThermoImage frame_with_objects(const std::vector<std::pair<float, float>> &positions)
+{
+    ThermoImage frame{};
+    frame.fill(25.0f);
+    for (size_t object = 0; object < positions.size(); object++) {
+        auto column = static_cast<int>(std::lround(positions[object].first));
+        auto row = static_cast<int>(std::lround(positions[object].second));
+        for (int dy = 0; dy < 2; dy++) {
+            for (int dx = 0; dx < 2; dx++) {
+                auto y = row + dy;
+                auto x = column + dx;
+                if (y >= 0 && y < static_cast<int>(MLX_SENSOR_HEIGHT) && x >= 0 &&
+                    x < static_cast<int>(MLX_SENSOR_WIDTH)) {
+                    frame[y * MLX_SENSOR_WIDTH + x] = 60.0f - object - dx * 0.5f;
+                }
+            }
+        }
+    }
+    return frame;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_moving_blob_keeps_its_id(void)
+{
+    HotspotTracker tracker;
+    for (int frame = 0; frame < 20; frame++) {
+        auto blob = blob_at(2.0f + 0.5f * frame, 20.0f - 0.25f * frame);
+        TEST_ASSERT_EQUAL(1, tracker.update(&blob, 1));
+        const auto &track = tracker.tracks()[0];
+        TEST_ASSERT_EQUAL_UINT16(1, track.id);
+        TEST_ASSERT_EQUAL_UINT16(frame, track.age);
+        TEST_ASSERT_EQUAL_FLOAT(blob.centroid_x, track.x);
+        TEST_ASSERT_EQUAL_FLOAT(blob.centroid_y, track.y);
+    }
+    // exact from the second frame on
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, tracker.tracks()[0].velocity_x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -0.25f, tracker.tracks()[0].velocity_y);
+}
+
+void test_prediction_keeps_crossing_ids(void)
+{
+    // two blobs passing each other 1 pixel apart at 1.5 pixels per frame, the predictions tell them apart
+    HotspotTracker tracker(2.0f);
+    for (int frame = 0; frame < 16; frame++) {
+        std::array<HotspotBlob, 2> blobs{blob_at(4.0f + 1.5f * frame, 10.0f, 55.0f),
+                                         blob_at(28.0f - 1.5f * frame, 11.0f, 50.0f)};
+        TEST_ASSERT_EQUAL(2, tracker.update(blobs.data(), blobs.size()));
+        auto *right = track_with_id(tracker, 1);
+        auto *left = track_with_id(tracker, 2);
+        TEST_ASSERT_NOT_NULL(right);
+        TEST_ASSERT_NOT_NULL(left);
+        TEST_ASSERT_EQUAL_FLOAT(blobs[0].centroid_x, right->x);
+        TEST_ASSERT_EQUAL_FLOAT(blobs[1].centroid_x, left->x);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -1.5f, track_with_id(tracker, 2)->velocity_x);
+}
+
+void test_missed_frames_coast_and_end(void)
+{
+    HotspotTracker tracker(2.0f, 3);
+    for (int frame = 0; frame < 5; frame++) {
+        auto blob = blob_at(5.0f + frame, 12.0f);
+        tracker.update(&blob, 1);
+    }
+    // hidden for three frames, the track goes on at its velocity
+    for (int frame = 5; frame < 8; frame++) {
+        TEST_ASSERT_EQUAL(1, tracker.update(nullptr, 0));
+        TEST_ASSERT_EQUAL_UINT16(frame - 4, tracker.tracks()[0].missed_frames);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, 5.0f + frame, tracker.tracks()[0].x);
+    }
+    // back a little slower, the velocity follows half of the error
+    auto blob = blob_at(12.6f, 12.0f);
+    tracker.update(&blob, 1);
+    const auto &track = tracker.tracks()[0];
+    TEST_ASSERT_EQUAL_UINT16(1, track.id);
+    TEST_ASSERT_EQUAL_UINT16(8, track.age);
+    TEST_ASSERT_EQUAL_UINT16(0, track.missed_frames);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f + 0.5f * (12.6f - 13.0f) / 4, track.velocity_x);
+
+    for (int frame = 0; frame < 4; frame++) {
+        tracker.update(nullptr, 0);
+    }
+    TEST_ASSERT_EQUAL(0, tracker.track_count());
+    blob = blob_at(20.0f, 12.0f);
+    tracker.update(&blob, 1);
+    TEST_ASSERT_EQUAL_UINT16(2, tracker.tracks()[0].id);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, tracker.tracks()[0].velocity_x);
+}
+
+void test_track_capacity_and_gate(void)
+{
+    // hottest first like the blobs of HotspotLabeler
+    std::array<HotspotBlob, HOTSPOT_MAX_BLOB_COUNT> blobs{};
+    for (size_t i = 0; i < blobs.size(); i++) {
+        blobs[i] = blob_at(2.0f * i, 2.0f + i, 70.0f - i);
+    }
+    HotspotTracker tracker(1.0f);
+    TEST_ASSERT_EQUAL(HOTSPOT_MAX_TRACK_COUNT, tracker.update(blobs.data(), blobs.size()));
+    for (size_t i = 0; i < tracker.track_count(); i++) {
+        TEST_ASSERT_EQUAL_FLOAT(blobs[i].peak_temp, tracker.tracks()[i].peak_temp);
+    }
+    // the hottest jumps beyond the gate: its track coasts and there is no room for a new one
+    blobs[0].centroid_x += 5.0f;
+    TEST_ASSERT_EQUAL(HOTSPOT_MAX_TRACK_COUNT, tracker.update(blobs.data(), blobs.size()));
+    TEST_ASSERT_EQUAL_UINT16(1, tracker.tracks()[0].missed_frames);
+    TEST_ASSERT_NULL(track_with_id(tracker, HOTSPOT_MAX_TRACK_COUNT + 1));
+
+    tracker.reset();
+    TEST_ASSERT_EQUAL(HOTSPOT_MAX_TRACK_COUNT, tracker.update(blobs.data(), blobs.size()));
+    TEST_ASSERT_EQUAL_UINT16(HOTSPOT_MAX_TRACK_COUNT + 1, tracker.tracks()[0].id);
+}
+
+void test_labeled_scene_and_benchmark(void)
+{
+    constexpr uint32_t FRAME_COUNT = 48;
+    constexpr uint32_t CALLS = 20;
+    // three objects moving across the frame at different speeds
+    std::vector<ThermoImage> frames;
+    for (uint32_t frame = 0; frame < FRAME_COUNT; frame++) {
+        frames.push_back(frame_with_objects(
+                {{0.5f * frame, 3.0f}, {29.0f - 0.4f * frame, 10.0f + 0.2f * frame}, {15.0f, 20.0f - 0.3f * frame}}));
+    }
+    HotspotLabeler labeler;
+    HotspotTracker tracker;
+    for (const auto &frame : frames) {
+        labeler.update(frame, THRESHOLD);
+        TEST_ASSERT_EQUAL(3, tracker.update(labeler));
+    }
+    for (uint16_t id = 1; id <= 3; id++) {
+        auto *track = track_with_id(tracker, id);
+        TEST_ASSERT_NOT_NULL(track);
+        TEST_ASSERT_EQUAL_UINT16(FRAME_COUNT - 1, track->age);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 0.5f, track_with_id(tracker, 1)->velocity_x);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, -0.4f, track_with_id(tracker, 2)->velocity_x);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, -0.3f, track_with_id(tracker, 3)->velocity_y);
+
+    // the blobs of all frames kept for the tracker alone
+    std::vector<std::array<HotspotBlob, HOTSPOT_MAX_BLOB_COUNT>> blobs;
+    std::vector<size_t> blob_counts;
+    for (const auto &frame : frames) {
+        blob_counts.push_back(labeler.update(frame, THRESHOLD));
+        blobs.push_back(labeler.blobs());
+    }
+    auto labeling_us = microseconds_per_call(
+            [&]() {
+                for (const auto &frame : frames) {
+                    labeler.update(frame, THRESHOLD);
+                }
+            },
+            CALLS) / FRAME_COUNT;
+    auto tracking_us = microseconds_per_call(
+            [&]() {
+                for (size_t frame = 0; frame < FRAME_COUNT; frame++) {
+                    tracker.update(blobs[frame].data(), blob_counts[frame]);
+                }
+            },
+            CALLS) / FRAME_COUNT;
+
+    report("per frame with 3 hotspots: tracker %.3f us, labeling %.2f us", tracking_us, labeling_us);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_moving_blob_keeps_its_id);
+    RUN_TEST(test_prediction_keeps_crossing_ids);
+    RUN_TEST(test_missed_frames_coast_and_end);
+    RUN_TEST(test_track_capacity_and_gate);
+    RUN_TEST(test_labeled_scene_and_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
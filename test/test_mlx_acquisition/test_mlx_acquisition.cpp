@@ -0,0 +1,282 @@
+#include "mlx_acquisition.h"
+#include "unity.h"
+
+using namespace thermocam;
+
+constexpr uint32_t SUBPAGE_PERIOD_MS = 125;
+
+// Scripted stand-in for the I2C layer: new data every period, counts the status register polls
+struct ScriptedMlxBus
+{
+    unsigned long now_ms = 0;
+    unsigned long next_ready_ms = SUBPAGE_PERIOD_MS;
+    uint16_t subpage = 0;
+    bool data_ready = false;
+    uint32_t status_polls = 0;
+    uint32_t ram_reads = 0;
+    uint32_t overwrite_during_next_reads = 0;
+    int fail_status_reads_with = 0;
+    // the next status reads fail with -1, then fail_status_reads_with applies again
+    uint32_t failing_status_reads = 0;
+
+    void advance_to(unsigned long time_ms)
+    {
+        now_ms = time_ms;
+        while (now_ms >= next_ready_ms) {
+            subpage ^= 1;
+            data_ready = true;
+            next_ready_ms += SUBPAGE_PERIOD_MS;
+        }
+    }
+
+    int read(uint16_t start_address, uint16_t word_count, uint16_t *data)
+    {
+        if (start_address == MLX_STATUS_REGISTER) {
+            status_polls++;
+            if (failing_status_reads > 0) {
+                failing_status_reads--;
+                return -1;
+            }
+            if (fail_status_reads_with != 0) {
+                return fail_status_reads_with;
+            }
+            data[0] = (data_ready ? MLX_STATUS_DATA_READY : 0) | subpage;
+            return 0;
+        }
+        if (start_address == MLX_CONTROL_REGISTER_1) {
+            data[0] = 0x1901;
+            return 0;
+        }
+        if (start_address == MLX_RAM_START_ADDRESS) {
+            ram_reads++;
+            for (uint16_t i = 0; i < word_count; i++) {
+                data[i] = i + subpage;
+            }
+            if (overwrite_during_next_reads > 0) {
+                overwrite_during_next_reads--;
+                data_ready = true;
+            }
+            return 0;
+        }
+        return -1;
+    }
+
+    int write(uint16_t address, uint16_t value)
+    {
+        if (address == MLX_STATUS_REGISTER && value == MLX_STATUS_CLEAR_DATA_READY) {
+            data_ready = false;
+        }
+        return 0;
+    }
+};
+
+ScriptedMlxBus bus;
+
+MlxSubpageAcquisition create_acquisition()
+{
+    return MlxSubpageAcquisition(
+            [](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                return bus.read(start_address, word_count, data);
+            },
+            [](uint16_t address, uint16_t value) { return bus.write(address, value); },
+            []() { return bus.now_ms; },
+            SUBPAGE_PERIOD_MS);
+}
+
+// drives the loop in 1 ms steps like loop() would and returns when a sub-page is ready
+bool run_until_ready(MlxSubpageAcquisition &acquisition, unsigned long timeout_ms)
+{
+    auto end_ms = bus.now_ms + timeout_ms;
+    while (bus.now_ms < end_ms) {
+        if (acquisition.poll() == AcquisitionState::READY) {
+            return true;
+        }
+        bus.advance_to(bus.now_ms + 1);
+    }
+    return false;
+}
+
+bool run_until_first_subpage(MlxSubpageAcquisition &acquisition)
+{
+    acquisition.begin_subpage();
+    if (!run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS)) {
+        return false;
+    }
+    acquisition.release_subpage();
+    return true;
+}
+
+void setUp(void)
+{
+    bus = ScriptedMlxBus();
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_state_transitions(void)
+{
+    auto acquisition = create_acquisition();
+    TEST_ASSERT_TRUE(acquisition.state() == AcquisitionState::IDLE);
+    TEST_ASSERT_TRUE(acquisition.poll() == AcquisitionState::IDLE);
+    TEST_ASSERT_EQUAL_UINT32(0, bus.status_polls);
+
+    acquisition.begin_subpage();
+    TEST_ASSERT_TRUE(acquisition.poll() == AcquisitionState::WAITING_FOR_READY);
+
+    TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    TEST_ASSERT_EQUAL_UINT16(0x1901, acquisition.subpage_frame()[MLX_CONTROL_REGISTER_WORD]);
+    TEST_ASSERT_EQUAL_UINT16(1, acquisition.subpage_frame()[MLX_SUBPAGE_NUMBER_WORD]);
+    TEST_ASSERT_EQUAL_UINT16(1, acquisition.subpage_frame()[0]);
+
+    acquisition.release_subpage();
+    TEST_ASSERT_TRUE(acquisition.state() == AcquisitionState::IDLE);
+}
+
+void test_no_status_polls_before_predicted_ready_time(void)
+{
+    auto acquisition = create_acquisition();
+    acquisition.begin_subpage();
+    TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    acquisition.release_subpage();
+
+    // once synchronized a whole frame (two sub-pages) must get along with a handful of polls
+    for (int frame = 0; frame < 10; frame++) {
+        auto polls_before_frame = bus.status_polls;
+        for (int subpage = 0; subpage < 2; subpage++) {
+            acquisition.begin_subpage();
+            TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+            TEST_ASSERT_LESS_OR_EQUAL_UINT32(2, acquisition.stats().status_polls_last_subpage);
+            acquisition.release_subpage();
+        }
+        // plus one status read per sub-page to detect data overwritten during the RAM transfer
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(2 * 2 + 2, bus.status_polls - polls_before_frame);
+    }
+    TEST_ASSERT_EQUAL_UINT32(bus.status_polls, acquisition.stats().status_polls_total + 21);
+    TEST_ASSERT_EQUAL_UINT32(21, acquisition.stats().subpages_read);
+}
+
+void test_first_subpage_is_polled_every_interval(void)
+{
+    auto acquisition = create_acquisition();
+    acquisition.begin_subpage();
+    TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    // no phase information yet -> one poll per ms until the first data ready
+    TEST_ASSERT_EQUAL_UINT32(SUBPAGE_PERIOD_MS + 1, acquisition.stats().status_polls_last_subpage);
+}
+
+void test_overwritten_ram_is_read_again(void)
+{
+    auto acquisition = create_acquisition();
+    acquisition.begin_subpage();
+    bus.overwrite_during_next_reads = 2;
+    TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    TEST_ASSERT_EQUAL_UINT32(3, bus.ram_reads);
+    TEST_ASSERT_EQUAL_UINT32(2, acquisition.stats().read_retries);
+}
+
+void test_too_many_overwrites_fail(void)
+{
+    auto acquisition = create_acquisition();
+    acquisition.begin_subpage();
+    bus.overwrite_during_next_reads = MLX_MAX_SUBPAGE_READ_ATTEMPTS;
+    TEST_ASSERT_FALSE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    TEST_ASSERT_TRUE(acquisition.state() == AcquisitionState::IDLE);
+    TEST_ASSERT_EQUAL_INT(MLX_ERROR_TOO_MANY_RETRIES, acquisition.last_error());
+    TEST_ASSERT_EQUAL_UINT32(MLX_MAX_SUBPAGE_READ_ATTEMPTS, bus.ram_reads);
+}
+
+void test_bus_error_is_reported_after_retry_budget(void)
+{
+    auto acquisition = create_acquisition();
+    acquisition.begin_subpage();
+    bus.fail_status_reads_with = -1;
+    TEST_ASSERT_TRUE(acquisition.poll() == AcquisitionState::WAITING_FOR_READY);
+    TEST_ASSERT_FALSE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    TEST_ASSERT_TRUE(acquisition.state() == AcquisitionState::IDLE);
+    TEST_ASSERT_EQUAL_INT(-1, acquisition.last_error());
+    TEST_ASSERT_EQUAL_UINT32(1, acquisition.stats().errors);
+    // retried every poll interval until the budget was used up
+    TEST_ASSERT_EQUAL_UINT32(SUBPAGE_PERIOD_MS / MLX_RETRY_BUDGET_DIVISOR + 1, acquisition.stats().bus_errors);
+
+    bus.fail_status_reads_with = 0;
+    acquisition.begin_subpage();
+    TEST_ASSERT_EQUAL_INT(0, acquisition.last_error());
+    TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+}
+
+void test_transient_bus_errors_are_recovered(void)
+{
+    auto acquisition = create_acquisition();
+    TEST_ASSERT_TRUE(run_until_first_subpage(acquisition));
+
+    acquisition.begin_subpage();
+    bus.failing_status_reads = 2;
+    TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    TEST_ASSERT_EQUAL_INT(0, acquisition.last_error());
+    TEST_ASSERT_EQUAL_UINT32(2, acquisition.stats().bus_errors);
+    TEST_ASSERT_EQUAL_UINT32(1, acquisition.stats().recovered_errors);
+    TEST_ASSERT_EQUAL_UINT32(0, acquisition.stats().errors);
+    TEST_ASSERT_EQUAL_UINT32(0, acquisition.stats().bus_resets); // below MLX_BUS_RESET_AFTER_ERRORS
+}
+
+void test_repeated_bus_errors_reset_the_bus(void)
+{
+    auto acquisition = create_acquisition();
+    uint32_t resets = 0;
+    acquisition.set_bus_reset_function([&resets]() {
+        resets++;
+        bus.fail_status_reads_with = 0; // slave released SDA
+        return true;
+    });
+    acquisition.begin_subpage();
+    bus.fail_status_reads_with = -1;
+    TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    TEST_ASSERT_EQUAL_UINT32(1, resets);
+    TEST_ASSERT_EQUAL_UINT32(1, acquisition.stats().bus_resets);
+    TEST_ASSERT_EQUAL_UINT32(MLX_BUS_RESET_AFTER_ERRORS, acquisition.stats().bus_errors);
+    TEST_ASSERT_EQUAL_UINT32(1, acquisition.stats().recovered_errors);
+}
+
+void test_lost_subpage_keeps_the_sensor_timing(void)
+{
+    auto acquisition = create_acquisition();
+    TEST_ASSERT_TRUE(run_until_first_subpage(acquisition));
+    auto first_ready_time = acquisition.last_ready_time();
+
+    // the bus is dead for the whole next sub-page
+    acquisition.begin_subpage();
+    bus.fail_status_reads_with = -1;
+    TEST_ASSERT_FALSE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    TEST_ASSERT_TRUE(acquisition.state() == AcquisitionState::IDLE);
+
+    // polling for the one after starts at its predicted ready time and not right away
+    bus.fail_status_reads_with = 0;
+    acquisition.begin_subpage();
+    TEST_ASSERT_EQUAL_UINT32(first_ready_time + 2 * SUBPAGE_PERIOD_MS - 1, acquisition.next_poll_time());
+    TEST_ASSERT_TRUE(run_until_ready(acquisition, 2 * SUBPAGE_PERIOD_MS));
+    TEST_ASSERT_EQUAL_UINT32(first_ready_time + 2 * SUBPAGE_PERIOD_MS, acquisition.last_ready_time());
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_state_transitions);
+    RUN_TEST(test_no_status_polls_before_predicted_ready_time);
+    RUN_TEST(test_first_subpage_is_polled_every_interval);
+    RUN_TEST(test_overwritten_ram_is_read_again);
+    RUN_TEST(test_too_many_overwrites_fail);
+    RUN_TEST(test_bus_error_is_reported_after_retry_budget);
+    RUN_TEST(test_transient_bus_errors_are_recovered);
+    RUN_TEST(test_repeated_bus_errors_reset_the_bus);
+    RUN_TEST(test_lost_subpage_keeps_the_sensor_timing);
+    return UNITY_END();
+}
+
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,196 @@
+#include <ArduinoFake.h>
+#include <algorithm>
+#include <initializer_list>
+
+#include "benchmark.h"
+#include "mlx_bad_pixels.h"
+#include "mlx_fixed_point_calibration.h"
+#include "mlx_reference_data.h"
+#include "pseudo_random.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+
+// MLX90640_API.cpp
+float GetMedian(float *values, int n);
+
+Adafruit_MLX90640 *mlx = nullptr;
+
+// reference EEPROM with the pixels marked broken (pixel word 0) or outlier (bit 0 set), at most four in total
+void load_bad_pixels(std::initializer_list<uint16_t> broken, std::initializer_list<uint16_t> outliers)
+{
+    auto eeprom = mlx_reference_data::EEPROM;
+    for (auto pixel_index : broken) {
+        eeprom[64 + pixel_index] = 0;
+    }
+    for (auto pixel_index : outliers) {
+        eeprom[64 + pixel_index] |= 1;
+    }
+    TEST_ASSERT_TRUE(mlx->loadEEPROM(eeprom.data()));
+}
+
+// noisy frame around 25 C
+ThermoImage random_frame()
+{
+    static pseudo_random::Lcg random;
+    ThermoImage frame{};
+    for (auto &temperature : frame) {
+        temperature = 25.0f + 16.0f * random.uniform();
+    }
+    return frame;
+}
+
+void assert_matches_reference(Mlx90640PixelReadoutMode readout_mode)
+{
+    MlxBadPixelCorrection correction(mlx->getParams());
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    if (readout_mode == Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED) {
+        subpage_frame[MLX_CONTROL_REGISTER_WORD] &= ~MLX_CONTROL_CHESS_MODE;
+    }
+    for (int frame = 0; frame < 20; frame++) {
+        auto reference = random_frame();
+        auto corrected = reference;
+        mlx->correctBadPixels(subpage_frame.data(), reference.data());
+        correction.correct_subpage(0, readout_mode, corrected.data());
+        correction.correct_subpage(1, readout_mode, corrected.data());
+        TEST_ASSERT_EQUAL_MEMORY(reference.data(), corrected.data(), sizeof(float) * reference.size());
+    }
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    mlx = new Adafruit_MLX90640();
+}
+
+void tearDown(void)
+{
+    delete mlx;
+}
+
+void test_median_of_four_matches_reference(void)
+{
+    std::array<float, 4> values = {3.0f, -1.5f, 7.25f, 3.0f};
+    for (int round = 0; round < 50; round++) {
+        std::sort(values.begin(), values.end());
+        do {
+            auto reference_values = values;
+            TEST_ASSERT_EQUAL_FLOAT(GetMedian(reference_values.data(), 4),
+                                    median_of_four(values[0], values[1], values[2], values[3]));
+        } while (std::next_permutation(values.begin(), values.end()));
+        auto frame = random_frame();
+        std::copy_n(frame.begin(), values.size(), values.begin());
+    }
+}
+
+void test_bitmap_marks_eeprom_pixels(void)
+{
+    load_bad_pixels({5, 700}, {300});
+    MlxBadPixelCorrection correction(mlx->getParams());
+    TEST_ASSERT_EQUAL(3, correction.bad_pixel_count());
+    TEST_ASSERT_EQUAL(3, correction.bad_pixels().count());
+    for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+        TEST_ASSERT_EQUAL(pixel_index == 5 || pixel_index == 300 || pixel_index == 700,
+                          correction.is_bad(pixel_index));
+    }
+
+    // a sensor without bad pixels leaves the frame alone
+    TEST_ASSERT_TRUE(mlx->loadEEPROM(mlx_reference_data::EEPROM.data()));
+    correction.compile(mlx->getParams());
+    TEST_ASSERT_EQUAL(0, correction.bad_pixel_count());
+    auto frame = random_frame();
+    auto corrected = frame;
+    correction.correct_subpage(0, Mlx90640PixelReadoutMode::MLX90640_CHESS, corrected.data());
+    TEST_ASSERT_EQUAL_MEMORY(frame.data(), corrected.data(), sizeof(float) * frame.size());
+}
+
+void test_corners_match_reference(void)
+{
+    // 0 and 31 count as adjacent for the EEPROM check
+    load_bad_pixels({0}, {767});
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_CHESS);
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED);
+    load_bad_pixels({31}, {736});
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_CHESS);
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED);
+}
+
+void test_borders_match_reference(void)
+{
+    load_bad_pixels({10, 160}, {287, 750});
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_CHESS);
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED);
+}
+
+void test_interior_matches_reference(void)
+{
+    // 302 is two pixels right of 300, interleaved mode falls back to the mean for both. 321 and 510 are in the
+    // second and second to last column.
+    load_bad_pixels({300, 321}, {302, 510});
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_CHESS);
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED);
+
+    load_bad_pixels({400, 500}, {600});
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_CHESS);
+    assert_matches_reference(Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED);
+}
+
+void test_correction_per_subpage_of_frame(void)
+{
+    // frame path of the firmware: each sub-page corrected right after its calculation
+    load_bad_pixels({400}, {500});
+    MlxBadPixelCorrection correction(mlx->getParams());
+    MlxFixedPointCalibration calibration(mlx->getParams());
+    ThermoImage reference{};
+    ThermoImage corrected{};
+    for (auto subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        calibration.calculate_subpage(subpage_frame.data(), reference.data());
+        calibration.calculate_subpage(subpage_frame.data(), corrected.data());
+        correction.correct_subpage(subpage_frame.data(), corrected.data());
+    }
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[1];
+    mlx->correctBadPixels(subpage_frame.data(), reference.data());
+    TEST_ASSERT_EQUAL_MEMORY(reference.data(), corrected.data(), sizeof(float) * reference.size());
+}
+
+void test_bad_pixel_benchmark(void)
+{
+    constexpr uint32_t CALLS = 500;
+    load_bad_pixels({300, 321}, {302, 510});
+    MlxBadPixelCorrection correction(mlx->getParams());
+    MlxFixedPointCalibration calibration(mlx->getParams());
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    auto temperatures = random_frame();
+    auto calculation_us = microseconds_per_call(
+            [&]() { calibration.calculate_subpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    auto correction_us = microseconds_per_call(
+            [&]() { correction.correct_subpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    // the reference corrects the full frame once, half of that per sub-page
+    auto reference_us = microseconds_per_call(
+            [&]() { mlx->correctBadPixels(subpage_frame.data(), temperatures.data()); }, CALLS) / 2;
+
+    report("per sub-page with 4 bad pixels: calculation %.2f us, correction %.3f us (reference %.3f us)",
+           calculation_us, correction_us, reference_us);
+    TEST_ASSERT_TRUE(correction_us < calculation_us / 100);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_median_of_four_matches_reference);
+    RUN_TEST(test_bitmap_marks_eeprom_pixels);
+    RUN_TEST(test_corners_match_reference);
+    RUN_TEST(test_borders_match_reference);
+    RUN_TEST(test_interior_matches_reference);
+    RUN_TEST(test_correction_per_subpage_of_frame);
+    RUN_TEST(test_bad_pixel_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,285 @@
+#include <ArduinoFake.h>
+#include <cmath>
+
+#include "benchmark.h"
+#include "mlx_calibration.h"
+#include "mlx_reference_comparison.h"
+#include "mlx_reference_data.h"
+#include "mlx_utils.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+using namespace thermocam::mlx_reference_comparison;
+
+Adafruit_MLX90640 *mlx = nullptr;
+MlxCalibration *calibration = nullptr;
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    mlx = new Adafruit_MLX90640();
+    TEST_ASSERT_TRUE(mlx->loadEEPROM(mlx_reference_data::EEPROM.data()));
+    calibration = new MlxCalibration(mlx->getParams());
+}
+
+void tearDown(void)
+{
+    delete calibration;
+    delete mlx;
+}
+
+void test_chess_mode_matches_reference(void)
+{
+    TEST_ASSERT_TRUE(calibration->is_compiled());
+    for (const auto &subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+        TEST_ASSERT_TRUE(calibration->last_context().is_calibration_mode);
+        // calculateSubpage stores the Ta it calculated
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, mlx->getTa(false), calibration->last_context().ta);
+    }
+}
+
+void test_interleaved_mode_matches_reference(void)
+{
+    for (auto subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        subpage_frame[MLX_CONTROL_REGISTER_WORD] &= ~MLX_CONTROL_CHESS_MODE;
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+        TEST_ASSERT_FALSE(calibration->last_context().is_calibration_mode);
+    }
+}
+
+void test_extended_temperature_ranges_match_reference(void)
+{
+    // roughly -40 to 400 C, covers all four ranges of the ksTo / ct correction
+    for (int raw_offset = -300; raw_offset <= 1500; raw_offset += 50) {
+        auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+        for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+            subpage_frame[pixel_index] = static_cast<uint16_t>(static_cast<int16_t>(subpage_frame[pixel_index]) +
+                                                               raw_offset);
+        }
+        // float instead of double rounding in the fourth roots, relative to about 300 to 700 K
+        TEST_ASSERT_FLOAT_WITHIN(5e-3f, 0.0f, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+    }
+}
+
+void test_resolution_changes_vdd_scale(void)
+{
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    auto reference_ta = calibration->prepare_subpage(subpage_frame.data()).ta;
+
+    // one bit more resolution doubles the Vdd reading
+    subpage_frame[MLX_CONTROL_REGISTER_WORD] += 1 << MLX_CONTROL_RESOLUTION_SHIFT;
+    subpage_frame[MLX_VDD_RAM_WORD] = static_cast<uint16_t>(2 * static_cast<int16_t>(subpage_frame[MLX_VDD_RAM_WORD]));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, reference_ta, calibration->prepare_subpage(subpage_frame.data()).ta);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+}
+
+void test_offset_cache_hits_in_steady_state(void)
+{
+    ThermoImage temperatures{};
+    for (int frame = 0; frame < 10; frame++) {
+        for (const auto &subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+            calibration->calculate_subpage(subpage_frame.data(), temperatures.data());
+        }
+    }
+    // one key per sub-page, their Vdd differs by 12 mV
+    TEST_ASSERT_EQUAL_UINT32(2, calibration->offset_cache_stats().rebuilds);
+    TEST_ASSERT_EQUAL_UINT32(18, calibration->offset_cache_stats().hits);
+
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    subpage_frame[MLX_CONTROL_REGISTER_WORD] &= ~MLX_CONTROL_CHESS_MODE;
+    calibration->calculate_subpage(subpage_frame.data(), temperatures.data());
+    TEST_ASSERT_EQUAL_UINT32(3, calibration->offset_cache_stats().rebuilds); // other pixels
+}
+
+void test_offset_cache_follows_ta_and_vdd_drift(void)
+{
+    MlxCalibration uncached(mlx->getParams());
+    uncached.set_offset_cache_epsilon(0.0f, 0.0f);
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    auto context = calibration->prepare_subpage(subpage_frame.data());
+    ThermoImage cached_temperatures{};
+    ThermoImage exact_temperatures{};
+    calibration->calculate_to(subpage_frame.data(), context, cached_temperatures.data());
+
+    auto drift = [&context](float ta_drift, float vdd_drift) {
+        context.ta += ta_drift;
+        context.delta_ta += ta_drift;
+        context.vdd += vdd_drift;
+        context.delta_vdd += vdd_drift;
+    };
+    auto max_difference = [&]() {
+        calibration->calculate_to(subpage_frame.data(), context, cached_temperatures.data());
+        uncached.calculate_to(subpage_frame.data(), context, exact_temperatures.data());
+        float max_difference = 0.0f;
+        for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+            max_difference = std::max(max_difference,
+                                      std::fabs(cached_temperatures[pixel_index] - exact_temperatures[pixel_index]));
+        }
+        return max_difference;
+    };
+
+    // just within the epsilons: the stale compensation stays close to the exact one
+    drift(0.9f * OFFSET_CACHE_TA_EPSILON, 0.9f * OFFSET_CACHE_VDD_EPSILON);
+    auto stale_difference = max_difference();
+    TEST_ASSERT_EQUAL_UINT32(1, calibration->offset_cache_stats().hits);
+    TEST_ASSERT_TRUE(stale_difference > 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, stale_difference);
+
+    // further drift from the key rebuilds
+    drift(0.2f * OFFSET_CACHE_TA_EPSILON, 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, max_difference());
+    TEST_ASSERT_EQUAL_UINT32(2, calibration->offset_cache_stats().rebuilds);
+    drift(0.0f, -0.2f * OFFSET_CACHE_VDD_EPSILON);
+    max_difference();
+    TEST_ASSERT_EQUAL_UINT32(2, calibration->offset_cache_stats().hits);
+    drift(0.0f, -OFFSET_CACHE_VDD_EPSILON);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, max_difference());
+    TEST_ASSERT_EQUAL_UINT32(3, calibration->offset_cache_stats().rebuilds);
+
+    report("max error within the epsilons %.4f C", stale_difference);
+}
+
+void test_single_pass_matches_reference_across_ranges(void)
+{
+    // scene heating by about 0.3 C per frame from -50 to 520 C, crosses the range boundaries at 0, 300 and 500 C
+    calibration->set_single_pass(true);
+    float max_difference = 0.0f;
+    uint32_t pixels = 0;
+    uint32_t fallbacks = 0;
+    for (int raw_offset = -200; raw_offset <= 9000; raw_offset += 2) {
+        for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            auto subpage_frame = shifted_subpage(subpage_number, raw_offset, 2);
+            max_difference = std::max(max_difference, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+            pixels += calibration->single_pass_stats().pixels;
+            fallbacks += calibration->single_pass_stats().fallbacks;
+        }
+    }
+
+    report("max error %.4f C, %.1f %% of the pixels with two passes", max_difference, 100.0f * fallbacks / pixels);
+    TEST_ASSERT_FLOAT_WITHIN(SINGLE_PASS_MAX_ERROR, 0.0f, max_difference);
+    TEST_ASSERT_TRUE(fallbacks < pixels / 2);
+}
+
+void test_single_pass_falls_back_on_scene_changes(void)
+{
+    calibration->set_single_pass(true);
+    for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        max_difference_to_reference(*mlx, *calibration, shifted_subpage(subpage_number, 0, 3));
+        // no anchors yet
+        TEST_ASSERT_EQUAL_UINT32(MLX_SUBPAGE_PIXEL_COUNT, calibration->single_pass_stats().fallbacks);
+    }
+
+    // noisy static scene: a single pass almost everywhere
+    for (int frame = 0; frame < 10; frame++) {
+        for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            auto subpage_frame = shifted_subpage(subpage_number, 0, 3);
+            TEST_ASSERT_FLOAT_WITHIN(1e-3f + SINGLE_PASS_MAX_ERROR, 0.0f,
+                                     max_difference_to_reference(*mlx, *calibration, subpage_frame));
+            TEST_ASSERT_EQUAL_UINT32(MLX_SUBPAGE_PIXEL_COUNT, calibration->single_pass_stats().pixels);
+            TEST_ASSERT_LESS_THAN(MLX_SUBPAGE_PIXEL_COUNT / 20, calibration->single_pass_stats().fallbacks);
+        }
+    }
+
+    // a hot object moves in: everything falls back and matches the reference
+    for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        auto subpage_frame = shifted_subpage(subpage_number, 3000);
+        TEST_ASSERT_FLOAT_WITHIN(5e-3f, 0.0f, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+        TEST_ASSERT_EQUAL_UINT32(MLX_SUBPAGE_PIXEL_COUNT, calibration->single_pass_stats().fallbacks);
+    }
+}
+
+void test_image_matches_get_image(void)
+{
+    for (auto subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        ThermoImage reference_image{};
+        ThermoImage image{};
+        ThermoImage reference{};
+        mlx->calculateSubpageImage(subpage_frame.data(), reference_image.data());
+        mlx->calculateSubpage(subpage_frame.data(), reference.data());
+        calibration->calculate_subpage_image(subpage_frame.data(), image.data());
+
+        // MLX90640_GetImage multiplies by the stored SCALEALPHA * 2^alphaScale / alpha, without emissivity and KsTa
+        auto context = calibration->last_context();
+        auto image_scale = SCALEALPHA * (1 << mlx->getParams().alphaScale) * DEFAULT_EMISSIVITY * context.alpha_ta;
+        for (auto pixel_index : subpage_pixel_indices(context.subpage_number, context.readout_mode)) {
+            // float rounding relative to Ta,r^4, about 0.001 C
+            TEST_ASSERT_FLOAT_WITHIN(1e-6f * context.ta_tr, image[pixel_index], reference_image[pixel_index] / image_scale);
+            TEST_ASSERT_FLOAT_WITHIN(1e-3f, reference[pixel_index],
+                                     calibration->image_to_temperature(pixel_index, image[pixel_index]));
+            TEST_ASSERT_FLOAT_WITHIN(1e-5f * context.ta_tr, image[pixel_index],
+                                     calibration->temperature_to_image(reference[pixel_index]));
+        }
+    }
+}
+
+void test_relative_image_stats_match_absolute(void)
+{
+    ThermoImage temperatures{};
+    ThermoImage image{};
+    for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        // a hot spot in each sub-page
+        auto subpage_frame = shifted_subpage(subpage_number, 0);
+        subpage_frame[301 - subpage_number] += 400;
+        calibration->calculate_subpage(subpage_frame.data(), temperatures.data());
+        calibration->calculate_subpage_image(subpage_frame.data(), image.data());
+    }
+    ThermoImageStats absolute_stats{};
+    ThermoImageStats relative_stats{};
+    mlx_utils::update_thermo_image_stats_from_frame(temperatures, absolute_stats);
+    mlx_utils::update_thermo_image_stats_from_image(image, relative_stats, [](size_t pixel_index, float image) {
+        return calibration->image_to_temperature(pixel_index, image);
+    });
+
+    TEST_ASSERT_EQUAL_UINT32(absolute_stats.min_temp_index, relative_stats.min_temp_index);
+    TEST_ASSERT_EQUAL_UINT32(absolute_stats.max_temp_index, relative_stats.max_temp_index);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, absolute_stats.min_temp, relative_stats.min_temp);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, absolute_stats.max_temp, relative_stats.max_temp);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, absolute_stats.center_temp, relative_stats.center_temp);
+    // temperature of the mean image against the mean temperature
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, absolute_stats.average_temp, relative_stats.average_temp);
+    TEST_ASSERT_TRUE(relative_stats.max_temp > absolute_stats.average_temp + 40.0f);
+}
+
+void test_compiled_kernel_is_faster(void)
+{
+    constexpr uint32_t CALLS = 500;
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    ThermoImage temperatures{};
+    auto reference_us = microseconds_per_call(
+            [&]() { mlx->calculateSubpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    auto compiled_us = microseconds_per_call(
+            [&]() { calibration->calculate_subpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    auto context = calibration->prepare_subpage(subpage_frame.data());
+    auto kernel_us = microseconds_per_call(
+            [&]() { calibration->calculate_to(subpage_frame.data(), context, temperatures.data()); }, CALLS);
+
+    report("per sub-page: reference %.1f us, compiled %.1f us (kernel %.1f us), %.2fx", reference_us, compiled_us,
+           kernel_us, reference_us / compiled_us);
+    TEST_ASSERT_TRUE(compiled_us < reference_us);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_chess_mode_matches_reference);
+    RUN_TEST(test_interleaved_mode_matches_reference);
+    RUN_TEST(test_extended_temperature_ranges_match_reference);
+    RUN_TEST(test_resolution_changes_vdd_scale);
+    RUN_TEST(test_offset_cache_hits_in_steady_state);
+    RUN_TEST(test_offset_cache_follows_ta_and_vdd_drift);
+    RUN_TEST(test_single_pass_matches_reference_across_ranges);
+    RUN_TEST(test_single_pass_falls_back_on_scene_changes);
+    RUN_TEST(test_image_matches_get_image);
+    RUN_TEST(test_relative_image_stats_match_absolute);
+    RUN_TEST(test_compiled_kernel_is_faster);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,238 @@
+#include <ArduinoFake.h>
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#include "mlx_acquisition.h"
+#include "mlx_capture.h"
+#include "mlx_reference_data.h"
+#include "mlx_simulator.h"
+#include "mlx_subpage_stream.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+std::vector<uint8_t> capture;
+size_t read_offset = 0;
+
+size_t write_to_capture(const uint8_t *data, size_t size)
+{
+    capture.insert(capture.end(), data, data + size);
+    return size;
+}
+
+size_t read_from_capture(uint8_t *data, size_t size)
+{
+    auto count = std::min(size, capture.size() - read_offset);
+    memcpy(data, capture.data() + read_offset, count);
+    read_offset += count;
+    return count;
+}
+
+MlxSubpageFrame make_subpage(uint16_t fill_value)
+{
+    MlxSubpageFrame subpage;
+    subpage.fill(fill_value);
+    return subpage;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), delay)).AlwaysReturn(); // settle time after register writes
+
+    capture.clear();
+    read_offset = 0;
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_header_and_records_round_trip(void)
+{
+    MlxCaptureWriter writer(write_to_capture);
+    writer.record(make_subpage(0x1111), 1); // before begin(), not part of the capture
+    writer.begin(mlx_reference_data::EEPROM);
+    writer.record(make_subpage(0xA5A5), 100);
+    writer.record(make_subpage(0x0102), 131);
+    TEST_ASSERT_TRUE(writer.drain());
+    TEST_ASSERT_EQUAL_UINT32(CAPTURE_HEADER_SIZE + 2 * CAPTURE_RECORD_SIZE, capture.size());
+    TEST_ASSERT_EQUAL_UINT32(2, writer.stats().records_written);
+
+    // little-endian on every platform
+    TEST_ASSERT_EQUAL_UINT8('M', capture[0]);
+    TEST_ASSERT_EQUAL_UINT8(CAPTURE_VERSION, capture[4]);
+    TEST_ASSERT_EQUAL_UINT8(0x02, capture[CAPTURE_HEADER_SIZE + CAPTURE_RECORD_SIZE + CAPTURE_RECORD_PREFIX_SIZE]);
+
+    MlxCaptureReader reader(read_from_capture);
+    TEST_ASSERT_TRUE(reader.begin() == CaptureReadResult::OK);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(mlx_reference_data::EEPROM.data(), reader.eeprom().data(), MLX_EEPROM_WORDS);
+
+    CaptureRecord record;
+    TEST_ASSERT_TRUE(reader.next(record) == CaptureReadResult::OK);
+    TEST_ASSERT_EQUAL_UINT32(100, record.timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT32(0, record.sequence_number);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(make_subpage(0xA5A5).data(), record.subpage.data(), MLX_SUBPAGE_FRAME_WORDS);
+    TEST_ASSERT_TRUE(reader.next(record) == CaptureReadResult::OK);
+    TEST_ASSERT_EQUAL_UINT32(131, record.timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT32(1, record.sequence_number);
+    TEST_ASSERT_TRUE(reader.next(record) == CaptureReadResult::END_OF_CAPTURE);
+}
+
+void test_slow_sink_never_blocks_the_producer(void)
+{
+    size_t accepted_per_call = 0;
+    MlxCaptureWriter writer([&](const uint8_t *data, size_t size) {
+        return write_to_capture(data, std::min(size, accepted_per_call));
+    });
+    writer.begin(mlx_reference_data::EEPROM);
+
+    // sink busy: record() keeps returning, the sub-pages beyond the buffers are dropped
+    for (uint16_t subpage = 0; subpage < CAPTURE_RECORD_BUFFER_COUNT + 2; subpage++) {
+        writer.record(make_subpage(subpage), subpage);
+    }
+    TEST_ASSERT_FALSE(writer.drain());
+    TEST_ASSERT_EQUAL_UINT32(2, writer.stats().records_dropped);
+
+    // a sink that takes only a few bytes at a time
+    accepted_per_call = 100;
+    while (!writer.drain()) {
+    }
+    writer.record(make_subpage(0xFFFF), 1000);
+    TEST_ASSERT_TRUE(writer.drain());
+    TEST_ASSERT_EQUAL_UINT32(CAPTURE_RECORD_BUFFER_COUNT + 1, writer.stats().records_written);
+    TEST_ASSERT_EQUAL_UINT32(capture.size(), writer.stats().bytes_written);
+
+    // the reader sees the drop as a gap in the sequence numbers
+    MlxCaptureReader reader(read_from_capture);
+    TEST_ASSERT_TRUE(reader.begin() == CaptureReadResult::OK);
+    CaptureRecord record;
+    uint32_t expected_sequence_number = 0;
+    while (reader.next(record) == CaptureReadResult::OK) {
+        if (record.sequence_number != expected_sequence_number) {
+            TEST_ASSERT_EQUAL_UINT32(CAPTURE_RECORD_BUFFER_COUNT, expected_sequence_number);
+            TEST_ASSERT_EQUAL_UINT32(CAPTURE_RECORD_BUFFER_COUNT + 2, record.sequence_number);
+        }
+        expected_sequence_number = record.sequence_number + 1;
+    }
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, record.subpage[0]);
+}
+
+void test_damaged_captures_are_rejected(void)
+{
+    MlxCaptureWriter writer(write_to_capture);
+    writer.begin(mlx_reference_data::EEPROM);
+    writer.record(make_subpage(0), 0);
+    TEST_ASSERT_TRUE(writer.drain());
+    auto complete_capture = capture;
+    CaptureRecord record;
+
+    capture.resize(CAPTURE_HEADER_SIZE - 1);
+    TEST_ASSERT_TRUE(MlxCaptureReader(read_from_capture).begin() == CaptureReadResult::TRUNCATED);
+
+    capture = complete_capture;
+    capture.pop_back();
+    read_offset = 0;
+    MlxCaptureReader truncated_reader(read_from_capture);
+    TEST_ASSERT_TRUE(truncated_reader.begin() == CaptureReadResult::OK);
+    TEST_ASSERT_TRUE(truncated_reader.next(record) == CaptureReadResult::TRUNCATED);
+
+    capture = complete_capture;
+    capture[CAPTURE_HEADER_SIZE] = 0x7F; // record type
+    read_offset = 0;
+    MlxCaptureReader bad_record_reader(read_from_capture);
+    TEST_ASSERT_TRUE(bad_record_reader.begin() == CaptureReadResult::OK);
+    TEST_ASSERT_TRUE(bad_record_reader.next(record) == CaptureReadResult::BAD_RECORD);
+
+    capture = complete_capture;
+    capture[4] = CAPTURE_VERSION + 1;
+    read_offset = 0;
+    TEST_ASSERT_TRUE(MlxCaptureReader(read_from_capture).begin() == CaptureReadResult::UNSUPPORTED_VERSION);
+
+    capture = complete_capture;
+    capture[0] = 'X';
+    read_offset = 0;
+    TEST_ASSERT_TRUE(MlxCaptureReader(read_from_capture).begin() == CaptureReadResult::BAD_HEADER);
+}
+
+// Records a session from the simulated sensor through the sub-page stream, replays it through a second driver
+// instance without a sensor and expects exactly the same temperatures
+void test_replay_is_bit_exact(void)
+{
+    constexpr uint32_t SUBPAGE_COUNT = 12;
+    MlxSimulator simulator;
+    Adafruit_MLX90640 mlx;
+    TEST_ASSERT_TRUE(mlx.begin(&simulator));
+    mlx.setRefreshRate(Mlx90640RefreshRate::MLX90640_16_HZ);
+
+    MlxCaptureWriter writer(write_to_capture);
+    MlxEeprom eeprom;
+    TEST_ASSERT_EQUAL_INT(0, mlx.MLX90640_I2CRead(0, MLX_EEPROM_START_ADDRESS, MLX_EEPROM_WORDS, eeprom.data()));
+    writer.begin(eeprom);
+
+    MlxSubpageAcquisition acquisition(
+            [&mlx](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                return mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+            },
+            [&mlx](uint16_t address, uint16_t value) { return mlx.MLX90640_I2CWrite(0, address, value); },
+            [&simulator]() { return simulator.now_ms(); },
+            simulator.subpage_period_us() / 1000);
+    MlxSubpageStream stream(
+            acquisition,
+            [&mlx](uint16_t *subpage_frame, float *temperatures) { mlx.calculateSubpage(subpage_frame, temperatures); },
+            [&writer](const MlxSubpageFrame &subpage_frame, uint32_t timestamp_ms) {
+                writer.record(subpage_frame, timestamp_ms);
+            });
+
+    std::vector<ThermoImage> live_temperatures;
+    while (live_temperatures.size() < SUBPAGE_COUNT) {
+        // a scene that changes over time
+        simulator.set_pixel_offset(live_temperatures.size() * 61 % (MLX_SENSOR_WIDTH * MLX_SENSOR_HEIGHT),
+                                   static_cast<int16_t>(live_temperatures.size() * 40));
+        stream.acquire();
+        stream.process();
+        writer.drain();
+        ComputedSubpage subpage;
+        if (stream.next(subpage)) {
+            live_temperatures.push_back(*subpage.temperatures);
+            stream.release(subpage);
+        }
+        simulator.advance_ms(1);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, writer.stats().records_dropped);
+
+    Adafruit_MLX90640 replay;
+    MlxCaptureReader reader(read_from_capture);
+    TEST_ASSERT_TRUE(reader.begin() == CaptureReadResult::OK);
+    TEST_ASSERT_TRUE(replay.loadEEPROM(reader.eeprom().data()));
+
+    CaptureRecord record;
+    uint32_t last_timestamp_ms = 0;
+    for (const auto &live : live_temperatures) {
+        TEST_ASSERT_TRUE(reader.next(record) == CaptureReadResult::OK);
+        TEST_ASSERT_TRUE(record.timestamp_ms >= last_timestamp_ms);
+        last_timestamp_ms = record.timestamp_ms;
+
+        ThermoImage replayed = live; // pixels of the other sub-page are not written
+        replay.calculateSubpage(record.subpage.data(), replayed.data());
+        TEST_ASSERT_EQUAL_MEMORY(live.data(), replayed.data(), sizeof(float) * live.size());
+    }
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_header_and_records_round_trip);
+    RUN_TEST(test_slow_sink_never_blocks_the_producer);
+    RUN_TEST(test_damaged_captures_are_rejected);
+    RUN_TEST(test_replay_is_bit_exact);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,193 @@
+#include <ArduinoFake.h>
+#include <cmath>
+
+#include "benchmark.h"
+#include "mlx_calibration.h"
+#include "mlx_fixed_point_calibration.h"
+#include "mlx_reference_comparison.h"
+#include "mlx_reference_data.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+using namespace thermocam::mlx_reference_comparison;
+
+// documented maximum error of the fixed-point engine against MLX90640_CalculateTo
+constexpr float FIXED_POINT_MAX_ERROR = 0.01f;
+
+Adafruit_MLX90640 *mlx = nullptr;
+MlxFixedPointCalibration *calibration = nullptr;
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    mlx = new Adafruit_MLX90640();
+    TEST_ASSERT_TRUE(mlx->loadEEPROM(mlx_reference_data::EEPROM.data()));
+    calibration = new MlxFixedPointCalibration(mlx->getParams());
+}
+
+void tearDown(void)
+{
+    delete calibration;
+    delete mlx;
+}
+
+void test_chess_mode_matches_reference(void)
+{
+    TEST_ASSERT_TRUE(calibration->is_compiled());
+    for (const auto &subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        TEST_ASSERT_FLOAT_WITHIN(FIXED_POINT_MAX_ERROR, 0.0f,
+                                 max_difference_to_reference(*mlx, *calibration, subpage_frame));
+    }
+}
+
+void test_interleaved_mode_matches_reference(void)
+{
+    for (auto subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        subpage_frame[MLX_CONTROL_REGISTER_WORD] &= ~MLX_CONTROL_CHESS_MODE;
+        TEST_ASSERT_FLOAT_WITHIN(FIXED_POINT_MAX_ERROR, 0.0f,
+                                 max_difference_to_reference(*mlx, *calibration, subpage_frame));
+    }
+}
+
+void test_extended_temperature_ranges_match_reference(void)
+{
+    // roughly -140 to 440 C, covers all four ranges of the ksTo / ct correction
+    float max_difference = 0.0f;
+    float min_temperature = INFINITY;
+    float max_temperature = -INFINITY;
+    for (int raw_offset = -300; raw_offset <= 6000; raw_offset += 20) {
+        auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[raw_offset & 1];
+        for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+            subpage_frame[pixel_index] = static_cast<uint16_t>(static_cast<int16_t>(subpage_frame[pixel_index]) +
+                                                               raw_offset);
+        }
+        max_difference = std::max(max_difference, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+
+        ThermoImage temperatures{};
+        calibration->calculate_subpage(subpage_frame.data(), temperatures.data());
+        auto context = calibration->last_context();
+        for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+            if (is_pixel_in_subpage(pixel_index, context.subpage_number, context.readout_mode)) {
+                min_temperature = std::min(min_temperature, temperatures[pixel_index]);
+                max_temperature = std::max(max_temperature, temperatures[pixel_index]);
+            }
+        }
+    }
+
+    report("max error %.4f C from %.1f to %.1f C", max_difference, min_temperature, max_temperature);
+    TEST_ASSERT_FLOAT_WITHIN(FIXED_POINT_MAX_ERROR, 0.0f, max_difference);
+    TEST_ASSERT_TRUE(min_temperature < -40.0f);
+    TEST_ASSERT_TRUE(max_temperature > 400.0f);
+}
+
+void test_offset_cache_matches_uncached(void)
+{
+    MlxFixedPointCalibration uncached(mlx->getParams());
+    uncached.set_offset_cache_epsilon(0.0f, 0.0f);
+    ThermoImage cached_temperatures{};
+    ThermoImage exact_temperatures{};
+    for (int frame = 0; frame < 10; frame++) {
+        for (const auto &subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+            calibration->calculate_subpage(subpage_frame.data(), cached_temperatures.data());
+            uncached.calculate_subpage(subpage_frame.data(), exact_temperatures.data());
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, calibration->offset_cache_stats().rebuilds);
+    TEST_ASSERT_EQUAL_UINT32(18, calibration->offset_cache_stats().hits);
+    // same Ta / Vdd in every frame, the cached compensation is the exact one
+    TEST_ASSERT_EQUAL_MEMORY(exact_temperatures.data(), cached_temperatures.data(),
+                             sizeof(float) * cached_temperatures.size());
+}
+
+void test_single_pass_matches_reference_across_ranges(void)
+{
+    // scene heating by about 0.3 C per frame from -50 to 520 C, crosses the range boundaries at 0, 300 and 500 C
+    calibration->set_single_pass(true);
+    float max_difference = 0.0f;
+    uint32_t pixels = 0;
+    uint32_t fallbacks = 0;
+    for (int raw_offset = -200; raw_offset <= 9000; raw_offset += 2) {
+        for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            auto subpage_frame = shifted_subpage(subpage_number, raw_offset, 2);
+            max_difference = std::max(max_difference, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+            pixels += calibration->single_pass_stats().pixels;
+            fallbacks += calibration->single_pass_stats().fallbacks;
+        }
+    }
+
+    // noisy static scene: a single pass almost everywhere
+    for (int frame = 0; frame < 10; frame++) {
+        for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            auto subpage_frame = shifted_subpage(subpage_number, 9000, 2);
+            max_difference = std::max(max_difference, max_difference_to_reference(*mlx, *calibration, subpage_frame));
+        }
+    }
+    TEST_ASSERT_LESS_THAN(MLX_SUBPAGE_PIXEL_COUNT / 20, calibration->single_pass_stats().fallbacks);
+
+    report("max error %.4f C, %.1f %% of the pixels with two passes", max_difference, 100.0f * fallbacks / pixels);
+    TEST_ASSERT_FLOAT_WITHIN(FIXED_POINT_MAX_ERROR, 0.0f, max_difference);
+    TEST_ASSERT_TRUE(fallbacks < pixels / 2);
+}
+
+void test_image_to_temperature_matches_reference(void)
+{
+    for (int raw_offset = -200; raw_offset <= 6000; raw_offset += 400) {
+        for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            auto subpage_frame = shifted_subpage(subpage_number, raw_offset);
+            ThermoImage reference{};
+            ThermoImage image{};
+            mlx->calculateSubpage(subpage_frame.data(), reference.data());
+            calibration->calculate_subpage_image(subpage_frame.data(), image.data());
+            for (auto pixel_index : subpage_pixel_indices(subpage_number, calibration->last_context().readout_mode)) {
+                TEST_ASSERT_FLOAT_WITHIN(FIXED_POINT_MAX_ERROR, reference[pixel_index],
+                                         calibration->image_to_temperature(pixel_index, image[pixel_index]));
+            }
+        }
+    }
+}
+
+void test_fixed_point_benchmark(void)
+{
+    constexpr uint32_t CALLS = 500;
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    MlxCalibration compiled(mlx->getParams());
+    ThermoImage temperatures{};
+    auto reference_us = microseconds_per_call(
+            [&]() { mlx->calculateSubpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    auto compiled_us = microseconds_per_call(
+            [&]() { compiled.calculate_subpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    auto fixed_point_us = microseconds_per_call(
+            [&]() { calibration->calculate_subpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    calibration->set_single_pass(true);
+    auto single_pass_us = microseconds_per_call(
+            [&]() { calibration->calculate_subpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    auto image_us = microseconds_per_call(
+            [&]() { calibration->calculate_subpage_image(subpage_frame.data(), temperatures.data()); }, CALLS);
+
+    // the host has an FPU and the 64 bit divisions cost more than the float ones, so there is nothing to assert here:
+    // the gain is on the ESP32-C3 without FPU, the firmware prints the cycles per sub-page with DEBUG_OUTPUT
+    report("per sub-page: reference %.1f us, compiled %.1f us, fixed-point %.1f us (single pass %.1f us, "
+           "relative image %.1f us)",
+           reference_us, compiled_us, fixed_point_us, single_pass_us, image_us);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_chess_mode_matches_reference);
+    RUN_TEST(test_interleaved_mode_matches_reference);
+    RUN_TEST(test_extended_temperature_ranges_match_reference);
+    RUN_TEST(test_offset_cache_matches_uncached);
+    RUN_TEST(test_single_pass_matches_reference_across_ranges);
+    RUN_TEST(test_image_to_temperature_matches_reference);
+    RUN_TEST(test_fixed_point_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,180 @@
+#include <ArduinoFake.h>
+#include <chrono>
+#include <cstdio>
+
+#include "algorithms.h"
+#include "mlx_acquisition.h"
+#include "mlx_params_cache.h"
+#include "mlx_simulator.h"
+#include "mlx_subpage_stream.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+constexpr const char *CACHE_PATH = "test_mlx_params_cache.bin";
+
+MlxSimulator *simulator = nullptr;
+
+struct BootResult
+{
+    bool begin_ok;
+    uint32_t begin_bus_bytes;
+    uint64_t begin_us; // simulated bus time
+    uint64_t begin_cpu_us; // host time, mostly MLX90640_ExtractParameters
+    uint64_t first_frame_us; // simulated, from the start of begin() until both sub-pages were calculated
+    ThermoImage first_frame;
+};
+
+// Cold or warm boot of a fresh driver instance against the already running sensor
+BootResult boot(MLX90640_ParamsCache *cache)
+{
+    BootResult result{};
+    Adafruit_MLX90640 mlx;
+    simulator->reset_stats();
+    auto start_us = simulator->now_us();
+    auto cpu_start = std::chrono::steady_clock::now();
+    result.begin_ok = mlx.begin(simulator, cache);
+    result.begin_cpu_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                                cpu_start)
+                                  .count();
+    result.begin_us = simulator->now_us() - start_us;
+    result.begin_bus_bytes = simulator->stats().bus_bytes;
+    if (!result.begin_ok) {
+        return result;
+    }
+    mlx.setRefreshRate(DEFAULT_MLX_REFRESH_RATE);
+
+    MlxSubpageAcquisition acquisition(
+            [&mlx](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                return mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+            },
+            [&mlx](uint16_t address, uint16_t value) { return mlx.MLX90640_I2CWrite(0, address, value); },
+            []() { return simulator->now_ms(); },
+            simulator->subpage_period_us() / 1000);
+    MlxSubpageStream stream(acquisition, [&mlx](uint16_t *subpage_frame, float *temperatures) {
+        mlx.calculateSubpage(subpage_frame, temperatures);
+    });
+    while (!stream.has_full_frame()) {
+        stream.acquire();
+        stream.process();
+        ComputedSubpage subpage;
+        if (stream.next(subpage)) {
+            merge_subpage_into_frame(subpage, result.first_frame);
+            stream.release(subpage);
+        }
+        simulator->advance_ms(1);
+    }
+    result.first_frame_us = simulator->now_us() - start_us;
+    return result;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), delay)).AlwaysReturn(); // settle time after register writes
+
+    remove(CACHE_PATH);
+    simulator = new MlxSimulator();
+}
+
+void tearDown(void)
+{
+    delete simulator;
+    remove(CACHE_PATH);
+}
+
+void test_crc32_matches_zlib(void)
+{
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, algorithms::crc32(check, sizeof(check)));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, algorithms::crc32(check + 4, 5, algorithms::crc32(check, 4)));
+}
+
+void test_warm_boot_skips_the_eeprom(void)
+{
+    FileParamsCache cache(CACHE_PATH);
+    auto cold = boot(&cache);
+    TEST_ASSERT_TRUE(cold.begin_ok);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().misses);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().stores);
+
+    auto warm = boot(&cache);
+    TEST_ASSERT_TRUE(warm.begin_ok);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().hits);
+    // device id only
+    TEST_ASSERT_LESS_THAN_UINT32(2 * MLX_EEPROM_WORDS, warm.begin_bus_bytes);
+    TEST_ASSERT_GREATER_THAN_UINT32(2 * MLX_EEPROM_WORDS, cold.begin_bus_bytes);
+    // same calibration -> same temperatures
+    TEST_ASSERT_EQUAL_MEMORY(cold.first_frame.data(), warm.first_frame.data(), sizeof(float) * cold.first_frame.size());
+
+    auto uncached = boot(nullptr);
+    char message[160];
+    snprintf(message, sizeof(message), "begin() without cache: %lu us bus + %lu us CPU, first frame after %lu us",
+             static_cast<unsigned long>(uncached.begin_us), static_cast<unsigned long>(uncached.begin_cpu_us),
+             static_cast<unsigned long>(uncached.first_frame_us));
+    TEST_MESSAGE(message);
+    snprintf(message, sizeof(message), "begin() with cache:    %lu us bus + %lu us CPU, first frame after %lu us",
+             static_cast<unsigned long>(warm.begin_us), static_cast<unsigned long>(warm.begin_cpu_us),
+             static_cast<unsigned long>(warm.first_frame_us));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN_UINT32(uncached.begin_us, warm.begin_us);
+}
+
+void test_entry_of_another_sensor_is_replaced(void)
+{
+    FileParamsCache cache(CACHE_PATH);
+    TEST_ASSERT_TRUE(boot(&cache).begin_ok);
+
+    paramsMLX90640 params{};
+    const uint16_t other_serial_number[3] = {0x1234, 0x5678, 0x9ABC};
+    TEST_ASSERT_FALSE(cache.load(other_serial_number, &params));
+    TEST_ASSERT_EQUAL_UINT32(2, cache.stats().misses);
+
+    TEST_ASSERT_TRUE(cache.store(other_serial_number, &params));
+    TEST_ASSERT_TRUE(boot(&cache).begin_ok);
+    TEST_ASSERT_EQUAL_UINT32(3, cache.stats().misses);
+    TEST_ASSERT_EQUAL_UINT32(3, cache.stats().stores);
+    TEST_ASSERT_EQUAL_UINT32(0, cache.stats().hits);
+}
+
+void test_corrupt_entry_is_not_used(void)
+{
+    FileParamsCache cache(CACHE_PATH);
+    auto cold = boot(&cache);
+
+    // flip one bit of the parameters
+    auto *file = fopen(CACHE_PATH, "r+b");
+    TEST_ASSERT_NOT_NULL(file);
+    fseek(file, sizeof(ParamsCacheHeader) + 100, SEEK_SET);
+    auto value = fgetc(file);
+    fseek(file, sizeof(ParamsCacheHeader) + 100, SEEK_SET);
+    fputc(value ^ 0x04, file);
+    fclose(file);
+
+    auto rebooted = boot(&cache);
+    TEST_ASSERT_TRUE(rebooted.begin_ok);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().invalid);
+    TEST_ASSERT_EQUAL_UINT32(0, cache.stats().hits);
+    TEST_ASSERT_EQUAL_UINT32(2, cache.stats().stores); // repaired
+    TEST_ASSERT_EQUAL_MEMORY(cold.first_frame.data(), rebooted.first_frame.data(),
+                             sizeof(float) * cold.first_frame.size());
+
+    TEST_ASSERT_TRUE(boot(&cache).begin_ok);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().hits);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc32_matches_zlib);
+    RUN_TEST(test_warm_boot_skips_the_eeprom);
+    RUN_TEST(test_entry_of_another_sensor_is_replaced);
+    RUN_TEST(test_corrupt_entry_is_not_used);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,216 @@
+#include <ArduinoFake.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string.h>
+#include <vector>
+
+#include "benchmark.h"
+#include "mlx_bad_pixels.h"
+#include "mlx_capture.h"
+#include "mlx_fixed_point_calibration.h"
+#include "mlx_pixel_faults.h"
+#include "mlx_reference_data.h"
+#include "mlx_utils.h"
+#include "pseudo_random.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+
+constexpr uint32_t CAPTURE_FRAMES = 160;
+constexpr size_t STUCK_PIXEL_INDEX = 5 * MLX_SENSOR_WIDTH + 7;
+constexpr size_t NOISY_PIXEL_INDEX = 12 * MLX_SENSOR_WIDTH + 20;
+constexpr size_t HOT_PIXEL_INDEX = 18 * MLX_SENSOR_WIDTH + 9;
+constexpr size_t EDGE_PIXEL_INDEX = 23 * MLX_SENSOR_WIDTH + 31;
+
+std::vector<uint8_t> capture;
+size_t read_offset = 0;
+pseudo_random::Lcg noise;
+
+// Records a session of the reference sensor: the scene warms up and cools down by about 8 C, a hot object of 2 x 2
+// pixels and a hot line of one pixel width sit in it, every pixel has +-3 counts (about 0.5 C) of noise
+void record_capture()
+{
+    capture.clear();
+    read_offset = 0;
+    MlxCaptureWriter writer([](const uint8_t *data, size_t size) {
+        capture.insert(capture.end(), data, data + size);
+        return size;
+    });
+    writer.begin(mlx_reference_data::EEPROM);
+    for (uint32_t frame = 0; frame < CAPTURE_FRAMES; frame++) {
+        auto scene_offset = static_cast<int>(50.0f * std::sin(frame / 20.0f));
+        for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[subpage_number];
+            for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+                auto row = pixel_index / MLX_SENSOR_WIDTH;
+                auto column = pixel_index % MLX_SENSOR_WIDTH;
+                auto is_object = (row == 8 || row == 9) && (column == 14 || column == 15);
+                auto is_line = row == 3 && column >= 20;
+                int raw = static_cast<int16_t>(subpage_frame[pixel_index]) + scene_offset + noise.counts(3) +
+                          (is_object || is_line ? 300 : 0);
+                subpage_frame[pixel_index] = static_cast<uint16_t>(raw);
+            }
+            writer.record(subpage_frame, frame * 125);
+            TEST_ASSERT_TRUE(writer.drain());
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, writer.stats().records_dropped);
+}
+
+// Replays the capture through the frame path of the firmware: calculation, detection, correction. The injection
+// modifies each recorded sub-page before the calculation.
+struct Replay
+{
+    MlxPixelFaultDetector detector;
+    MlxBadPixelCorrection correction;
+    ThermoImage temperatures{};
+    uint32_t detection_frame = 0; // frame of the latest change of the detected pixels
+};
+
+void replay_capture(Replay &replay, std::function<void(uint32_t frame, MlxSubpageFrame &subpage_frame)> inject)
+{
+    read_offset = 0;
+    MlxCaptureReader reader([](uint8_t *data, size_t size) {
+        auto count = std::min(size, capture.size() - read_offset);
+        memcpy(data, capture.data() + read_offset, count);
+        read_offset += count;
+        return count;
+    });
+    TEST_ASSERT_TRUE(reader.begin() == CaptureReadResult::OK);
+    Adafruit_MLX90640 mlx;
+    TEST_ASSERT_TRUE(mlx.loadEEPROM(reader.eeprom().data()));
+    MlxFixedPointCalibration calibration(mlx.getParams());
+    replay.correction.compile(mlx.getParams());
+
+    CaptureRecord record;
+    uint32_t generation = replay.detector.generation();
+    for (uint32_t subpage_count = 0; reader.next(record) == CaptureReadResult::OK; subpage_count++) {
+        inject(subpage_count / 2, record.subpage);
+        calibration.calculate_subpage(record.subpage.data(), replay.temperatures.data());
+        auto context = calibration.last_context();
+        replay.detector.update_subpage(context.subpage_number, context.readout_mode, replay.temperatures.data());
+        if (replay.detector.generation() != generation) {
+            generation = replay.detector.generation();
+            replay.detection_frame = subpage_count / 2;
+            replay.correction.set_detected_pixels(replay.detector.faulty_pixels());
+        }
+        replay.correction.correct_subpage(record.subpage.data(), replay.temperatures.data());
+    }
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    if (capture.empty()) {
+        record_capture();
+    }
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_healthy_capture_flags_nothing(void)
+{
+    Replay replay;
+    replay_capture(replay, [](uint32_t, MlxSubpageFrame &) {});
+    TEST_ASSERT_EQUAL(0, replay.detector.faulty_pixels().count());
+    TEST_ASSERT_EQUAL(0, replay.correction.detected_pixel_count());
+
+    // interleaved mode, same scene
+    Replay interleaved;
+    replay_capture(interleaved, [](uint32_t, MlxSubpageFrame &subpage_frame) {
+        subpage_frame[MLX_CONTROL_REGISTER_WORD] &= ~MLX_CONTROL_CHESS_MODE;
+    });
+    TEST_ASSERT_EQUAL(0, interleaved.detector.faulty_pixels().count());
+}
+
+void test_injected_faults_are_detected_and_corrected(void)
+{
+    Replay replay;
+    uint16_t stuck_raw = 0;
+    replay_capture(replay, [&stuck_raw](uint32_t frame, MlxSubpageFrame &subpage_frame) {
+        if (frame < 40) {
+            return; // the pixels fail in the field
+        }
+        if (stuck_raw == 0) {
+            stuck_raw = subpage_frame[STUCK_PIXEL_INDEX];
+        }
+        subpage_frame[STUCK_PIXEL_INDEX] = stuck_raw;
+        subpage_frame[NOISY_PIXEL_INDEX] += noise.counts(150);
+        subpage_frame[HOT_PIXEL_INDEX] += 600;
+        subpage_frame[EDGE_PIXEL_INDEX] -= 300;
+    });
+
+    TEST_ASSERT_TRUE(replay.detector.fault(STUCK_PIXEL_INDEX) == PixelFault::STUCK);
+    TEST_ASSERT_TRUE(replay.detector.fault(NOISY_PIXEL_INDEX) == PixelFault::NOISY);
+    TEST_ASSERT_TRUE(replay.detector.fault(HOT_PIXEL_INDEX) == PixelFault::OFFSET);
+    TEST_ASSERT_TRUE(replay.detector.fault(EDGE_PIXEL_INDEX) == PixelFault::OFFSET);
+    TEST_ASSERT_EQUAL(4, replay.detector.faulty_pixels().count());
+    TEST_ASSERT_EQUAL_UINT32(1, replay.detector.fault_count(PixelFault::STUCK));
+    TEST_ASSERT_EQUAL_UINT32(2, replay.detector.fault_count(PixelFault::OFFSET));
+    TEST_ASSERT_EQUAL_UINT32(MLX_PIXEL_COUNT - 4, replay.detector.fault_count(PixelFault::NONE));
+    TEST_ASSERT_EQUAL(4, replay.correction.detected_pixel_count());
+    TEST_ASSERT_TRUE(replay.detection_frame < 40 + 2 * PIXEL_FAULT_WARMUP_FRAMES);
+
+    // the hot pixel no longer takes over the max of the frame, the hot object does
+    ThermoImageStats tis{};
+    mlx_utils::update_thermo_image_stats_from_frame(replay.temperatures, tis);
+    auto max_row = tis.max_temp_index / MLX_SENSOR_WIDTH;
+    TEST_ASSERT_TRUE(max_row == 3 || max_row == 8 || max_row == 9);
+    auto diagonal_neighbour = replay.temperatures[HOT_PIXEL_INDEX - MLX_SENSOR_WIDTH - 1];
+    TEST_ASSERT_TRUE(std::fabs(replay.temperatures[HOT_PIXEL_INDEX] - diagonal_neighbour) < 3.0f);
+}
+
+void test_recovered_pixel_is_cleared(void)
+{
+    Replay replay;
+    replay_capture(replay, [](uint32_t frame, MlxSubpageFrame &subpage_frame) {
+        if (frame >= 20 && frame < 80) {
+            subpage_frame[HOT_PIXEL_INDEX] += 600; // e.g. a loose contact
+        }
+    });
+    TEST_ASSERT_TRUE(replay.detector.fault(HOT_PIXEL_INDEX) == PixelFault::NONE);
+    TEST_ASSERT_EQUAL(0, replay.correction.detected_pixel_count());
+    TEST_ASSERT_TRUE(replay.detection_frame > 80);
+}
+
+void test_detector_benchmark(void)
+{
+    constexpr uint32_t CALLS = 500;
+    Adafruit_MLX90640 mlx;
+    TEST_ASSERT_TRUE(mlx.loadEEPROM(mlx_reference_data::EEPROM.data()));
+    MlxFixedPointCalibration calibration(mlx.getParams());
+    MlxPixelFaultDetector detector;
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    ThermoImage temperatures{};
+    auto calculation_us = microseconds_per_call(
+            [&]() { calibration.calculate_subpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    auto detection_us = microseconds_per_call(
+            [&]() {
+                detector.update_subpage(0, Mlx90640PixelReadoutMode::MLX90640_CHESS, temperatures.data());
+            },
+            CALLS);
+
+    report("per sub-page: calculation %.1f us, fault detection %.1f us", calculation_us, detection_us);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_healthy_capture_flags_nothing);
+    RUN_TEST(test_injected_faults_are_detected_and_corrected);
+    RUN_TEST(test_recovered_pixel_is_cleared);
+    RUN_TEST(test_detector_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,112 @@
+#include <ArduinoFake.h>
+#include <array>
+
+#include "mlx_pixel_layout.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+// built at compile time
+static_assert(subpage_pixel_indices(0, Mlx90640PixelReadoutMode::MLX90640_CHESS)[1] == 2);
+static_assert(subpage_pixel_indices(1, Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED)[0] == MLX_SENSOR_WIDTH);
+
+// pattern arithmetic of MLX90640_CalculateTo / MLX90640_GetImage, copied verbatim
+struct ReferencePatterns
+{
+    int il_pattern;
+    int chess_pattern;
+    int conversion_pattern;
+};
+
+ReferencePatterns reference_patterns(int pixelNumber)
+{
+    ReferencePatterns patterns;
+    patterns.il_pattern = pixelNumber / 32 - (pixelNumber / 64) * 2;
+    patterns.chess_pattern = patterns.il_pattern ^ (pixelNumber - (pixelNumber / 2) * 2);
+    patterns.conversion_pattern = ((pixelNumber + 2) / 4 - (pixelNumber + 3) / 4 + (pixelNumber + 1) / 4 -
+                                   pixelNumber / 4) *
+                                  (1 - 2 * patterns.il_pattern);
+    return patterns;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void assert_indices_match_reference(Mlx90640PixelReadoutMode readout_mode)
+{
+    // mode as in the control register: 0 interleaved, 1 chess
+    int mode = readout_mode == Mlx90640PixelReadoutMode::MLX90640_CHESS;
+    for (uint16_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        std::array<uint16_t, MLX_SUBPAGE_PIXEL_COUNT> expected{};
+        size_t count = 0;
+        for (int pixelNumber = 0; pixelNumber < 768; pixelNumber++) {
+            auto patterns = reference_patterns(pixelNumber);
+            int pattern = mode == 0 ? patterns.il_pattern : patterns.chess_pattern;
+            if (pattern == subpage_number) {
+                TEST_ASSERT_LESS_THAN(MLX_SUBPAGE_PIXEL_COUNT, count);
+                expected[count++] = pixelNumber;
+            }
+        }
+        TEST_ASSERT_EQUAL(MLX_SUBPAGE_PIXEL_COUNT, count);
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(expected.data(), subpage_pixel_indices(subpage_number, readout_mode).data(),
+                                       MLX_SUBPAGE_PIXEL_COUNT);
+    }
+}
+
+void test_chess_indices_match_reference(void)
+{
+    assert_indices_match_reference(Mlx90640PixelReadoutMode::MLX90640_CHESS);
+}
+
+void test_interleaved_indices_match_reference(void)
+{
+    assert_indices_match_reference(Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED);
+}
+
+void test_subpages_cover_every_pixel_once(void)
+{
+    for (auto readout_mode : {Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED, Mlx90640PixelReadoutMode::MLX90640_CHESS}) {
+        std::array<int, MLX_PIXEL_COUNT> hits{};
+        for (uint8_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            for (auto pixel_index : subpage_pixel_indices(subpage_number, readout_mode)) {
+                TEST_ASSERT_TRUE(is_pixel_in_subpage(pixel_index, subpage_number, readout_mode));
+                hits[pixel_index]++;
+            }
+        }
+        for (auto pixel_hits : hits) {
+            TEST_ASSERT_EQUAL(1, pixel_hits);
+        }
+    }
+}
+
+void test_patterns_match_reference(void)
+{
+    for (int pixelNumber = 0; pixelNumber < 768; pixelNumber++) {
+        auto patterns = reference_patterns(pixelNumber);
+        TEST_ASSERT_EQUAL(patterns.il_pattern, interleave_pattern(pixelNumber));
+        TEST_ASSERT_EQUAL(patterns.conversion_pattern, conversion_pattern(pixelNumber));
+    }
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_chess_indices_match_reference);
+    RUN_TEST(test_interleaved_indices_match_reference);
+    RUN_TEST(test_subpages_cover_every_pixel_once);
+    RUN_TEST(test_patterns_match_reference);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,238 @@
+#include <ArduinoFake.h>
+#include <cmath>
+#include <cstdio>
+
+#include "mlx_acquisition.h"
+#include "mlx_rate_governor.h"
+#include "mlx_simulator.h"
+#include "mlx_subpage_stream.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+constexpr size_t PIXEL_COUNT = MLX_SENSOR_WIDTH * MLX_SENSOR_HEIGHT;
+
+// Firmware loop against the simulated sensor, the pipeline cost of every sub-page is spent on the simulated clock
+class GovernedCamera
+{
+public:
+    GovernedCamera(GovernorSettings initial_settings, uint32_t pipeline_us)
+        : _acquisition(
+                  [this](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                      return _mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+                  },
+                  [this](uint16_t address, uint16_t value) { return _mlx.MLX90640_I2CWrite(0, address, value); },
+                  [this]() { return _simulator.now_ms(); },
+                  mlx_utils::convert_refresh_rate_to_ms(initial_settings.refresh_rate)),
+          _stream(_acquisition,
+                  [this](uint16_t *subpage_frame, float *temperatures) {
+                      _mlx.calculateSubpage(subpage_frame, temperatures);
+                  }),
+          _governor(
+                  [this](const GovernorSettings &settings) {
+                      _mlx.setRefreshRate(settings.refresh_rate);
+                      _mlx.setResolution(settings.resolution);
+                      _acquisition.set_subpage_period_ms(mlx_utils::convert_refresh_rate_to_ms(settings.refresh_rate));
+                      return true;
+                  },
+                  [this]() { return _simulator.now_ms(); },
+                  initial_settings),
+          _pipeline_us(pipeline_us)
+    {
+        TEST_ASSERT_TRUE(_mlx.begin(&_simulator));
+        _mlx.setRefreshRate(initial_settings.refresh_rate);
+        _mlx.setResolution(initial_settings.resolution);
+    }
+
+    // scene_amplitude: raw offset of all pixels, swinging with a period of 2 s (0 = static scene)
+    void run_for_ms(uint32_t duration_ms, int16_t scene_amplitude)
+    {
+        auto end_ms = _simulator.now_ms() + duration_ms;
+        while (_simulator.now_ms() < end_ms) {
+            auto phase = 2.0 * M_PI * (_simulator.now_ms() % 2000) / 2000.0;
+            for (size_t pixel_index = 0; pixel_index < PIXEL_COUNT; pixel_index++) {
+                _simulator.set_pixel_offset(pixel_index, static_cast<int16_t>(scene_amplitude * std::sin(phase)));
+            }
+
+            _stream.acquire();
+            _stream.process();
+            ComputedSubpage subpage;
+            if (!_stream.next(subpage)) {
+                _simulator.advance_ms(1);
+                continue;
+            }
+            merge_subpage_into_frame(subpage, _frame);
+            _stream.release(subpage);
+            // like the firmware: nothing is drawn before both sub-pages arrived
+            if (!_stream.has_full_frame()) {
+                continue;
+            }
+            _simulator.advance_us(_pipeline_us);
+            _governor.update(_frame, _pipeline_us);
+            _frame_mean_sum += std::accumulate(_frame.begin(), _frame.end(), 0.0f) / _frame.size();
+            _frame_count++;
+        }
+    }
+
+    void set_pipeline_us(uint32_t pipeline_us) { _pipeline_us = pipeline_us; }
+    void reset_frame_mean()
+    {
+        _frame_mean_sum = 0.0f;
+        _frame_count = 0;
+    }
+    float frame_mean() const { return _frame_mean_sum / _frame_count; }
+
+    const MlxRateGovernor &governor() const { return _governor; }
+    const MlxSimulator &simulator() const { return _simulator; }
+
+    void report(const char *scenario) const
+    {
+        char message[200];
+        snprintf(message, sizeof(message),
+                 "%s: %.1f Hz, %d bit, headroom %.2f, scene change %.2f C, %lu up / %lu down / %lu resolution",
+                 scenario, 0.5f * (1 << static_cast<int>(_governor.settings().refresh_rate)),
+                 16 + static_cast<int>(_governor.settings().resolution), _governor.headroom(), _governor.scene_change(),
+                 static_cast<unsigned long>(_governor.stats().rate_increases),
+                 static_cast<unsigned long>(_governor.stats().rate_decreases),
+                 static_cast<unsigned long>(_governor.stats().resolution_changes));
+        TEST_MESSAGE(message);
+    }
+
+private:
+    MlxSimulator _simulator;
+    Adafruit_MLX90640 _mlx;
+    MlxSubpageAcquisition _acquisition;
+    MlxSubpageStream _stream;
+    MlxRateGovernor _governor;
+    uint32_t _pipeline_us;
+    ThermoImage _frame{};
+    float _frame_mean_sum = 0.0f;
+    uint32_t _frame_count = 0;
+};
+
+constexpr int16_t MOVING_SCENE = 20; // about +-5 C
+constexpr int16_t STATIC_SCENE = 0;
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), delay)).AlwaysReturn(); // settle time after register writes
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_overloaded_pipeline_steps_down_and_stays(void)
+{
+    // 40 ms per sub-page does not fit into 31 ms (32 Hz) but leaves headroom at 16 Hz
+    GovernedCamera camera({Mlx90640RefreshRate::MLX90640_32_HZ, GOVERNOR_DYNAMIC_RESOLUTION}, 40'000);
+    camera.run_for_ms(3'000, MOVING_SCENE);
+    TEST_ASSERT_TRUE(camera.governor().settings().refresh_rate == Mlx90640RefreshRate::MLX90640_16_HZ);
+    TEST_ASSERT_EQUAL_UINT32(1, camera.governor().stats().rate_decreases);
+
+    // no oscillation: stepping up again would overload the pipeline
+    camera.run_for_ms(20'000, MOVING_SCENE);
+    camera.report("overloaded");
+    TEST_ASSERT_TRUE(camera.governor().settings().refresh_rate == Mlx90640RefreshRate::MLX90640_16_HZ);
+    TEST_ASSERT_EQUAL_UINT32(0, camera.governor().stats().rate_increases);
+    TEST_ASSERT_EQUAL_UINT32(1, camera.governor().stats().rate_decreases);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 1.0f - 40.0f / 62.0f, camera.governor().headroom());
+}
+
+void test_moving_scene_with_headroom_steps_up_to_the_limit(void)
+{
+    GovernedCamera camera({Mlx90640RefreshRate::MLX90640_2_HZ, GOVERNOR_STATIC_RESOLUTION}, 2'000);
+    camera.run_for_ms(20'000, MOVING_SCENE);
+    camera.report("moving scene");
+    TEST_ASSERT_TRUE(camera.governor().settings().refresh_rate == GOVERNOR_MAX_REFRESH_RATE);
+    TEST_ASSERT_TRUE(camera.governor().settings().resolution == GOVERNOR_DYNAMIC_RESOLUTION);
+    TEST_ASSERT_EQUAL_UINT32(static_cast<int>(GOVERNOR_MAX_REFRESH_RATE) - static_cast<int>(Mlx90640RefreshRate::MLX90640_2_HZ),
+                             camera.governor().stats().rate_increases);
+    TEST_ASSERT_EQUAL_UINT32(0, camera.governor().stats().rate_decreases);
+    TEST_ASSERT_GREATER_THAN(GOVERNOR_DYNAMIC_SCENE_CHANGE, camera.governor().scene_change());
+}
+
+void test_growing_pipeline_cost_is_followed(void)
+{
+    GovernedCamera camera({Mlx90640RefreshRate::MLX90640_8_HZ, GOVERNOR_DYNAMIC_RESOLUTION}, 2'000);
+    camera.run_for_ms(10'000, MOVING_SCENE);
+    TEST_ASSERT_TRUE(camera.governor().settings().refresh_rate == GOVERNOR_MAX_REFRESH_RATE);
+
+    // e.g. a heavier display mode: 150 ms per sub-page only fits at 4 Hz (250 ms) and below
+    camera.set_pipeline_us(150'000);
+    camera.run_for_ms(20'000, MOVING_SCENE);
+    camera.report("growing cost");
+    TEST_ASSERT_TRUE(camera.governor().settings().refresh_rate == Mlx90640RefreshRate::MLX90640_4_HZ);
+    TEST_ASSERT_GREATER_THAN(0.0f, camera.governor().headroom());
+}
+
+void test_static_scene_gets_the_low_noise_setting(void)
+{
+    GovernedCamera camera({Mlx90640RefreshRate::MLX90640_16_HZ, GOVERNOR_DYNAMIC_RESOLUTION}, 2'000);
+    camera.run_for_ms(1'000, STATIC_SCENE);
+    auto mean_at_dynamic_resolution = camera.frame_mean();
+
+    camera.run_for_ms(9'000, STATIC_SCENE);
+    camera.report("static scene");
+    TEST_ASSERT_TRUE(camera.governor().settings().refresh_rate == GOVERNOR_STATIC_REFRESH_RATE);
+    TEST_ASSERT_TRUE(camera.governor().settings().resolution == GOVERNOR_STATIC_RESOLUTION);
+    TEST_ASSERT_TRUE(camera.governor().stats().last_decision == GovernorDecision::HOLD);
+    TEST_ASSERT_EQUAL_UINT32(1, camera.governor().stats().resolution_changes);
+
+    // the temperatures do not jump with the resolution change
+    camera.reset_frame_mean();
+    camera.run_for_ms(2'000, STATIC_SCENE);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, mean_at_dynamic_resolution, camera.frame_mean());
+
+    // motion brings the rate back
+    camera.run_for_ms(5'000, MOVING_SCENE);
+    TEST_ASSERT_TRUE(camera.governor().settings().refresh_rate > GOVERNOR_STATIC_REFRESH_RATE);
+    TEST_ASSERT_TRUE(camera.governor().settings().resolution == GOVERNOR_DYNAMIC_RESOLUTION);
+}
+
+void test_refused_change_is_retried(void)
+{
+    uint32_t refusals = 2;
+    GovernorSettings applied{};
+    unsigned long now_ms = 0;
+    MlxRateGovernor governor(
+            [&](const GovernorSettings &settings) {
+                if (refusals > 0) {
+                    refusals--;
+                    return false;
+                }
+                applied = settings;
+                return true;
+            },
+            [&]() { return now_ms; }, {Mlx90640RefreshRate::MLX90640_16_HZ, GOVERNOR_DYNAMIC_RESOLUTION});
+
+    ThermoImage frame{};
+    uint32_t overloaded_us = 62'000; // whole sub-page period
+    for (uint32_t update = 0; update < GOVERNOR_OVERLOAD_UPDATES + 2; update++) {
+        governor.update(frame, overloaded_us);
+        now_ms += 62;
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, governor.stats().apply_failures);
+    TEST_ASSERT_TRUE(applied.refresh_rate == Mlx90640RefreshRate::MLX90640_8_HZ);
+    TEST_ASSERT_TRUE(governor.stats().last_decision == GovernorDecision::RATE_DOWN_OVERLOAD);
+    TEST_ASSERT_TRUE(governor.update(frame, overloaded_us) == GovernorDecision::SETTLING);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_overloaded_pipeline_steps_down_and_stays);
+    RUN_TEST(test_moving_scene_with_headroom_steps_up_to_the_limit);
+    RUN_TEST(test_growing_pipeline_cost_is_followed);
+    RUN_TEST(test_static_scene_gets_the_low_noise_setting);
+    RUN_TEST(test_refused_change_is_retried);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,204 @@
+#include <ArduinoFake.h>
+#include <cstdio>
+
+#include "mlx_acquisition.h"
+#include "mlx_simulator.h"
+#include "mlx_subpage_stream.h"
+#include "mlx_utils.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+constexpr auto REFRESH_RATE = Mlx90640RefreshRate::MLX90640_16_HZ;
+
+// Firmware loop against the simulated sensor at 1 MHz I2C, records when the consumer gets a sub-page
+class RecoveringCamera
+{
+public:
+    RecoveringCamera()
+        : _acquisition(
+                  [this](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                      return _mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+                  },
+                  [this](uint16_t address, uint16_t value) { return _mlx.MLX90640_I2CWrite(0, address, value); },
+                  [this]() { return _simulator.now_ms(); },
+                  mlx_utils::convert_refresh_rate_to_ms(REFRESH_RATE)),
+          _stream(_acquisition, [this](uint16_t *subpage_frame, float *temperatures) {
+              _mlx.calculateSubpage(subpage_frame, temperatures);
+          })
+    {
+        TEST_ASSERT_TRUE(_mlx.begin(&_simulator));
+        _mlx.setRefreshRate(REFRESH_RATE);
+        _acquisition.set_subpage_period_ms(mlx_utils::convert_refresh_rate_to_ms(REFRESH_RATE));
+    }
+
+    // glitch_interval_ms: one not acknowledged transaction per interval (0 = clean bus)
+    void run_for_ms(uint32_t duration_ms, uint32_t glitch_interval_ms = 0)
+    {
+        auto end_ms = _simulator.now_ms() + duration_ms;
+        while (_simulator.now_ms() < end_ms) {
+            if (glitch_interval_ms > 0 && _simulator.now_ms() >= _next_glitch_ms) {
+                _simulator.inject_bus_errors(1);
+                _next_glitch_ms = _simulator.now_ms() + glitch_interval_ms;
+            }
+
+            _stream.acquire();
+            _stream.process();
+            ComputedSubpage subpage;
+            if (!_stream.next(subpage)) {
+                _simulator.advance_ms(1);
+                continue;
+            }
+            merge_subpage_into_frame(subpage, _frame);
+            _stream.release(subpage);
+            if (!_stream.has_full_frame()) {
+                continue;
+            }
+            auto now_ms = _simulator.now_ms();
+            if (_display_updates > 0) {
+                _max_display_gap_ms = std::max(_max_display_gap_ms, now_ms - _last_display_ms);
+            }
+            _last_display_ms = now_ms;
+            _display_updates++;
+            _substitutes += subpage.is_substitute;
+        }
+    }
+
+    void reset_display_stats()
+    {
+        _display_updates = 0;
+        _substitutes = 0;
+        _max_display_gap_ms = 0;
+    }
+
+    void report(const char *scenario) const
+    {
+        char message[200];
+        snprintf(message, sizeof(message),
+                 "%s: %lu display updates (%lu substitutes), max gap %lu ms, %lu bus errors, %lu recovered, "
+                 "%lu resets, %lu lost",
+                 scenario, static_cast<unsigned long>(_display_updates), static_cast<unsigned long>(_substitutes),
+                 _max_display_gap_ms, static_cast<unsigned long>(_acquisition.stats().bus_errors),
+                 static_cast<unsigned long>(_acquisition.stats().recovered_errors),
+                 static_cast<unsigned long>(_acquisition.stats().bus_resets),
+                 static_cast<unsigned long>(_stream.lost_subpages()));
+        TEST_MESSAGE(message);
+    }
+
+    MlxSimulator &simulator() { return _simulator; }
+    MlxSubpageAcquisition &acquisition() { return _acquisition; }
+    const MlxSubpageStream &stream() const { return _stream; }
+    const ThermoImage &frame() const { return _frame; }
+    uint32_t display_updates() const { return _display_updates; }
+    uint32_t substitutes() const { return _substitutes; }
+    unsigned long max_display_gap_ms() const { return _max_display_gap_ms; }
+
+private:
+    MlxSimulator _simulator;
+    Adafruit_MLX90640 _mlx;
+    MlxSubpageAcquisition _acquisition;
+    MlxSubpageStream _stream;
+    ThermoImage _frame{};
+    unsigned long _next_glitch_ms = 0;
+    unsigned long _last_display_ms = 0;
+    unsigned long _max_display_gap_ms = 0;
+    uint32_t _display_updates = 0;
+    uint32_t _substitutes = 0;
+};
+
+constexpr uint32_t SUBPAGE_PERIOD_MS = 2000 >> static_cast<int>(REFRESH_RATE);
+constexpr uint32_t RUN_MS = 5'000;
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), delay)).AlwaysReturn(); // settle time after register writes
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_glitches_do_not_cost_subpages(void)
+{
+    RecoveringCamera camera;
+    camera.run_for_ms(1'000);
+    camera.reset_display_stats();
+
+    // marginal wiring: a NACK every 37 ms hits status polls, status clears and RAM reads
+    camera.run_for_ms(RUN_MS, 37);
+    camera.report("glitches");
+    // a glitch is only injected when the previous one hit a transaction
+    TEST_ASSERT_GREATER_THAN_UINT32(RUN_MS / SUBPAGE_PERIOD_MS / 2, camera.acquisition().stats().bus_errors);
+    TEST_ASSERT_EQUAL_UINT32(0, camera.stream().lost_subpages());
+    TEST_ASSERT_GREATER_THAN_UINT32(0, camera.acquisition().stats().recovered_errors);
+    // one display update per sub-page, a retry delays it by a few ms at most
+    TEST_ASSERT_UINT32_WITHIN(2, RUN_MS / SUBPAGE_PERIOD_MS, camera.display_updates());
+    TEST_ASSERT_LESS_THAN_UINT32(SUBPAGE_PERIOD_MS + SUBPAGE_PERIOD_MS / 4, camera.max_display_gap_ms());
+}
+
+void test_stuck_bus_is_reset(void)
+{
+    RecoveringCamera camera;
+    uint32_t resets = 0;
+    camera.acquisition().set_bus_reset_function([&camera, &resets]() {
+        resets++;
+        camera.simulator().release_bus();
+        return true;
+    });
+    camera.run_for_ms(1'000);
+    camera.reset_display_stats();
+
+    camera.simulator().hold_bus();
+    camera.run_for_ms(RUN_MS);
+    camera.report("stuck bus");
+    TEST_ASSERT_EQUAL_UINT32(1, resets);
+    TEST_ASSERT_EQUAL_UINT32(1, camera.acquisition().stats().bus_resets);
+    TEST_ASSERT_EQUAL_UINT32(MLX_BUS_RESET_AFTER_ERRORS, camera.acquisition().stats().bus_errors);
+    TEST_ASSERT_EQUAL_UINT32(0, camera.stream().lost_subpages());
+    TEST_ASSERT_UINT32_WITHIN(2, RUN_MS / SUBPAGE_PERIOD_MS, camera.display_updates());
+}
+
+void test_dead_bus_keeps_display_cadence_with_last_good_frame(void)
+{
+    RecoveringCamera camera;
+    camera.run_for_ms(1'000);
+    auto last_good_frame = camera.frame();
+    camera.reset_display_stats();
+
+    // no reset function, the bus stays dead for a second
+    camera.simulator().hold_bus();
+    camera.run_for_ms(1'000);
+    camera.report("dead bus");
+    auto lost = camera.stream().lost_subpages();
+    TEST_ASSERT_UINT32_WITHIN(2, 1'000 / SUBPAGE_PERIOD_MS, lost);
+    TEST_ASSERT_EQUAL_UINT32(lost, camera.substitutes());
+    TEST_ASSERT_EQUAL_UINT32(lost, camera.acquisition().stats().errors);
+    // a substitute per sub-page period, delayed by the retry budget
+    TEST_ASSERT_LESS_THAN_UINT32(SUBPAGE_PERIOD_MS + SUBPAGE_PERIOD_MS / MLX_RETRY_BUDGET_DIVISOR + 2,
+                                 camera.max_display_gap_ms());
+    TEST_ASSERT_EQUAL_MEMORY(last_good_frame.data(), camera.frame().data(), sizeof(float) * last_good_frame.size());
+
+    camera.simulator().release_bus();
+    camera.reset_display_stats();
+    camera.run_for_ms(1'000);
+    TEST_ASSERT_EQUAL_UINT32(lost, camera.stream().lost_subpages());
+    TEST_ASSERT_EQUAL_UINT32(0, camera.substitutes());
+    TEST_ASSERT_UINT32_WITHIN(2, 1'000 / SUBPAGE_PERIOD_MS, camera.display_updates());
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_glitches_do_not_cost_subpages);
+    RUN_TEST(test_stuck_bus_is_reset);
+    RUN_TEST(test_dead_bus_keeps_display_cadence_with_last_good_frame);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
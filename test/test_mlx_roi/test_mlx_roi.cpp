@@ -0,0 +1,276 @@
+#include <ArduinoFake.h>
+#include <cmath>
+
+#include "benchmark.h"
+#include "mlx_calibration.h"
+#include "mlx_fixed_point_calibration.h"
+#include "mlx_reference_data.h"
+#include "mlx_roi.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+
+Adafruit_MLX90640 *mlx = nullptr;
+MlxFixedPointCalibration *calibration = nullptr;
+
+// reference sub-page with a hot spot (about +65 C) at the pixel, if it belongs to the sub-page
+MlxSubpageFrame subpage_with_hot_spot(size_t subpage_number, size_t pixel_index)
+{
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[subpage_number];
+    subpage_frame[pixel_index] += 400;
+    return subpage_frame;
+}
+
+// full frame of the engine for both sub-pages, the ROI monitor has to match it
+ThermoImage full_frame(MlxFixedPointCalibration &engine, size_t hot_pixel_index)
+{
+    ThermoImage temperatures{};
+    for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        engine.calculate_subpage(subpage_with_hot_spot(subpage_number, hot_pixel_index).data(), temperatures.data());
+    }
+    return temperatures;
+}
+
+void process_frame(MlxRoiMonitor<MlxFixedPointCalibration> &monitor, size_t hot_pixel_index)
+{
+    for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        monitor.process_subpage(subpage_with_hot_spot(subpage_number, hot_pixel_index).data());
+    }
+}
+
+void assert_stats_match_frame(const MlxRoi &roi, const MlxRoiStats &stats, const ThermoImage &temperatures)
+{
+    float min_temp = INFINITY;
+    float max_temp = -INFINITY;
+    float sum = 0.0f;
+    uint32_t count = 0;
+    for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+        if (roi.contains(pixel_index)) {
+            min_temp = std::min(min_temp, temperatures[pixel_index]);
+            max_temp = std::max(max_temp, temperatures[pixel_index]);
+            sum += temperatures[pixel_index];
+            count++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(count, stats.pixel_count);
+    TEST_ASSERT_EQUAL_FLOAT(min_temp, stats.min_temp);
+    TEST_ASSERT_EQUAL_FLOAT(max_temp, stats.max_temp);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, sum / count, stats.average_temp);
+    TEST_ASSERT_EQUAL_FLOAT(min_temp, temperatures[stats.min_temp_index]);
+    TEST_ASSERT_EQUAL_FLOAT(max_temp, temperatures[stats.max_temp_index]);
+    TEST_ASSERT_TRUE(roi.contains(stats.min_temp_index));
+    TEST_ASSERT_TRUE(roi.contains(stats.max_temp_index));
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    mlx = new Adafruit_MLX90640();
+    TEST_ASSERT_TRUE(mlx->loadEEPROM(mlx_reference_data::EEPROM.data()));
+    calibration = new MlxFixedPointCalibration(mlx->getParams());
+}
+
+void tearDown(void)
+{
+    delete calibration;
+    delete mlx;
+}
+
+void test_roi_stats_match_full_frame(void)
+{
+    constexpr size_t HOT_PIXEL_INDEX = 5 * MLX_SENSOR_WIDTH + 6;
+    MlxFixedPointCalibration full_frame_engine(mlx->getParams());
+    auto temperatures = full_frame(full_frame_engine, HOT_PIXEL_INDEX);
+
+    MlxRoiMonitor<MlxFixedPointCalibration> monitor(*calibration);
+    const MlxRoi rect{4, 3, 5, 4};
+    const auto spot = MlxRoi::point(20, 12);
+    const MlxRoi whole_sensor{0, 0, MLX_SENSOR_WIDTH, MLX_SENSOR_HEIGHT};
+    TEST_ASSERT_EQUAL(0, monitor.add(rect));
+    TEST_ASSERT_EQUAL(1, monitor.add(spot));
+    TEST_ASSERT_EQUAL(2, monitor.add(whole_sensor));
+    process_frame(monitor, HOT_PIXEL_INDEX);
+
+    assert_stats_match_frame(rect, monitor.stats(0), temperatures);
+    TEST_ASSERT_EQUAL_UINT32(HOT_PIXEL_INDEX, monitor.stats(0).max_temp_index);
+    assert_stats_match_frame(spot, monitor.stats(1), temperatures);
+    TEST_ASSERT_EQUAL_FLOAT(temperatures[12 * MLX_SENSOR_WIDTH + 20], monitor.stats(1).average_temp);
+    assert_stats_match_frame(whole_sensor, monitor.stats(2), temperatures);
+}
+
+void test_only_roi_pixels_are_calculated(void)
+{
+    MlxRoiMonitor<MlxFixedPointCalibration> monitor(*calibration);
+    // 4 x 4 and 3 x 3 overlapping in 2 x 2 pixels, half of the union in each chess sub-page
+    monitor.add({0, 0, 4, 4});
+    monitor.add({2, 2, 3, 3});
+    process_frame(monitor, 0);
+    TEST_ASSERT_EQUAL(21, monitor.pixel_count());
+    TEST_ASSERT_EQUAL_UINT32(10, calibration->single_pass_stats().pixels);
+
+    // an inactive region is not calculated and keeps its stats
+    auto stats = monitor.stats(0);
+    monitor.set_active(0, false);
+    process_frame(monitor, 1);
+    TEST_ASSERT_EQUAL(9, monitor.pixel_count());
+    TEST_ASSERT_EQUAL_FLOAT(stats.max_temp, monitor.stats(0).max_temp);
+    TEST_ASSERT_EQUAL_UINT32(stats.max_temp_index, monitor.stats(0).max_temp_index);
+}
+
+void test_new_roi_pixels_wait_for_their_subpage(void)
+{
+    MlxRoiMonitor<MlxFixedPointCalibration> monitor(*calibration);
+    monitor.add({0, 0, 4, 4});
+    monitor.process_subpage(mlx_reference_data::SUBPAGE_FRAMES[0].data());
+    // the other half of the region is not calculated yet
+    TEST_ASSERT_EQUAL_UINT32(8, monitor.stats(0).pixel_count);
+    monitor.process_subpage(mlx_reference_data::SUBPAGE_FRAMES[1].data());
+    TEST_ASSERT_EQUAL_UINT32(16, monitor.stats(0).pixel_count);
+
+    // pixels joining the union start over, the ones already calculated are kept
+    monitor.add({2, 0, 4, 4});
+    monitor.process_subpage(mlx_reference_data::SUBPAGE_FRAMES[0].data());
+    TEST_ASSERT_EQUAL_UINT32(16, monitor.stats(0).pixel_count);
+    TEST_ASSERT_EQUAL_UINT32(8 + 4, monitor.stats(1).pixel_count);
+
+    // interleaved mode splits by row, everything starts over
+    auto interleaved = mlx_reference_data::SUBPAGE_FRAMES[1];
+    interleaved[MLX_CONTROL_REGISTER_WORD] &= ~MLX_CONTROL_CHESS_MODE;
+    monitor.process_subpage(interleaved.data());
+    TEST_ASSERT_EQUAL_UINT32(8, monitor.stats(0).pixel_count);
+    TEST_ASSERT_EQUAL(1, monitor.stats(0).min_temp_index / MLX_SENSOR_WIDTH % 2);
+}
+
+void test_roi_slots(void)
+{
+    MlxRoiMonitor<MlxFixedPointCalibration> monitor(*calibration);
+    TEST_ASSERT_EQUAL(-1, monitor.add({30, 0, 3, 1}));
+    TEST_ASSERT_EQUAL(-1, monitor.add({0, 0, 0, 1}));
+    TEST_ASSERT_EQUAL(-1, monitor.add(MlxRoi::point(0, MLX_SENSOR_HEIGHT)));
+    for (size_t roi_index = 0; roi_index < MLX_MAX_ROI_COUNT; roi_index++) {
+        TEST_ASSERT_EQUAL(roi_index, monitor.add(MlxRoi::point(roi_index, roi_index)));
+    }
+    TEST_ASSERT_EQUAL(-1, monitor.add(MlxRoi::point(0, 0)));
+
+    // a removed slot is reused
+    monitor.remove(3);
+    TEST_ASSERT_FALSE(monitor.is_used(3));
+    TEST_ASSERT_EQUAL(3, monitor.add({10, 10, 2, 2}, false));
+    TEST_ASSERT_FALSE(monitor.is_active(3));
+    process_frame(monitor, 0);
+    TEST_ASSERT_EQUAL(MLX_MAX_ROI_COUNT - 1, monitor.pixel_count());
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.stats(3).pixel_count);
+    TEST_ASSERT_TRUE(std::isnan(monitor.stats(3).average_temp));
+
+    // the result of a failed add() is ignored
+    auto failed_index = static_cast<size_t>(monitor.add(MlxRoi::point(0, 0)));
+    monitor.remove(failed_index);
+    monitor.set_active(failed_index, false);
+    TEST_ASSERT_FALSE(monitor.is_used(failed_index));
+    TEST_ASSERT_FALSE(monitor.is_active(failed_index));
+    TEST_ASSERT_FALSE(monitor.roi(failed_index).is_on_sensor());
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.stats(failed_index).pixel_count);
+    TEST_ASSERT_EQUAL(MLX_MAX_ROI_COUNT - 1, monitor.pixel_count());
+
+    monitor.clear();
+    process_frame(monitor, 0);
+    TEST_ASSERT_EQUAL(0, monitor.pixel_count());
+}
+
+void test_compiled_engine(void)
+{
+    MlxCalibration compiled(mlx->getParams());
+    MlxRoiMonitor<MlxCalibration> monitor(compiled);
+    const MlxRoi rect{10, 8, 6, 5};
+    monitor.add(rect);
+    for (const auto &subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        monitor.process_subpage(subpage_frame.data());
+    }
+
+    ThermoImage reference{};
+    for (auto subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        mlx->calculateSubpage(subpage_frame.data(), reference.data());
+    }
+    float max_temp = -INFINITY;
+    for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+        if (rect.contains(pixel_index)) {
+            max_temp = std::max(max_temp, reference[pixel_index]);
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, max_temp, monitor.stats(0).max_temp);
+}
+
+void test_regions_from_relative_image(void)
+{
+    constexpr size_t HOT_PIXEL_INDEX = 9 * MLX_SENSOR_WIDTH + 12;
+    const MlxRoi rect{10, 8, 6, 5};
+    const auto spot = MlxRoi::point(3, 20);
+    MlxRoiMonitor<MlxFixedPointCalibration> to_monitor(*calibration);
+    to_monitor.add(rect);
+    to_monitor.add(spot);
+    process_frame(to_monitor, HOT_PIXEL_INDEX);
+
+    // the engine of the display calculates the image, the regions only convert their pixels
+    MlxFixedPointCalibration display_engine(mlx->getParams());
+    MlxRoiMonitor<MlxFixedPointCalibration> image_monitor(display_engine);
+    image_monitor.add(rect);
+    image_monitor.add(spot);
+    ThermoImage image{};
+    for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        auto subpage_frame = subpage_with_hot_spot(subpage_number, HOT_PIXEL_INDEX);
+        display_engine.calculate_subpage_image(subpage_frame.data(), image.data());
+        const auto &context = display_engine.last_context();
+        image_monitor.process_subpage_image(context.subpage_number, context.readout_mode, image.data());
+    }
+    for (size_t roi_index = 0; roi_index < 2; roi_index++) {
+        const auto &expected = to_monitor.stats(roi_index);
+        const auto &stats = image_monitor.stats(roi_index);
+        TEST_ASSERT_EQUAL_UINT32(expected.pixel_count, stats.pixel_count);
+        TEST_ASSERT_EQUAL_UINT32(expected.max_temp_index, stats.max_temp_index);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, expected.min_temp, stats.min_temp);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, expected.max_temp, stats.max_temp);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, expected.average_temp, stats.average_temp);
+    }
+    TEST_ASSERT_EQUAL_UINT32(HOT_PIXEL_INDEX, image_monitor.stats(0).max_temp_index);
+}
+
+void test_roi_benchmark(void)
+{
+    constexpr uint32_t CALLS = 500;
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    ThermoImage temperatures{};
+    MlxRoiMonitor<MlxFixedPointCalibration> monitor(*calibration);
+    // three machine parts and a spot, about 7 % of the pixels
+    monitor.add({2, 2, 5, 4});
+    monitor.add({12, 10, 6, 3});
+    monitor.add({24, 16, 4, 4});
+    monitor.add(MlxRoi::point(16, 12));
+    auto full_us = microseconds_per_call(
+            [&]() { calibration->calculate_subpage(subpage_frame.data(), temperatures.data()); }, CALLS);
+    auto roi_us = microseconds_per_call([&]() { monitor.process_subpage(subpage_frame.data()); }, CALLS);
+
+    report("per sub-page: full %.1f us, %u ROI pixels with stats %.1f us", full_us,
+           static_cast<unsigned>(monitor.pixel_count()), roi_us);
+    TEST_ASSERT_TRUE(roi_us < full_us);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_roi_stats_match_full_frame);
+    RUN_TEST(test_only_roi_pixels_are_calculated);
+    RUN_TEST(test_new_roi_pixels_wait_for_their_subpage);
+    RUN_TEST(test_roi_slots);
+    RUN_TEST(test_compiled_engine);
+    RUN_TEST(test_regions_from_relative_image);
+    RUN_TEST(test_roi_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
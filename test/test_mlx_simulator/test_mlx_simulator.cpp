@@ -0,0 +1,300 @@
+#include <ArduinoFake.h>
+#include <cmath>
+#include <cstdio>
+
+#include "mlx_acquisition.h"
+#include "mlx_reference_data.h"
+#include "mlx_simulator.h"
+#include "mlx_utils.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+constexpr uint16_t STATUS_ACKNOWLEDGE = MLX_STATUS_CLEAR_DATA_READY;
+
+MlxSimulator *simulator = nullptr;
+Adafruit_MLX90640 *mlx = nullptr;
+
+uint16_t read_register(uint16_t address)
+{
+    uint16_t value = 0;
+    TEST_ASSERT_EQUAL_INT(0, simulator->read(address, 1, &value));
+    return value;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), delay)).AlwaysReturn(); // settle time after register writes
+
+    simulator = new MlxSimulator();
+    mlx = new Adafruit_MLX90640();
+}
+
+void tearDown(void)
+{
+    delete mlx;
+    delete simulator;
+}
+
+void test_begin_reads_serial_number_and_eeprom(void)
+{
+    TEST_ASSERT_TRUE(mlx->begin(simulator));
+    TEST_ASSERT_EQUAL_HEX16(mlx_reference_data::EEPROM[7], mlx->serialNumber[0]);
+    TEST_ASSERT_EQUAL_HEX16(mlx_reference_data::EEPROM[8], mlx->serialNumber[1]);
+    TEST_ASSERT_EQUAL_HEX16(mlx_reference_data::EEPROM[9], mlx->serialNumber[2]);
+    TEST_ASSERT_TRUE(mlx->getMode() == Mlx90640PixelReadoutMode::MLX90640_CHESS);
+    TEST_ASSERT_TRUE(mlx->getRefreshRate() == Mlx90640RefreshRate::MLX90640_2_HZ);
+}
+
+void test_unmodeled_addresses_are_not_acknowledged(void)
+{
+    uint16_t data[2];
+    TEST_ASSERT_EQUAL_INT(-1, simulator->read(0x1000, 1, data));
+    TEST_ASSERT_EQUAL_INT(-1, simulator->read(MLX_RAM_START_ADDRESS + MLX_RAM_WORDS - 1, 2, data));
+    TEST_ASSERT_EQUAL_INT(-1, simulator->write(MLX_EEPROM_START_ADDRESS, 0));
+}
+
+void test_subpages_toggle_at_refresh_rate(void)
+{
+    auto period_us = simulator->subpage_period_us();
+    TEST_ASSERT_EQUAL_UINT32(500'000, period_us); // 2 Hz from the EEPROM default of control register 1
+
+    simulator->advance_us(period_us - 1000); // leave time for the status read itself
+    TEST_ASSERT_EQUAL_HEX16(0, read_register(MLX_STATUS_REGISTER) & MLX_STATUS_DATA_READY);
+
+    simulator->advance_us(1000);
+    auto status = read_register(MLX_STATUS_REGISTER);
+    TEST_ASSERT_EQUAL_HEX16(MLX_STATUS_DATA_READY, status & MLX_STATUS_DATA_READY);
+    TEST_ASSERT_EQUAL_HEX16(0, status & MLX_STATUS_SUBPAGE_MASK);
+
+    TEST_ASSERT_EQUAL_INT(0, simulator->write(MLX_STATUS_REGISTER, STATUS_ACKNOWLEDGE));
+    TEST_ASSERT_EQUAL_HEX16(0, read_register(MLX_STATUS_REGISTER) & MLX_STATUS_DATA_READY);
+
+    simulator->advance_us(period_us);
+    status = read_register(MLX_STATUS_REGISTER);
+    TEST_ASSERT_EQUAL_HEX16(MLX_STATUS_DATA_READY, status & MLX_STATUS_DATA_READY);
+    TEST_ASSERT_EQUAL_HEX16(1, status & MLX_STATUS_SUBPAGE_MASK);
+    TEST_ASSERT_EQUAL_UINT32(2, simulator->stats().subpages_measured);
+    TEST_ASSERT_EQUAL_UINT32(0, simulator->stats().subpages_dropped);
+}
+
+void test_unacknowledged_subpages_are_dropped(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, simulator->write(MLX_STATUS_REGISTER, STATUS_ACKNOWLEDGE));
+    simulator->advance_us(3 * simulator->subpage_period_us());
+    TEST_ASSERT_EQUAL_UINT32(3, simulator->stats().subpages_measured);
+    TEST_ASSERT_EQUAL_UINT32(2, simulator->stats().subpages_dropped);
+}
+
+void test_refresh_rate_and_mode_round_trip(void)
+{
+    TEST_ASSERT_TRUE(mlx->begin(simulator));
+    mlx->setRefreshRate(Mlx90640RefreshRate::MLX90640_16_HZ);
+    mlx->setMode(Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED);
+
+    TEST_ASSERT_TRUE(mlx->getRefreshRate() == Mlx90640RefreshRate::MLX90640_16_HZ);
+    TEST_ASSERT_TRUE(mlx->getMode() == Mlx90640PixelReadoutMode::MLX90640_INTERLEAVED);
+    TEST_ASSERT_EQUAL_UINT32(62'500, simulator->subpage_period_us());
+    TEST_ASSERT_EQUAL_HEX16(0, simulator->control_register() & MLX_CONTROL_CHESS_MODE);
+}
+
+void test_readout_pattern_selects_updated_pixels(void)
+{
+    for (size_t pixel_index = 0; pixel_index < MLX_SENSOR_WIDTH * MLX_SENSOR_HEIGHT; pixel_index++) {
+        simulator->set_pixel_offset(pixel_index, 100);
+    }
+    auto control = simulator->control_register() & ~MLX_CONTROL_CHESS_MODE;
+    TEST_ASSERT_EQUAL_INT(0, simulator->write(MLX_CONTROL_REGISTER_1, control));
+    simulator->advance_us(simulator->subpage_period_us()); // sub-page 0 in interleaved mode: even rows
+
+    MlxSubpageFrame frame{};
+    TEST_ASSERT_EQUAL_INT(0, simulator->read(MLX_RAM_START_ADDRESS, MLX_RAM_WORDS, frame.data()));
+    const auto &template_frame = mlx_reference_data::SUBPAGE_FRAMES[0];
+    const auto &previous_frame = mlx_reference_data::SUBPAGE_FRAMES[1];
+    for (size_t pixel_index = 0; pixel_index < MLX_SENSOR_WIDTH * MLX_SENSOR_HEIGHT; pixel_index++) {
+        bool even_row = (pixel_index / MLX_SENSOR_WIDTH) % 2 == 0;
+        uint16_t expected = even_row ? template_frame[pixel_index] + 100 : previous_frame[pixel_index];
+        TEST_ASSERT_EQUAL_HEX16(expected, frame[pixel_index]);
+    }
+}
+
+void test_get_frame_matches_reference_temperatures(void)
+{
+    TEST_ASSERT_TRUE(mlx->begin(simulator));
+    ThermoImage frame{};
+    TEST_ASSERT_EQUAL_INT(0, mlx->getFrame(frame.data()));
+
+    // the reference was calculated with emissivity 1, getFrame uses 0.95
+    for (size_t pixel_index = 0; pixel_index < frame.size(); pixel_index++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.5f, mlx_reference_data::TEMPERATURES[pixel_index], frame[pixel_index]);
+    }
+}
+
+void test_bus_time_follows_i2c_clock(void)
+{
+    MlxSubpageFrame frame{};
+    simulator->set_i2c_clock_hz(400'000);
+    TEST_ASSERT_EQUAL_INT(0, simulator->read(MLX_RAM_START_ADDRESS, MLX_RAM_WORDS, frame.data()));
+    // (4 address bytes + 1664 data bytes) * 9 bits + 3 conditions
+    TEST_ASSERT_EQUAL_UINT64(37'538, simulator->now_us());
+    TEST_ASSERT_EQUAL_UINT32(4 + 2 * MLX_RAM_WORDS, simulator->stats().bus_bytes);
+
+    simulator->reset_stats();
+    simulator->set_max_read_words(16);
+    simulator->set_i2c_clock_hz(1'000'000);
+    TEST_ASSERT_EQUAL_INT(0, simulator->read(MLX_RAM_START_ADDRESS, MLX_RAM_WORDS, frame.data()));
+    TEST_ASSERT_EQUAL_UINT32(MLX_RAM_WORDS / 16, simulator->stats().read_transactions);
+    TEST_ASSERT_EQUAL_UINT64(MLX_RAM_WORDS / 16 * (4 + 32) * 9 + MLX_RAM_WORDS / 16 * 3, simulator->stats().bus_busy_us);
+}
+
+void test_status_clear_is_verified_with_next_status_read(void)
+{
+    TEST_ASSERT_TRUE(mlx->begin(simulator));
+    auto write_stats = mlx->getWriteStats();
+    simulator->reset_stats();
+
+    TEST_ASSERT_EQUAL_INT(0, mlx->MLX90640_I2CWrite(0, MLX_STATUS_REGISTER, MLX_STATUS_CLEAR_DATA_READY));
+    // no settle time and no echo read on the bus
+    TEST_ASSERT_EQUAL_UINT32(0, simulator->stats().read_transactions);
+    TEST_ASSERT_EQUAL_UINT32(write_stats.writes + 1, mlx->getWriteStats().writes);
+    TEST_ASSERT_EQUAL_UINT32(write_stats.verifications, mlx->getWriteStats().verifications);
+
+    uint16_t status = 0;
+    TEST_ASSERT_EQUAL_INT(0, mlx->MLX90640_I2CRead(0, MLX_STATUS_REGISTER, 1, &status));
+    TEST_ASSERT_EQUAL_UINT32(write_stats.verifications + 1, mlx->getWriteStats().verifications);
+    TEST_ASSERT_EQUAL_UINT32(0, mlx->getWriteStats().verificationFailures);
+
+    // verified once only
+    TEST_ASSERT_EQUAL_INT(0, mlx->MLX90640_I2CRead(0, MLX_STATUS_REGISTER, 1, &status));
+    TEST_ASSERT_EQUAL_UINT32(write_stats.verifications + 1, mlx->getWriteStats().verifications);
+}
+
+void test_lost_writes_count_as_verification_failures(void)
+{
+    TEST_ASSERT_TRUE(mlx->begin(simulator));
+    auto control = simulator->control_register();
+
+    simulator->ignore_next_writes(1);
+    TEST_ASSERT_EQUAL_INT(-2, mlx->MLX90640_I2CWrite(0, MLX_CONTROL_REGISTER_1, control ^ MLX_CONTROL_CHESS_MODE));
+    TEST_ASSERT_EQUAL_UINT32(1, mlx->getWriteStats().verificationFailures);
+
+    simulator->ignore_next_writes(1);
+    TEST_ASSERT_EQUAL_INT(0, mlx->MLX90640_I2CWrite(0, MLX_STATUS_REGISTER, MLX_STATUS_CLEAR_DATA_READY));
+    uint16_t status = 0;
+    TEST_ASSERT_EQUAL_INT(0, mlx->MLX90640_I2CRead(0, MLX_STATUS_REGISTER, 1, &status));
+    TEST_ASSERT_EQUAL_UINT32(2, mlx->getWriteStats().verificationFailures);
+
+    // fire and forget is never checked
+    TEST_ASSERT_TRUE(mlx->setWritePolicy(MLX_CONTROL_REGISTER_1, MLX90640_WRITE_UNVERIFIED));
+    simulator->ignore_next_writes(1);
+    TEST_ASSERT_EQUAL_INT(0, mlx->MLX90640_I2CWrite(0, MLX_CONTROL_REGISTER_1, control ^ MLX_CONTROL_CHESS_MODE));
+    TEST_ASSERT_EQUAL_UINT32(2, mlx->getWriteStats().verificationFailures);
+}
+
+struct AcquisitionRun
+{
+    uint32_t subpages_measured;
+    uint32_t subpages_dropped;
+    uint32_t subpages_delivered;
+    uint32_t errors;
+    float frame_rate_hz;
+    float drop_rate;
+};
+
+// Drives MlxSubpageAcquisition like loop() does (1 ms of other work whenever no sub-page is ready) on the simulated
+// sensor for the given virtual time
+AcquisitionRun run_acquisition(Mlx90640RefreshRate refresh_rate, uint32_t i2c_clock_hz, uint32_t duration_ms)
+{
+    MlxSimulator sensor;
+    Adafruit_MLX90640 sensor_mlx;
+    sensor.set_i2c_clock_hz(i2c_clock_hz);
+    TEST_ASSERT_TRUE(sensor_mlx.begin(&sensor));
+    sensor_mlx.setRefreshRate(refresh_rate);
+
+    MlxSubpageAcquisition acquisition(
+            [&sensor_mlx](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                return sensor_mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+            },
+            [&sensor_mlx](uint16_t address, uint16_t value) { return sensor_mlx.MLX90640_I2CWrite(0, address, value); },
+            [&sensor]() { return sensor.now_ms(); },
+            mlx_utils::convert_refresh_rate_to_ms(refresh_rate));
+
+    sensor.reset_stats();
+    auto end_ms = sensor.now_ms() + duration_ms;
+    AcquisitionRun run{};
+    while (sensor.now_ms() < end_ms) {
+        if (acquisition.state() == AcquisitionState::IDLE) {
+            acquisition.begin_subpage();
+        }
+        if (acquisition.poll() == AcquisitionState::READY) {
+            run.subpages_delivered++;
+            acquisition.release_subpage();
+            continue;
+        }
+        if (acquisition.last_error() != 0) {
+            run.errors++;
+            continue;
+        }
+        sensor.advance_ms(1);
+    }
+
+    run.subpages_measured = sensor.stats().subpages_measured;
+    run.subpages_dropped = sensor.stats().subpages_dropped;
+    run.frame_rate_hz = run.subpages_delivered / 2.0f / (duration_ms / 1000.0f);
+    // includes sub-pages overwritten during the RAM transfer and the one still in flight at the end
+    run.drop_rate = 1.0f - float(run.subpages_delivered) / run.subpages_measured;
+    return run;
+}
+
+void test_frame_rate_and_drop_rate_per_refresh_rate(void)
+{
+    constexpr uint32_t I2C_CLOCKS_HZ[] = {400'000, 1'000'000};
+    constexpr uint8_t REFRESH_RATES = 8;
+
+    for (auto i2c_clock_hz : I2C_CLOCKS_HZ) {
+        for (uint8_t rate = 0; rate < REFRESH_RATES; rate++) {
+            auto refresh_rate = static_cast<Mlx90640RefreshRate>(rate);
+            // about 20 sub-pages per refresh rate
+            auto duration_ms = 20 * mlx_utils::convert_refresh_rate_to_ms(refresh_rate);
+            auto run = run_acquisition(refresh_rate, i2c_clock_hz, duration_ms);
+
+            char message[160];
+            snprintf(message, sizeof(message),
+                     "I2C %4lu kHz, refresh code %u: %6.2f frames/s, %5.1f %% dropped (%lu unacknowledged), %lu errors",
+                     static_cast<unsigned long>(i2c_clock_hz / 1000), rate, run.frame_rate_hz, run.drop_rate * 100,
+                     static_cast<unsigned long>(run.subpages_dropped), static_cast<unsigned long>(run.errors));
+            TEST_MESSAGE(message);
+
+            // the RAM transfer fits easily into the sub-page period up to 8 Hz
+            if (rate <= static_cast<uint8_t>(Mlx90640RefreshRate::MLX90640_8_HZ)) {
+                TEST_ASSERT_EQUAL_UINT32(0, run.errors);
+                TEST_ASSERT_EQUAL_UINT32(0, run.subpages_dropped);
+                TEST_ASSERT_LESS_OR_EQUAL_UINT32(run.subpages_delivered + 1, run.subpages_measured);
+            }
+        }
+    }
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_reads_serial_number_and_eeprom);
+    RUN_TEST(test_unmodeled_addresses_are_not_acknowledged);
+    RUN_TEST(test_subpages_toggle_at_refresh_rate);
+    RUN_TEST(test_unacknowledged_subpages_are_dropped);
+    RUN_TEST(test_refresh_rate_and_mode_round_trip);
+    RUN_TEST(test_readout_pattern_selects_updated_pixels);
+    RUN_TEST(test_get_frame_matches_reference_temperatures);
+    RUN_TEST(test_bus_time_follows_i2c_clock);
+    RUN_TEST(test_status_clear_is_verified_with_next_status_read);
+    RUN_TEST(test_lost_writes_count_as_verification_failures);
+    RUN_TEST(test_frame_rate_and_drop_rate_per_refresh_rate);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
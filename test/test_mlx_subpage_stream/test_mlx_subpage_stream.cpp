@@ -0,0 +1,145 @@
+#include <ArduinoFake.h>
+
+#include "mlx_acquisition.h"
+#include "mlx_simulator.h"
+#include "mlx_subpage_stream.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+constexpr float UNSET = -1000.0f;
+
+// stand-in for the To calculation: 100 for sub-page 0, 101 for sub-page 1 in every pixel, the stream has to pick
+// the pixels of the sub-page
+void calculate_subpage_number(uint16_t *subpage_frame, float *temperatures)
+{
+    float value = 100.0f + (subpage_frame[MLX_SUBPAGE_NUMBER_WORD] & MLX_STATUS_SUBPAGE_MASK);
+    for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+        temperatures[pixel_index] = value;
+    }
+}
+
+// chess mode splits by row ^ column, interleaved mode by row
+uint8_t expected_subpage(size_t pixel_index, Mlx90640PixelReadoutMode readout_mode)
+{
+    size_t row = pixel_index / MLX_SENSOR_WIDTH;
+    size_t column = pixel_index % MLX_SENSOR_WIDTH;
+    return readout_mode == Mlx90640PixelReadoutMode::MLX90640_CHESS ? (row + column) % 2 : row % 2;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), delay)).AlwaysReturn(); // settle time after register writes
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_merge_overwrites_only_the_subpage(void)
+{
+    for (auto readout_mode : {MLX90640_CHESS, MLX90640_INTERLEAVED}) {
+        ThermoImage frame{};
+        frame.fill(UNSET);
+        ThermoImage temperatures{};
+        for (uint8_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+            temperatures.fill(100.0f + subpage_number);
+            ComputedSubpage subpage{.subpage_number = subpage_number,
+                                    .readout_mode = readout_mode,
+                                    .sequence_number = subpage_number,
+                                    .is_substitute = false,
+                                    .temperatures = &temperatures,
+                                    .stats = {}};
+            merge_subpage_into_frame(subpage, frame);
+            size_t changed = 0;
+            for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+                auto pixel_subpage = expected_subpage(pixel_index, readout_mode);
+                if (pixel_subpage <= subpage_number) {
+                    TEST_ASSERT_EQUAL_FLOAT(100.0f + pixel_subpage, frame[pixel_index]);
+                    changed += pixel_subpage == subpage_number;
+                } else {
+                    TEST_ASSERT_EQUAL_FLOAT(UNSET, frame[pixel_index]);
+                }
+            }
+            TEST_ASSERT_EQUAL(MLX_PIXEL_COUNT / 2, changed);
+        }
+
+        // a substitute keeps the last good values of its half
+        auto merged = frame;
+        temperatures.fill(UNSET);
+        ComputedSubpage substitute{.subpage_number = 0,
+                                   .readout_mode = readout_mode,
+                                   .sequence_number = 2,
+                                   .is_substitute = true,
+                                   .temperatures = &temperatures,
+                                   .stats = {}};
+        merge_subpage_into_frame(substitute, frame);
+        TEST_ASSERT_EQUAL_MEMORY(merged.data(), frame.data(), sizeof(float) * merged.size());
+    }
+}
+
+// The stream on the simulated sensor, both readout modes: the first sub-page fills its half of the frame, the
+// second one completes it
+void test_stream_merges_a_full_frame(void)
+{
+    for (auto readout_mode : {MLX90640_CHESS, MLX90640_INTERLEAVED}) {
+        MlxSimulator simulator;
+        Adafruit_MLX90640 mlx;
+        TEST_ASSERT_TRUE(mlx.begin(&simulator));
+        mlx.setRefreshRate(Mlx90640RefreshRate::MLX90640_64_HZ);
+        mlx.setMode(readout_mode);
+
+        MlxSubpageAcquisition acquisition(
+                [&mlx](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                    return mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+                },
+                [&mlx](uint16_t address, uint16_t value) { return mlx.MLX90640_I2CWrite(0, address, value); },
+                [&simulator]() { return simulator.now_ms(); },
+                simulator.subpage_period_us() / 1000);
+        MlxSubpageStream stream(acquisition, MlxSubpageStream::CalculateFunction(calculate_subpage_number));
+
+        ThermoImage frame{};
+        frame.fill(UNSET);
+        TEST_ASSERT_FALSE(stream.has_full_frame());
+        for (int received = 0; received < 2;) {
+            stream.acquire();
+            stream.process();
+            simulator.advance_us(500);
+            ComputedSubpage subpage;
+            if (!stream.next(subpage)) {
+                continue;
+            }
+            TEST_ASSERT_FALSE(subpage.is_substitute);
+            TEST_ASSERT_TRUE(subpage.readout_mode == readout_mode);
+            merge_subpage_into_frame(subpage, frame);
+            stream.release(subpage);
+            received++;
+
+            size_t set_pixels = 0;
+            for (size_t pixel_index = 0; pixel_index < MLX_PIXEL_COUNT; pixel_index++) {
+                if (expected_subpage(pixel_index, readout_mode) == subpage.subpage_number) {
+                    TEST_ASSERT_EQUAL_FLOAT(100.0f + subpage.subpage_number, frame[pixel_index]);
+                }
+                set_pixels += frame[pixel_index] != UNSET;
+            }
+            TEST_ASSERT_EQUAL(received * MLX_PIXEL_COUNT / 2, set_pixels);
+            TEST_ASSERT_EQUAL(received == 2, stream.has_full_frame());
+        }
+    }
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_merge_overwrites_only_the_subpage);
+    RUN_TEST(test_stream_merges_a_full_frame);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
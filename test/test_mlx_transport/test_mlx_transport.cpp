@@ -0,0 +1,157 @@
+#include <ArduinoFake.h>
+#include <cstdio>
+
+#include "in_memory_mlx_transport.h"
+#include "mlx_acquisition.h"
+#include "mlx_reference_data.h"
+#include "mlx_simulator.h"
+#include "mlx_transport.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+
+MlxSimulator *simulator = nullptr;
+InMemoryMlxTransport *transport = nullptr;
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), delay)).AlwaysReturn(); // settle time after register writes
+
+    simulator = new MlxSimulator();
+    transport = new InMemoryMlxTransport(*simulator, []() { return static_cast<unsigned long>(simulator->now_us()); });
+}
+
+void tearDown(void)
+{
+    delete transport;
+    delete simulator;
+}
+
+void test_copy_words_from_wire_swaps_bytes(void)
+{
+    const uint8_t wire_bytes[] = {0x12, 0x34, 0xAB, 0xCD};
+    uint16_t words[2] = {};
+    copy_words_from_wire(wire_bytes, 2, words);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, words[0]);
+    TEST_ASSERT_EQUAL_HEX16(0xABCD, words[1]);
+}
+
+void test_submitted_read_completes_on_poll(void)
+{
+    uint16_t eeprom[MLX_EEPROM_WORDS] = {};
+    int completion_error = 1;
+    uint32_t completions = 0;
+    TEST_ASSERT_TRUE(transport->submit_read(MLX_EEPROM_START_ADDRESS, MLX_EEPROM_WORDS, eeprom, [&](int error) {
+        completion_error = error;
+        completions++;
+    }));
+    TEST_ASSERT_TRUE(transport->is_busy());
+    TEST_ASSERT_FALSE(transport->submit_read(MLX_EEPROM_START_ADDRESS, 1, eeprom));
+    TEST_ASSERT_EQUAL_INT(-1, transport->write(MLX_STATUS_REGISTER, 0));
+
+    uint32_t polls = 1;
+    while (transport->poll() == TransferState::BUSY) {
+        TEST_ASSERT_EQUAL_HEX16(0, eeprom[0]); // destination untouched until completion
+        polls++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(MLX_EEPROM_WORDS / 64, polls);
+    TEST_ASSERT_TRUE(transport->state() == TransferState::DONE);
+    TEST_ASSERT_EQUAL_UINT32(1, completions);
+    TEST_ASSERT_EQUAL_INT(0, completion_error);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(mlx_reference_data::EEPROM.data(), eeprom, MLX_EEPROM_WORDS);
+}
+
+void test_failed_read_is_reported(void)
+{
+    uint16_t data[4];
+    int completion_error = 0;
+    TEST_ASSERT_TRUE(transport->submit_read(0x1000, 4, data, [&](int error) { completion_error = error; }));
+    TEST_ASSERT_TRUE(transport->poll() == TransferState::FAILED);
+    TEST_ASSERT_EQUAL_INT(-1, completion_error);
+    TEST_ASSERT_EQUAL_INT(-1, transport->read(0x1000, 4, data));
+    TEST_ASSERT_EQUAL_UINT32(2, transport->stats().failed_transactions);
+
+    uint16_t too_long[MLX_TRANSPORT_MAX_READ_WORDS + 1];
+    TEST_ASSERT_FALSE(transport->submit_read(MLX_RAM_START_ADDRESS, MLX_TRANSPORT_MAX_READ_WORDS + 1, too_long));
+}
+
+void test_adafruit_driver_runs_on_blocking_read(void)
+{
+    Adafruit_MLX90640 mlx;
+    TEST_ASSERT_TRUE(mlx.begin(transport));
+    TEST_ASSERT_EQUAL_HEX16(mlx_reference_data::EEPROM[7], mlx.serialNumber[0]);
+    TEST_ASSERT_TRUE(mlx.getMode() == Mlx90640PixelReadoutMode::MLX90640_CHESS);
+}
+
+void test_acquisition_returns_while_ram_is_on_the_bus(void)
+{
+    Adafruit_MLX90640 mlx;
+    TEST_ASSERT_TRUE(mlx.begin(transport));
+    MlxSubpageAcquisition acquisition(
+            *transport,
+            [&mlx](uint16_t start_address, uint16_t word_count, uint16_t *data) {
+                return mlx.MLX90640_I2CRead(0, start_address, word_count, data);
+            },
+            [&mlx](uint16_t address, uint16_t value) { return mlx.MLX90640_I2CWrite(0, address, value); },
+            []() { return simulator->now_ms(); },
+            simulator->subpage_period_us() / 1000);
+
+    for (int subpage = 0; subpage < 4; subpage++) {
+        acquisition.begin_subpage();
+        auto polls_during_transfer = acquisition.stats().polls_during_transfer;
+        while (acquisition.poll() != AcquisitionState::READY) {
+            TEST_ASSERT_EQUAL_INT(0, acquisition.last_error());
+            if (acquisition.state() == AcquisitionState::WAITING_FOR_READY) {
+                simulator->advance_ms(1);
+            }
+        }
+        // one return per 64 word chunk except the last one
+        TEST_ASSERT_EQUAL_UINT32(MLX_RAM_WORDS / 64 - 1, acquisition.stats().polls_during_transfer - polls_during_transfer);
+
+        const auto &frame = acquisition.subpage_frame();
+        auto subpage_number = frame[MLX_SUBPAGE_NUMBER_WORD];
+        TEST_ASSERT_EQUAL_HEX16(mlx_reference_data::SUBPAGE_FRAMES[subpage_number][MLX_RAM_WORDS - 1],
+                                frame[MLX_RAM_WORDS - 1]);
+        acquisition.release_subpage();
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, acquisition.stats().subpages_read);
+}
+
+void test_throughput_is_reported(void)
+{
+    uint16_t ram[MLX_RAM_WORDS];
+    for (uint32_t i2c_clock_hz : {400'000u, 1'000'000u}) {
+        simulator->set_i2c_clock_hz(i2c_clock_hz);
+        transport->reset_stats();
+        TEST_ASSERT_EQUAL_INT(0, transport->read(MLX_RAM_START_ADDRESS, MLX_RAM_WORDS, ram));
+
+        auto bytes_per_second = transport->stats().bytes_per_second();
+        char message[96];
+        snprintf(message, sizeof(message), "in-memory backend, I2C %4lu kHz: %lu bytes/s",
+                 static_cast<unsigned long>(i2c_clock_hz / 1000), static_cast<unsigned long>(bytes_per_second));
+        TEST_MESSAGE(message);
+
+        // 9 clocks per byte + addressing of the 64 word chunks of the in-memory backend
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(i2c_clock_hz / 9, bytes_per_second);
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(i2c_clock_hz / 9 * 9 / 10, bytes_per_second);
+    }
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_copy_words_from_wire_swaps_bytes);
+    RUN_TEST(test_submitted_read_completes_on_poll);
+    RUN_TEST(test_failed_read_is_reported);
+    RUN_TEST(test_adafruit_driver_runs_on_blocking_read);
+    RUN_TEST(test_acquisition_returns_while_ram_is_on_the_bus);
+    RUN_TEST(test_throughput_is_reported);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
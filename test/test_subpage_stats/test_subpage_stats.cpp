@@ -0,0 +1,194 @@
+#include <ArduinoFake.h>
+
+#include "benchmark.h"
+#include "mlx_bad_pixels.h"
+#include "mlx_calibration.h"
+#include "mlx_fixed_point_calibration.h"
+#include "mlx_reference_data.h"
+#include "mlx_utils.h"
+#include "types/common_types.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+
+constexpr size_t HOT_PIXEL_INDEX = 11 * MLX_SENSOR_WIDTH + 19;
+constexpr size_t COLD_PIXEL_INDEX = 20 * MLX_SENSOR_WIDTH + 4;
+
+Adafruit_MLX90640 *mlx = nullptr;
+
+// reference sub-page with a hot and a cold spot, each in the sub-page it belongs to
+MlxSubpageFrame subpage_with_spots(size_t subpage_number, bool is_chess_mode = true)
+{
+    auto subpage_frame = mlx_reference_data::SUBPAGE_FRAMES[subpage_number];
+    if (!is_chess_mode) {
+        subpage_frame[MLX_CONTROL_REGISTER_WORD] &= ~MLX_CONTROL_CHESS_MODE;
+    }
+    subpage_frame[HOT_PIXEL_INDEX] += 400;
+    subpage_frame[COLD_PIXEL_INDEX] -= 150;
+    return subpage_frame;
+}
+
+// frame path of the firmware: both sub-pages with the stats sink, then the frame stats merged from them
+template <typename Calibration>
+void calculate_fused(Calibration &calibration,
+                     ThermoImage &temperatures,
+                     ThermoImageStats &tis,
+                     bool is_chess_mode = true)
+{
+    std::array<SubpageStats, 2> subpage_stats{};
+    for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        auto &stats = subpage_stats[subpage_number];
+        calibration.calculate_subpage(subpage_with_spots(subpage_number, is_chess_mode).data(), temperatures.data(),
+                                      [&stats](size_t pixel_index, float temperature) {
+                                          stats.add(pixel_index, temperature);
+                                      });
+    }
+    mlx_utils::update_thermo_image_stats_from_subpages(subpage_stats, temperatures, tis);
+}
+
+void assert_stats_equal(const ThermoImageStats &expected, const ThermoImageStats &actual)
+{
+    TEST_ASSERT_EQUAL_FLOAT(expected.min_temp, actual.min_temp);
+    TEST_ASSERT_EQUAL_FLOAT(expected.max_temp, actual.max_temp);
+    TEST_ASSERT_EQUAL_UINT32(expected.min_temp_index, actual.min_temp_index);
+    TEST_ASSERT_EQUAL_UINT32(expected.max_temp_index, actual.max_temp_index);
+    TEST_ASSERT_EQUAL_FLOAT(expected.center_temp, actual.center_temp);
+    // summed in another order
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected.average_temp, actual.average_temp);
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+    mlx = new Adafruit_MLX90640();
+    TEST_ASSERT_TRUE(mlx->loadEEPROM(mlx_reference_data::EEPROM.data()));
+}
+
+void tearDown(void)
+{
+    delete mlx;
+}
+
+void test_fused_stats_match_frame_stats(void)
+{
+    MlxFixedPointCalibration fixed_point(mlx->getParams());
+    MlxCalibration compiled(mlx->getParams());
+    for (auto is_chess_mode : {true, false}) {
+        ThermoImage temperatures{};
+        ThermoImageStats fused{};
+        ThermoImageStats expected{};
+        calculate_fused(fixed_point, temperatures, fused, is_chess_mode);
+        mlx_utils::update_thermo_image_stats_from_frame(temperatures, expected);
+        assert_stats_equal(expected, fused);
+        TEST_ASSERT_EQUAL_UINT32(HOT_PIXEL_INDEX, fused.max_temp_index);
+        TEST_ASSERT_EQUAL_UINT32(COLD_PIXEL_INDEX, fused.min_temp_index);
+
+        calculate_fused(compiled, temperatures, fused, is_chess_mode);
+        mlx_utils::update_thermo_image_stats_from_frame(temperatures, expected);
+        assert_stats_equal(expected, fused);
+    }
+}
+
+void test_ties_like_minmax_element(void)
+{
+    ThermoImage temperatures{};
+    temperatures.fill(21.5f);
+    std::array<SubpageStats, 2> subpage_stats{};
+    for (uint8_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        for (auto pixel_index : subpage_pixel_indices(subpage_number, Mlx90640PixelReadoutMode::MLX90640_CHESS)) {
+            subpage_stats[subpage_number].add(pixel_index, temperatures[pixel_index]);
+        }
+    }
+    ThermoImageStats fused{};
+    ThermoImageStats expected{};
+    mlx_utils::update_thermo_image_stats_from_subpages(subpage_stats, temperatures, fused);
+    mlx_utils::update_thermo_image_stats_from_frame(temperatures, expected);
+    assert_stats_equal(expected, fused);
+    TEST_ASSERT_EQUAL_UINT32(0, fused.min_temp_index);
+    TEST_ASSERT_EQUAL_UINT32(MLX_PIXEL_COUNT - 1, fused.max_temp_index);
+}
+
+void test_bad_pixels_count_with_corrected_values(void)
+{
+    // the hot spot is a bad pixel, the corrected frame has its max elsewhere
+    auto eeprom = mlx_reference_data::EEPROM;
+    eeprom[64 + HOT_PIXEL_INDEX] |= 1;
+    TEST_ASSERT_TRUE(mlx->loadEEPROM(eeprom.data()));
+    MlxFixedPointCalibration calibration(mlx->getParams());
+    MlxBadPixelCorrection correction(mlx->getParams());
+
+    ThermoImage temperatures{};
+    std::array<SubpageStats, 2> subpage_stats{};
+    for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+        auto &stats = subpage_stats[subpage_number];
+        auto subpage_frame = subpage_with_spots(subpage_number);
+        calibration.calculate_subpage(subpage_frame.data(), temperatures.data(),
+                                      [&stats, &correction](size_t pixel_index, float temperature) {
+                                          if (!correction.is_bad(pixel_index)) {
+                                              stats.add(pixel_index, temperature);
+                                          }
+                                      });
+        correction.correct_subpage(subpage_frame.data(), temperatures.data(),
+                                   [&stats](size_t pixel_index, float value) { stats.add(pixel_index, value); });
+    }
+    ThermoImageStats fused{};
+    ThermoImageStats expected{};
+    mlx_utils::update_thermo_image_stats_from_subpages(subpage_stats, temperatures, fused);
+    mlx_utils::update_thermo_image_stats_from_frame(temperatures, expected);
+    assert_stats_equal(expected, fused);
+    TEST_ASSERT_TRUE(fused.max_temp_index != HOT_PIXEL_INDEX);
+    TEST_ASSERT_EQUAL(MLX_PIXEL_COUNT, subpage_stats[0].pixel_count + subpage_stats[1].pixel_count);
+}
+
+void test_fused_stats_benchmark(void)
+{
+    constexpr uint32_t CALLS = 500;
+    MlxFixedPointCalibration calibration(mlx->getParams());
+    std::array<MlxSubpageFrame, 2> subpage_frames{subpage_with_spots(0), subpage_with_spots(1)};
+    ThermoImage temperatures{};
+    ThermoImageStats tis{};
+    auto passes_us = microseconds_per_call(
+            [&]() {
+                for (const auto &subpage_frame : subpage_frames) {
+                    calibration.calculate_subpage(subpage_frame.data(), temperatures.data());
+                }
+                mlx_utils::update_thermo_image_stats_from_frame(temperatures, tis);
+            },
+            CALLS);
+    auto fused_us = microseconds_per_call(
+            [&]() {
+                std::array<SubpageStats, 2> subpage_stats{};
+                for (size_t subpage_number = 0; subpage_number < 2; subpage_number++) {
+                    auto &stats = subpage_stats[subpage_number];
+                    calibration.calculate_subpage(subpage_frames[subpage_number].data(), temperatures.data(),
+                                                  [&stats](size_t pixel_index, float temperature) {
+                                                      stats.add(pixel_index, temperature);
+                                                  });
+                }
+                mlx_utils::update_thermo_image_stats_from_subpages(subpage_stats, temperatures, tis);
+            },
+            CALLS);
+    auto stats_us = microseconds_per_call([&]() { mlx_utils::update_thermo_image_stats_from_frame(temperatures, tis); },
+                                          CALLS);
+
+    report("per frame: calculation + stats passes %.1f us, with fused stats %.1f us (the two passes alone %.1f us)",
+           passes_us, fused_us, stats_us);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fused_stats_match_frame_stats);
+    RUN_TEST(test_ties_like_minmax_element);
+    RUN_TEST(test_bad_pixels_count_with_corrected_values);
+    RUN_TEST(test_fused_stats_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
@@ -0,0 +1,152 @@
+#include <ArduinoFake.h>
+#include <algorithm>
+#include <cmath>
+
+#include "benchmark.h"
+#include "mlx_fixed_point_calibration.h"
+#include "mlx_reference_data.h"
+#include "mlx_utils.h"
+#include "temperature_histogram.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+
+// frame of the reference sensor, about 28 C with a warmer area of 33 C
+ThermoImage reference_frame()
+{
+    Adafruit_MLX90640 mlx;
+    TEST_ASSERT_TRUE(mlx.loadEEPROM(mlx_reference_data::EEPROM.data()));
+    MlxFixedPointCalibration calibration(mlx.getParams());
+    ThermoImage temperatures{};
+    for (const auto &subpage_frame : mlx_reference_data::SUBPAGE_FRAMES) {
+        calibration.calculate_subpage(subpage_frame.data(), temperatures.data());
+    }
+    return temperatures;
+}
+
+// percentile of the sorted values, linear between ranks
+float sorted_percentile(ThermoImage frame, float fraction)
+{
+    std::sort(frame.begin(), frame.end());
+    auto position = fraction * (frame.size() - 1);
+    auto rank = static_cast<size_t>(position);
+    auto next = std::min(rank + 1, frame.size() - 1);
+    return frame[rank] + (position - rank) * (frame[next] - frame[rank]);
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_percentiles_match_sorted_frame(void)
+{
+    auto frame = reference_frame();
+    TemperatureHistogram histogram;
+    histogram.update_from_frame(frame);
+    TEST_ASSERT_EQUAL_UINT32(MLX_PIXEL_COUNT, histogram.count());
+    for (auto fraction : {0.0f, 0.01f, 0.1f, 0.5f, 0.9f, 0.99f, 1.0f}) {
+        TEST_ASSERT_FLOAT_WITHIN(TEMPERATURE_HISTOGRAM_BIN_WIDTH, sorted_percentile(frame, fraction),
+                                 histogram.percentile(fraction));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(TEMPERATURE_HISTOGRAM_BIN_WIDTH, sorted_percentile(frame, 0.5f), histogram.median());
+    // the background of the scene is the fullest bin
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 28.5f, histogram.mode());
+    auto [min_temp, max_temp] = std::minmax_element(frame.begin(), frame.end());
+    TEST_ASSERT_TRUE(histogram.percentile(0.0f) >= *min_temp - TEMPERATURE_HISTOGRAM_BIN_WIDTH);
+    TEST_ASSERT_TRUE(histogram.percentile(1.0f) <= *max_temp + TEMPERATURE_HISTOGRAM_BIN_WIDTH);
+}
+
+void test_range_and_invalid_values(void)
+{
+    TemperatureHistogram histogram;
+    TEST_ASSERT_TRUE(std::isnan(histogram.percentile(0.5f)));
+    TEST_ASSERT_TRUE(std::isnan(histogram.mode()));
+
+    histogram.add(NAN);
+    histogram.add(-100.0f);
+    histogram.add(1000.0f);
+    histogram.add(INFINITY);
+    TEST_ASSERT_EQUAL_UINT32(3, histogram.count());
+    TEST_ASSERT_EQUAL_UINT16(1, histogram.counts().front());
+    TEST_ASSERT_EQUAL_UINT16(2, histogram.counts().back());
+    TEST_ASSERT_FLOAT_WITHIN(TEMPERATURE_HISTOGRAM_BIN_WIDTH, TEMPERATURE_HISTOGRAM_MIN_TEMP,
+                             histogram.percentile(0.0f));
+
+    histogram.clear();
+    histogram.add(20.1f);
+    TEST_ASSERT_FLOAT_WITHIN(TEMPERATURE_HISTOGRAM_BIN_WIDTH, 20.1f, histogram.percentile(0.0f));
+    TEST_ASSERT_FLOAT_WITHIN(TEMPERATURE_HISTOGRAM_BIN_WIDTH, 20.1f, histogram.percentile(1.0f));
+    TEST_ASSERT_FLOAT_WITHIN(TEMPERATURE_HISTOGRAM_BIN_WIDTH / 2, 20.1f, histogram.mode());
+}
+
+void test_outlier_pixels_do_not_take_the_scale(void)
+{
+    auto frame = reference_frame();
+    TemperatureHistogram histogram;
+    histogram.update_from_frame(frame);
+    auto scene_low = histogram.percentile(0.01f);
+    auto scene_high = histogram.percentile(0.99f);
+
+    // a few hot and dead pixels, a NaN one
+    frame[100] = 250.0f;
+    frame[333] = 180.0f;
+    frame[600] = 300.0f;
+    frame[42] = -40.0f;
+    frame[700] = -12.0f;
+    frame[500] = NAN;
+    ThermoImageStats tis{};
+    mlx_utils::update_thermo_image_stats_from_frame(frame, tis);
+    histogram.update_from_frame(frame);
+    auto low = histogram.percentile(0.01f);
+    auto high = histogram.percentile(0.99f);
+
+    report("scale with 5 outliers: min / max %.1f .. %.1f C, 1 %% / 99 %% %.1f .. %.1f C", tis.min_temp,
+           tis.max_temp, low, high);
+    TEST_ASSERT_TRUE(tis.max_temp - tis.min_temp > 300.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, scene_low, low);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, scene_high, high);
+}
+
+void test_histogram_benchmark(void)
+{
+    constexpr uint32_t CALLS = 2000;
+    auto frame = reference_frame();
+    TemperatureHistogram histogram;
+    ThermoImageStats tis{};
+    float scale = 0.0f;
+    auto min_max_us = microseconds_per_call([&]() { mlx_utils::update_thermo_image_stats_from_frame(frame, tis); },
+                                            CALLS);
+    auto histogram_us = microseconds_per_call(
+            [&]() {
+                histogram.update_from_frame(frame);
+                scale += histogram.percentile(0.01f) + histogram.percentile(0.99f);
+            },
+            CALLS);
+
+    report("per frame: min / max stats %.2f us, histogram and two percentiles %.2f us", min_max_us, histogram_us);
+    TEST_ASSERT_TRUE(scale > 0.0f);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_percentiles_match_sorted_frame);
+    RUN_TEST(test_range_and_invalid_values);
+    RUN_TEST(test_outlier_pixels_do_not_take_the_scale);
+    RUN_TEST(test_histogram_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}
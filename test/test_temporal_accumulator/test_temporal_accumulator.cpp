@@ -0,0 +1,184 @@
+#include <ArduinoFake.h>
+#include <cmath>
+#include <vector>
+
+#include "benchmark.h"
+#include "mlx_utils.h"
+#include "pseudo_random.h"
+#include "temporal_accumulator.h"
+#include "types/container_types.h"
+#include "unity.h"
+
+using namespace fakeit;
+using namespace thermocam;
+using namespace thermocam::benchmark;
+
+// noisy frame around the temperature, +-1 C
+ThermoImage random_frame(float temperature)
+{
+    static pseudo_random::Lcg random;
+    ThermoImage frame{};
+    for (auto &value : frame) {
+        value = temperature - 1.0f + 2.0f * random.uniform();
+    }
+    return frame;
+}
+
+void setUp(void)
+{
+    ArduinoFakeReset();
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_exponential_mean(void)
+{
+    constexpr float SMOOTHING = 0.25f;
+    TemporalAccumulator accumulator(SMOOTHING);
+    auto first = random_frame(20.0f);
+    accumulator.update(first);
+    TEST_ASSERT_EQUAL_MEMORY(first.data(), accumulator.mean().data(), sizeof(float) * first.size());
+
+    auto expected = first;
+    for (int frame_number = 0; frame_number < 40; frame_number++) {
+        auto frame = random_frame(30.0f);
+        for (size_t pixel_index = 0; pixel_index < frame.size(); pixel_index++) {
+            expected[pixel_index] += SMOOTHING * (frame[pixel_index] - expected[pixel_index]);
+        }
+        accumulator.update(frame);
+    }
+    for (size_t pixel_index = 0; pixel_index < expected.size(); pixel_index++) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected[pixel_index], accumulator.mean()[pixel_index]);
+    }
+    // settled on the scene, the noise averaged down
+    TEST_ASSERT_FLOAT_WITHIN(0.6f, 30.0f, accumulator.mean()[100]);
+    TEST_ASSERT_EQUAL_UINT32(41, accumulator.frame_count());
+}
+
+void test_windowed_mean_matches_history(void)
+{
+    constexpr uint32_t WINDOW_FRAMES = 12;
+    TemporalAccumulator accumulator(0.1f, WINDOW_FRAMES);
+    std::vector<ThermoImage> history;
+    for (int frame_number = 0; frame_number < 50; frame_number++) {
+        // a step in the middle, the window has to forget the old scene
+        history.push_back(random_frame(frame_number < 25 ? 20.0f : 35.0f));
+        accumulator.update(history.back());
+
+        auto count = accumulator.window_frame_count();
+        TEST_ASSERT_TRUE(count > 0 && count <= WINDOW_FRAMES);
+        // less up to one block
+        constexpr auto MIN_COUNT = WINDOW_FRAMES - WINDOW_FRAMES / TEMPORAL_WINDOW_BLOCKS;
+        TEST_ASSERT_TRUE(history.size() < WINDOW_FRAMES || count >= MIN_COUNT);
+        for (size_t pixel_index = 0; pixel_index < history.back().size(); pixel_index += 37) {
+            float sum = 0.0f;
+            for (size_t i = history.size() - count; i < history.size(); i++) {
+                sum += history[i][pixel_index];
+            }
+            TEST_ASSERT_FLOAT_WITHIN(1e-3f, sum / count, accumulator.windowed_mean()[pixel_index]);
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.6f, 35.0f, accumulator.windowed_mean()[0]);
+}
+
+void test_holds_with_decay_and_reset(void)
+{
+    TemporalAccumulator holding;
+    TemporalAccumulator decaying(0.1f, 32, 0.5f);
+    ThermoImage frame{};
+    frame.fill(25.0f);
+    for (auto *accumulator : {&holding, &decaying}) {
+        accumulator->update(frame);
+    }
+    // short hot and cold flashes, one of the pixels NaN afterwards
+    frame[10] = 80.0f;
+    frame[11] = 80.0f;
+    frame[20] = -5.0f;
+    for (auto *accumulator : {&holding, &decaying}) {
+        accumulator->update(frame);
+    }
+    frame[10] = NAN;
+    frame[11] = 25.0f;
+    frame[20] = 25.0f;
+    for (int frame_number = 0; frame_number < 10; frame_number++) {
+        for (auto *accumulator : {&holding, &decaying}) {
+            accumulator->update(frame);
+        }
+    }
+    TEST_ASSERT_EQUAL_FLOAT(80.0f, holding.max_hold()[10]);
+    TEST_ASSERT_EQUAL_FLOAT(-5.0f, holding.min_hold()[20]);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, holding.max_hold()[20]);
+    // 0.5 C per frame towards the frame since the flash
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 80.0f - 10 * 0.5f, decaying.max_hold()[11]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -5.0f + 10 * 0.5f, decaying.min_hold()[20]);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, decaying.max_hold()[30]);
+    // nothing to move towards
+    TEST_ASSERT_EQUAL_FLOAT(80.0f, decaying.max_hold()[10]);
+
+    holding.reset_holds();
+    frame[10] = 26.0f;
+    holding.update(frame);
+    TEST_ASSERT_EQUAL_FLOAT(26.0f, holding.max_hold()[10]);
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, holding.min_hold()[20]);
+    // the means are not touched by the reset
+    TEST_ASSERT_EQUAL_UINT32(13, holding.frame_count());
+}
+
+void test_max_hold_as_color_source(void)
+{
+    TemporalAccumulator accumulator;
+    ThermoImage frame{};
+    frame.fill(20.0f);
+    frame[300] = 39.0f; // a part that was hot for one frame
+    accumulator.update(frame);
+    frame[300] = 20.0f;
+    accumulator.update(frame);
+
+    ThermoDisplaySettings tds{.min_scale_temp = 20.0f,
+                              .max_scale_temp = 40.0f,
+                              .mirror_mode = MirrorMode::NORMAL,
+                              .autoscale_active = false};
+    RGBThermoImage live_colors{};
+    RGBThermoImage hold_colors{};
+    mlx_utils::convert_raw_temp_to_color(accumulator.view(TemporalView::LIVE, frame), live_colors, tds);
+    mlx_utils::convert_raw_temp_to_color(accumulator.view(TemporalView::MAX_HOLD, frame), hold_colors, tds);
+    TEST_ASSERT_TRUE(live_colors[300].rgb_array() == live_colors[0].rgb_array());
+    TEST_ASSERT_TRUE(hold_colors[300].rgb_array() != hold_colors[0].rgb_array());
+    TEST_ASSERT_TRUE(hold_colors[0].rgb_array() == live_colors[0].rgb_array());
+}
+
+void test_accumulator_benchmark(void)
+{
+    constexpr uint32_t CALLS = 2000;
+    TemporalAccumulator accumulator(0.1f, 64, 0.1f);
+    auto frame = random_frame(25.0f);
+    RGBThermoImage rgb_frame{};
+    ThermoDisplaySettings tds{.min_scale_temp = 20.0f,
+                              .max_scale_temp = 30.0f,
+                              .mirror_mode = MirrorMode::NORMAL,
+                              .autoscale_active = false};
+    auto update_us = microseconds_per_call([&]() { accumulator.update(frame); }, CALLS);
+    auto color_us = microseconds_per_call([&]() { mlx_utils::convert_raw_temp_to_color(frame, rgb_frame, tds); },
+                                          CALLS);
+
+    report("per frame: accumulator update %.2f us, color conversion %.2f us", update_us, color_us);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_exponential_mean);
+    RUN_TEST(test_windowed_mean_matches_history);
+    RUN_TEST(test_holds_with_decay_and_reset);
+    RUN_TEST(test_max_hold_as_color_source);
+    RUN_TEST(test_accumulator_benchmark);
+    return UNITY_END();
+}
+
+int main(void)
+{
+    return runUnityTests();
+}